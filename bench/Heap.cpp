@@ -0,0 +1,308 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Heap.hpp"
+
+#include <dlfcn.h>
+#include <malloc.h>
+#include <sys/mman.h>
+
+#include "BitmapPoolAllocator.hpp"
+#include "BlockAllocator.hpp"
+#include "BuddyAllocator.hpp"
+#include "CachedPoolAllocator.hpp"
+#include "ConcurrentStackAllocator.hpp"
+#include "LockFreePoolAllocator.hpp"
+#include "OwnedBlockAllocator.hpp"
+#include "OwnedPoolAllocator.hpp"
+#include "PoolAllocator.hpp"
+#include "SlabAllocator.hpp"
+#include "StackAllocator.hpp"
+#include "TlsfAllocator.hpp"
+
+namespace mfg {
+namespace bench {
+    namespace {
+        template<typename StackType>
+        class StackHeap : public MfgHeap {
+        public:
+            StackHeap(const size_t& arenaSize) : MfgHeap(arenaSize) {}
+
+            size_t getMarker() override { return ((StackType*) mAllocator.get())->getMarker(); }
+
+            bool rollBack(const size_t& marker) override {
+                ((StackType*) mAllocator.get())->deallocateTo(marker);
+                return true;
+            }
+        };
+
+        class MallocHeap : public Heap { //malloc and free of a C library
+        private:
+            void* (*mMalloc)(size_t);
+            void (*mFree)(void*);
+            size_t (*mFootprint)();
+            size_t mBaseline; //footprint of the rest of the process
+        public:
+            MallocHeap(void* (*malloc)(size_t), void (*free)(void*), size_t (*footprint)()) :
+                mMalloc(malloc),
+                mFree(free),
+                mFootprint(footprint),
+                mBaseline(0)
+            {}
+
+            void* allocate(const size_t& size) override { return mMalloc(size); }
+            void deallocate(void* memory, const size_t& size) override { mFree(memory); }
+            bool isThreadSafe() const override { return true; }
+            void enableStatistics() override { mBaseline = mFootprint(); }
+
+            size_t getFootprint() override {
+                size_t footprint = mFootprint();
+                return footprint > mBaseline ? footprint - mBaseline : 0;
+            }
+        };
+
+        size_t GlibcFootprint() {
+            struct mallinfo2 info = mallinfo2();
+            return info.uordblks + info.hblkhd;
+        }
+
+        struct Jemalloc { //loaded once, never unloaded
+            void* (*malloc)(size_t);
+            void (*free)(void*);
+            int (*mallctl)(const char*, void*, size_t*, void*, size_t);
+
+            Jemalloc() : malloc(nullptr), free(nullptr), mallctl(nullptr) {
+                const char* names[] = {"libjemalloc.so.2", "libjemalloc.so"};
+                for(const char* name : names) {
+                    void* library = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+                    if(library != nullptr) {
+                        malloc = (void* (*)(size_t)) dlsym(library, "malloc");
+                        free = (void (*)(void*)) dlsym(library, "free");
+                        mallctl = (int (*)(const char*, void*, size_t*, void*, size_t)) dlsym(library, "mallctl");
+                        return;
+                    }
+                }
+            }
+
+            static Jemalloc& Get() {
+                static Jemalloc jemalloc;
+                return jemalloc;
+            }
+        };
+
+        size_t JemallocFootprint() {
+            Jemalloc& jemalloc = Jemalloc::Get();
+            if(jemalloc.mallctl == nullptr) {
+                return 0;
+            }
+
+            uint64_t epoch = 1; //refreshes the cached statistics
+            jemalloc.mallctl("epoch", nullptr, nullptr, &epoch, sizeof(epoch));
+
+            size_t allocated = 0;
+            size_t length = sizeof(allocated);
+            if(jemalloc.mallctl("stats.allocated", &allocated, &length, nullptr, 0) != 0) {
+                return 0;
+            }
+
+            return allocated;
+        }
+
+        //the smallest block of a buddy allocator which still leaves room for the blocks of a workload
+        //next to the table of a size per smallest block, between 16 bytes and 4 KB
+        size_t BuddyMinBlockSize(const HeapConfig& config) {
+            size_t size = 16;
+            while(size < 4096 && size * 2 <= config.maxSize) {
+                size *= 2;
+            }
+
+            while(size > 16 && config.arenaSize / (size / 2 + sizeof(size_t)) * (size / 2) >= config.maxBlocks * config.maxSize) {
+                size /= 2;
+            }
+
+            return size;
+        }
+    }
+
+    Heap::~Heap() {}
+    bool Heap::canDeallocate() const { return true; }
+    bool Heap::isThreadSafe() const { return false; }
+    bool Heap::supports(const HeapConfig& config) const { return true; }
+    size_t Heap::getMarker() { return 0; }
+    bool Heap::rollBack(const size_t& marker) { return false; }
+    bool Heap::clear() { return false; }
+    void Heap::enableStatistics() {}
+
+    MfgHeap::MfgHeap(const size_t& arenaSize) :
+        mArena(mmap(nullptr, arenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)),
+        mArenaSize(arenaSize),
+        mThreadSafe(false),
+        mCapacity(0)
+    {
+        ASSERT(mArena != MAP_FAILED);
+    }
+
+    MfgHeap::~MfgHeap() {
+        mAllocator.reset();
+        munmap(mArena, mArenaSize);
+    }
+
+    void* MfgHeap::getArena() const { return mArena; }
+    Allocator* MfgHeap::getAllocator() const { return mAllocator.get(); }
+
+    void MfgHeap::setAllocator(Allocator* allocator, const bool& threadSafe, const size_t& capacity) {
+        mAllocator.reset(allocator);
+        mThreadSafe = threadSafe;
+        mCapacity = capacity;
+    }
+
+    void* MfgHeap::allocate(const size_t& size) { return mAllocator->allocate(size); }
+    void MfgHeap::deallocate(void* memory, const size_t& size) { mAllocator->deallocate(memory); }
+    bool MfgHeap::canDeallocate() const { return mAllocator->canDeallocate(); }
+    bool MfgHeap::isThreadSafe() const { return mThreadSafe; }
+    bool MfgHeap::supports(const HeapConfig& config) const { return mCapacity == 0 || config.maxBlocks <= mCapacity; }
+
+    bool MfgHeap::clear() {
+        mAllocator->clear();
+        return true;
+    }
+
+    void MfgHeap::enableStatistics() { mAllocator->enableStatistics(); }
+    size_t MfgHeap::getFootprint() { return mAllocator->getUsedSize(); }
+
+    LockedHeap::LockedHeap(std::unique_ptr<Heap> heap) :
+        mHeap(std::move(heap))
+    {}
+
+    void* LockedHeap::allocate(const size_t& size) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeap->allocate(size);
+    }
+
+    void LockedHeap::deallocate(void* memory, const size_t& size) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mHeap->deallocate(memory, size);
+    }
+
+    bool LockedHeap::canDeallocate() const { return mHeap->canDeallocate(); }
+    bool LockedHeap::isThreadSafe() const { return true; }
+    bool LockedHeap::supports(const HeapConfig& config) const { return mHeap->supports(config); }
+
+    size_t LockedHeap::getMarker() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeap->getMarker();
+    }
+
+    bool LockedHeap::rollBack(const size_t& marker) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeap->rollBack(marker);
+    }
+
+    bool LockedHeap::clear() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeap->clear();
+    }
+
+    void LockedHeap::enableStatistics() { mHeap->enableStatistics(); }
+
+    size_t LockedHeap::getFootprint() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHeap->getFootprint();
+    }
+
+    std::unique_ptr<Heap> CreateHeap(const std::string& name, const HeapConfig& config) {
+        if(name == "malloc") {
+            return std::unique_ptr<Heap>(new MallocHeap(malloc, free, GlibcFootprint));
+        }
+
+        if(name == "jemalloc") {
+            Jemalloc& jemalloc = Jemalloc::Get();
+            if(jemalloc.malloc == nullptr || jemalloc.free == nullptr) {
+                return nullptr;
+            }
+
+            return std::unique_ptr<Heap>(new MallocHeap(jemalloc.malloc, jemalloc.free, JemallocFootprint));
+        }
+
+        MfgHeap* heap;
+        if(name == "stack") {
+            heap = new StackHeap<StackAllocator>(config.arenaSize);
+        }
+        else if(name == "concurrent_stack") {
+            heap = new StackHeap<ConcurrentStackAllocator>(config.arenaSize);
+        }
+        else {
+            heap = new MfgHeap(config.arenaSize);
+        }
+
+        void* arena = heap->getArena();
+        size_t numOfBlocks = config.arenaSize / config.maxSize; //capacity of the pools
+        if(name == "stack") {
+            heap->setAllocator(new StackAllocator(arena, config.arenaSize));
+        }
+        else if(name == "concurrent_stack") {
+            heap->setAllocator(new ConcurrentStackAllocator(arena, config.arenaSize), true);
+        }
+        else if(name == "pool") {
+            heap->setAllocator(new PoolAllocator(arena, config.arenaSize, config.maxSize), false, numOfBlocks);
+        }
+        else if(name == "bitmap_pool") {
+            heap->setAllocator(new BitmapPoolAllocator(arena, config.arenaSize, config.maxSize), false, numOfBlocks);
+        }
+        else if(name == "block") {
+            heap->setAllocator(new BlockAllocator(arena, config.arenaSize));
+        }
+        else if(name == "buddy") {
+            heap->setAllocator(new BuddyAllocator(arena, config.arenaSize, BuddyMinBlockSize(config)));
+        }
+        else if(name == "tlsf") {
+            heap->setAllocator(new TlsfAllocator(arena, config.arenaSize));
+        }
+        else if(name == "slab") {
+            //the big requests get the most of the arena if the workload has mostly big ones
+            size_t blockMemorySize = config.maxSize > 16 * SlabAllocator::MAX_SMALL_SIZE ? config.arenaSize / 4 * 3 : config.arenaSize / 4;
+            heap->setAllocator(new SlabAllocator(arena, config.arenaSize, blockMemorySize));
+        }
+        else if(name == "lockfree_pool") {
+            heap->setAllocator(new LockFreePoolAllocator(arena, config.arenaSize, config.maxSize), true, numOfBlocks);
+        }
+        else if(name == "cached_pool") {
+            heap->setAllocator(new CachedPoolAllocator(arena, config.arenaSize, config.maxSize), true, numOfBlocks);
+        }
+        else if(name == "owned_pool") { //owned by the creating thread, which runs the allocations of every workload
+            heap->setAllocator(new OwnedPoolAllocator(arena, config.arenaSize, config.maxSize), true, numOfBlocks);
+        }
+        else if(name == "owned_block") {
+            heap->setAllocator(new OwnedBlockAllocator(arena, config.arenaSize), true);
+        }
+        else {
+            delete heap;
+            return nullptr;
+        }
+
+        return std::unique_ptr<Heap>(heap);
+    }
+
+    const std::vector<std::string>& GetHeapNames() {
+        static const std::vector<std::string> names = {
+            "stack", "concurrent_stack", "pool", "bitmap_pool", "block", "buddy", "tlsf", "slab", "lockfree_pool", "cached_pool", "owned_pool", "owned_block", "malloc", "jemalloc"
+        };
+
+        return names;
+    }
+}//bench
+}//mfg
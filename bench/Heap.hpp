@@ -0,0 +1,177 @@
+/*! \file   Heap.hpp
+ *  \brief  The allocators measured by the benchmark behind one interface.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BENCH_HEAP_HPP
+#define MFG_BENCH_HEAP_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+//! \namespace  bench
+namespace bench {
+    /*! \struct HeapConfig
+     *  \brief  What a workload needs from an allocator.
+     */
+    struct HeapConfig {
+        size_t arenaSize;   //memory given to the mfg allocators
+        size_t maxSize;     //biggest request, the size of blocks of the pools
+        size_t maxBlocks;   //most blocks in use at once
+    };
+
+    /*! \class  Heap
+     *  \brief  An allocator under measurement. The workloads pass the requested
+     *          size to deallocate(), so malloc and the mfg allocators look the same.
+     */
+    class Heap {
+    public:
+        virtual ~Heap();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it ran out.
+         */
+        virtual void* allocate(const size_t& size) = 0;
+
+        /*! \fn     void deallocate(void* memory, const size_t& size)
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size it has been allocated with.
+         */
+        virtual void deallocate(void* memory, const size_t& size) = 0;
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False if single blocks can not be given back.
+         */
+        virtual bool canDeallocate() const;
+
+        /*! \fn     bool isThreadSafe() const
+         *  \return True if any thread may call it at any time.
+         */
+        virtual bool isThreadSafe() const;
+
+        /*! \fn     bool supports(const HeapConfig& config) const
+         *  \param  config
+         *  \return False if it can not hold the blocks of a workload, so measuring it is pointless.
+         */
+        virtual bool supports(const HeapConfig& config) const;
+
+        /*! \fn     size_t getMarker()
+         *  \return The top of the heap if it is a stack, otherwise 0.
+         */
+        virtual size_t getMarker();
+
+        /*! \fn     bool rollBack(const size_t& marker)
+         *  \brief  Deallocates everything above a marker if it is a stack.
+         *  \param  marker Given by getMarker().
+         *  \return False if the blocks have to be deallocated one by one.
+         */
+        virtual bool rollBack(const size_t& marker);
+
+        /*! \fn     bool clear()
+         *  \brief  Deallocates everything at once, if it can.
+         *  \return False if the blocks have to be deallocated one by one.
+         */
+        virtual bool clear();
+
+        /*! \fn     void enableStatistics()
+         *  \brief  Switches on whatever getFootprint() needs, before the first allocation.
+         */
+        virtual void enableStatistics();
+
+        /*! \fn     size_t getFootprint()
+         *  \return The bytes held for the live blocks, headers, padding and rounding included,
+         *          or 0 if it is unknown.
+         */
+        virtual size_t getFootprint() = 0;
+    };
+
+    /*! \class  MfgHeap
+     *  \brief  An mfg allocator on its own mmapped arena.
+     */
+    class MfgHeap : public Heap {
+    protected:
+        void* mArena; //memory of the allocator
+        size_t mArenaSize; //size of the arena
+        std::unique_ptr<Allocator> mAllocator; //the allocator under measurement
+        bool mThreadSafe; //the allocator may be used by any thread
+        size_t mCapacity; //most blocks it can hold, 0 if it depends on their sizes
+    public:
+        MfgHeap(const size_t& arenaSize);
+        ~MfgHeap();
+
+        void* getArena() const;
+        Allocator* getAllocator() const;
+        void setAllocator(Allocator* allocator, const bool& threadSafe = false, const size_t& capacity = 0);
+
+        void* allocate(const size_t& size) override;
+        void deallocate(void* memory, const size_t& size) override;
+        bool canDeallocate() const override;
+        bool isThreadSafe() const override;
+        bool supports(const HeapConfig& config) const override;
+        bool clear() override;
+        void enableStatistics() override;
+        size_t getFootprint() override;
+    };
+
+    /*! \class  LockedHeap
+     *  \brief  Guards a heap which is not thread safe with a mutex.
+     */
+    class LockedHeap : public Heap {
+    private:
+        std::unique_ptr<Heap> mHeap; //the guarded heap
+        std::mutex mMutex; //guards mHeap
+    public:
+        LockedHeap(std::unique_ptr<Heap> heap);
+
+        void* allocate(const size_t& size) override;
+        void deallocate(void* memory, const size_t& size) override;
+        bool canDeallocate() const override;
+        bool isThreadSafe() const override;
+        bool supports(const HeapConfig& config) const override;
+        size_t getMarker() override;
+        bool rollBack(const size_t& marker) override;
+        bool clear() override;
+        void enableStatistics() override;
+        size_t getFootprint() override;
+    };
+
+    /*! \fn     std::unique_ptr<Heap> CreateHeap(const std::string& name, const HeapConfig& config)
+     *  \brief  Creates an allocator by name.
+     *  \param  name One of GetHeapNames().
+     *  \param  config
+     *  \return The heap, or nullptr if the allocator is not available.
+     */
+    std::unique_ptr<Heap> CreateHeap(const std::string& name, const HeapConfig& config);
+
+    /*! \fn     const std::vector<std::string>& GetHeapNames()
+     *  \return The names of every allocator, available or not.
+     */
+    const std::vector<std::string>& GetHeapNames();
+}//bench
+}//mfg
+
+#endif // MFG_BENCH_HEAP_HPP
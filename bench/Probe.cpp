@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Probe.hpp"
+
+#include <algorithm>
+
+namespace mfg {
+namespace bench {
+    namespace {
+        //the cost of reading the clock twice, it is taken off every sample
+        int64_t getTimerOverhead() {
+            static const int64_t overhead = [] {
+                int64_t best = INT64_MAX;
+                for(int i = 0; i < 1000; i++) {
+                    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                    int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+                    best = std::min(best, elapsed);
+                }
+
+                return best;
+            }();
+
+            return overhead;
+        }
+    }
+
+    Probe::Probe(Heap& heap, const Mode& mode) :
+        mHeap(heap),
+        mMode(mode),
+        mOperations(0),
+        mFailures(0),
+        mLive(0),
+        mPeakLive(0),
+        mPeakFootprint(0)
+    {
+        if(mMode == LATENCY) {
+            getTimerOverhead();
+            mSamples.reserve(1 << 20);
+        }
+    }
+
+    void Probe::addSample(const Clock::time_point& begin, const uint64_t& count) {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count() - getTimerOverhead();
+        uint32_t latency = elapsed > 0 ? elapsed / count : 0;
+        for(uint64_t i = 0; i < count; i += SAMPLE_PERIOD) { //keeps the ratio of the samples to the operations
+            mSamples.push_back(latency);
+        }
+    }
+
+    void Probe::rollBack(const size_t& marker, const Block* blocks, const size_t& count) {
+        if(count == 0) {
+            return;
+        }
+
+        Clock::time_point begin;
+        if(mMode == LATENCY) {
+            begin = Clock::now();
+        }
+
+        if(!mHeap.rollBack(marker)) {
+            for(size_t i = count; i > 0; i--) {
+                mHeap.deallocate(blocks[i - 1].memory, blocks[i - 1].size);
+            }
+        }
+
+        if(mMode == LATENCY) {
+            addSample(begin, count);
+        }
+
+        int64_t size = 0;
+        for(size_t i = 0; i < count; i++) {
+            size += blocks[i].size;
+        }
+
+        mOperations += count;
+        addLive(-size);
+    }
+
+    void Probe::release(const Block* blocks, const size_t& count) {
+        Clock::time_point begin;
+        if(mMode == LATENCY) {
+            begin = Clock::now();
+        }
+
+        if(!mHeap.clear()) {
+            for(size_t i = 0; i < count; i++) {
+                mHeap.deallocate(blocks[i].memory, blocks[i].size);
+            }
+        }
+
+        if(mMode == LATENCY && count > 0) {
+            addSample(begin, count);
+        }
+
+        mOperations += count;
+        mLive.store(0, std::memory_order_relaxed);
+    }
+
+    void Probe::checkpoint(const int64_t& live) {
+        if(mMode == MEMORY && live > mPeakLive) {
+            mPeakLive = live;
+            mPeakFootprint = mHeap.getFootprint();
+        }
+    }
+
+    void Probe::merge(Probe& other) {
+        mOperations += other.mOperations;
+        mFailures += other.mFailures;
+        addLive(other.getLive());
+        if(other.mPeakLive > mPeakLive) {
+            mPeakLive = other.mPeakLive;
+            mPeakFootprint = other.mPeakFootprint;
+        }
+
+        mSamples.insert(mSamples.end(), other.mSamples.begin(), other.mSamples.end());
+    }
+
+    double Probe::getPercentile(const double& percentile) {
+        if(mSamples.empty()) {
+            return 0;
+        }
+
+        size_t index = (size_t) (percentile * (mSamples.size() - 1));
+        std::nth_element(mSamples.begin(), mSamples.begin() + index, mSamples.end());
+        return mSamples[index];
+    }
+}//bench
+}//mfg
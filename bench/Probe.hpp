@@ -0,0 +1,187 @@
+/*! \file   Probe.hpp
+ *  \brief  Measures the calls of a workload to a heap.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BENCH_PROBE_HPP
+#define MFG_BENCH_PROBE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Heap.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+//! \namespace  bench
+namespace bench {
+    /*! \struct Block
+     *  \brief  An allocation of a workload.
+     */
+    struct Block {
+        void* memory;
+        size_t size;
+    };
+
+    /*! \class  Probe
+     *  \brief  Every call of a workload to its heap goes through a probe of its thread.
+     *          A throughput run only counts the operations. A latency run times every
+     *          SAMPLE_PERIOD-th call. A memory run follows the requested bytes in use,
+     *          and reads the footprint of the heap at the checkpoints where they peak.
+     *          Deallocating many blocks at once counts as one operation per block.
+     */
+    class Probe {
+    public:
+        enum Mode {
+            THROUGHPUT,
+            LATENCY,
+            MEMORY
+        };
+
+        enum : uint64_t {
+            SAMPLE_PERIOD = 8 //calls between two timed ones in a latency run
+        };
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Heap& mHeap; //the heap under measurement
+        Mode mMode; //what to measure
+        uint64_t mOperations; //number of allocations and deallocations
+        uint64_t mFailures; //allocations which returned nullptr
+        std::atomic<int64_t> mLive; //requested bytes in use, written only by the thread of the probe
+        int64_t mPeakLive; //the most requested bytes in use at a checkpoint
+        size_t mPeakFootprint; //footprint of the heap at that checkpoint
+        std::vector<uint32_t> mSamples; //latencies in nanoseconds
+
+        void addLive(const int64_t& size) { mLive.store(mLive.load(std::memory_order_relaxed) + size, std::memory_order_relaxed); }
+        void addSample(const Clock::time_point& begin, const uint64_t& count);
+    public:
+        /*! \fn     Probe(Heap& heap, const Mode& mode)
+         *  \brief  Constructor.
+         *  \param  heap The heap under measurement.
+         *  \param  mode What to measure.
+         */
+        Probe(Heap& heap, const Mode& mode);
+
+        Probe(const Probe& other) = delete;
+        Probe& operator=(const Probe& other) = delete;
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \param  size
+         *  \return The memory, or nullptr if the heap ran out.
+         */
+        void* allocate(const size_t& size) {
+            void* memory;
+            if(mMode == LATENCY && mOperations % SAMPLE_PERIOD == 0) {
+                Clock::time_point begin = Clock::now();
+                memory = mHeap.allocate(size);
+                addSample(begin, 1);
+            }
+            else {
+                memory = mHeap.allocate(size);
+            }
+
+            mOperations++;
+            if(memory == nullptr) {
+                mFailures++;
+                return nullptr;
+            }
+
+            addLive(size);
+            return memory;
+        }
+
+        /*! \fn     void deallocate(const Block& block)
+         *  \param  block Given by allocate(const size_t& size).
+         */
+        void deallocate(const Block& block) {
+            if(mMode == LATENCY && mOperations % SAMPLE_PERIOD == 0) {
+                Clock::time_point begin = Clock::now();
+                mHeap.deallocate(block.memory, block.size);
+                addSample(begin, 1);
+            }
+            else {
+                mHeap.deallocate(block.memory, block.size);
+            }
+
+            mOperations++;
+            addLive(-(int64_t) block.size);
+        }
+
+        /*! \fn     size_t getMarker()
+         *  \return The marker to roll back to with rollBack().
+         */
+        size_t getMarker() { return mHeap.getMarker(); }
+
+        /*! \fn     void rollBack(const size_t& marker, const Block* blocks, const size_t& count)
+         *  \brief  Deallocates the blocks allocated since the marker, in reverse order.
+         *  \param  marker Given by getMarker().
+         *  \param  blocks The blocks allocated since then.
+         *  \param  count The number of blocks.
+         */
+        void rollBack(const size_t& marker, const Block* blocks, const size_t& count);
+
+        /*! \fn     void release(const Block* blocks, const size_t& count)
+         *  \brief  Deallocates every block of the heap, with clear() if it can.
+         *  \param  blocks Every live block.
+         *  \param  count The number of blocks.
+         */
+        void release(const Block* blocks, const size_t& count);
+
+        /*! \fn     void checkpoint()
+         *  \brief  Reads the footprint of the heap if the bytes in use peak.
+         */
+        void checkpoint() { checkpoint(getLive()); }
+
+        /*! \fn     void checkpoint(const int64_t& live)
+         *  \brief  Reads the footprint of the heap if the bytes in use peak.
+         *  \param  live The requested bytes in use, summed over every thread.
+         */
+        void checkpoint(const int64_t& live);
+
+        /*! \fn     int64_t getLive() const
+         *  \return The requested bytes allocated minus the ones deallocated by this probe.
+         *          Any thread may read it.
+         */
+        int64_t getLive() const { return mLive.load(std::memory_order_relaxed); }
+
+        /*! \fn     void merge(Probe& other)
+         *  \brief  Adds the measurements of the probe of another thread.
+         *  \param  other
+         */
+        void merge(Probe& other);
+
+        const Mode& getMode() const { return mMode; }
+        const uint64_t& getOperations() const { return mOperations; }
+        const uint64_t& getFailures() const { return mFailures; }
+        const int64_t& getPeakLive() const { return mPeakLive; }
+        const size_t& getPeakFootprint() const { return mPeakFootprint; }
+
+        /*! \fn     double getPercentile(const double& percentile)
+         *  \param  percentile Between 0 and 1.
+         *  \return The latency of the sampled calls at the percentile in nanoseconds, or 0 without samples.
+         */
+        double getPercentile(const double& percentile);
+    };
+}//bench
+}//mfg
+
+#endif // MFG_BENCH_PROBE_HPP
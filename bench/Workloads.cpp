@@ -0,0 +1,391 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Workloads.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mfg {
+namespace bench {
+    namespace {
+        const size_t MB = 1024 * 1024;
+
+        class Random { //xorshift64*, the same sequence on every platform
+        private:
+            uint64_t mState;
+        public:
+            Random(const uint64_t& seed) : mState(seed) {}
+
+            uint64_t next() {
+                mState ^= mState >> 12;
+                mState ^= mState << 25;
+                mState ^= mState >> 27;
+                return mState * 0x2545F4914F6CDD1DULL;
+            }
+
+            //as many small sizes as big ones on a logarithmic scale
+            size_t size(const size_t& min, const size_t& max) {
+                size_t low = 63 - __builtin_clzll(min);
+                size_t high = 63 - __builtin_clzll(max);
+                size_t bits = low + next() % (high - low + 1);
+                size_t size = ((size_t) 1 << bits) + next() % ((size_t) 1 << bits);
+                return size < min ? min : size > max ? max : size;
+            }
+        };
+
+        //the owner writes the header of its object
+        void touch(void* memory, const size_t& size) {
+            memset(memory, 0xAB, size < 64 ? size : 64);
+        }
+
+        void Bursty(Heap& heap, Probe& probe, const double& scale) {
+            Random random(1);
+            std::vector<Block> blocks;
+            blocks.reserve(4096);
+
+            size_t frames = 300 * scale;
+            for(size_t frame = 0; frame < frames; frame++) {
+                size_t burst = 1000 + random.next() % 3000;
+                for(size_t i = 0; i < burst; i++) {
+                    Block block = {nullptr, random.size(16, 256)};
+                    block.memory = probe.allocate(block.size);
+                    if(block.memory == nullptr) {
+                        continue;
+                    }
+
+                    touch(block.memory, block.size);
+                    blocks.push_back(block);
+
+                    if(heap.canDeallocate() && random.next() % 4 == 0) { //an object of this frame dies
+                        size_t index = random.next() % blocks.size();
+                        probe.deallocate(blocks[index]);
+                        blocks[index] = blocks.back();
+                        blocks.pop_back();
+                    }
+                }
+
+                probe.checkpoint();
+                probe.release(blocks.data(), blocks.size());
+                blocks.clear();
+            }
+        }
+
+        void Scope(Probe& probe, Random& random, const size_t& depth, Block* blocks) {
+            size_t marker = probe.getMarker();
+            size_t count = 1 + random.next() % 8;
+            size_t allocated = 0;
+            for(size_t i = 0; i < count; i++) {
+                Block block = {nullptr, random.size(32, 4096)};
+                block.memory = probe.allocate(block.size);
+                if(block.memory != nullptr) {
+                    touch(block.memory, block.size);
+                    blocks[allocated++] = block;
+                }
+            }
+
+            if(depth > 1) {
+                Scope(probe, random, depth - 1, blocks + allocated);
+            }
+            else {
+                probe.checkpoint();
+            }
+
+            probe.rollBack(marker, blocks, allocated);
+        }
+
+        void Lifo(Heap& heap, Probe& probe, const double& scale) {
+            Random random(2);
+            Block blocks[6 * 8];
+
+            size_t iterations = 40000 * scale;
+            for(size_t i = 0; i < iterations; i++) {
+                Scope(probe, random, 1 + random.next() % 6, blocks);
+            }
+        }
+
+        void Churn(Heap& heap, Probe& probe, const double& scale) {
+            Random random(3);
+            std::vector<Block> slots(16384, Block{nullptr, 0});
+
+            size_t operations = 2000000 * scale;
+            for(size_t i = 0; i < operations; i++) {
+                Block& slot = slots[random.next() % slots.size()];
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+
+                slot.size = random.size(8, 1024);
+                slot.memory = probe.allocate(slot.size);
+                if(slot.memory != nullptr) {
+                    touch(slot.memory, slot.size);
+                }
+
+                if(i % 1024 == 0) {
+                    probe.checkpoint();
+                }
+            }
+
+            for(Block& slot : slots) {
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+            }
+        }
+
+        void Occupancy(Heap& heap, Probe& probe, const double& scale) {
+            Random random(5);
+            std::vector<Block> slots(8 * MB / 64 * 7 / 8, Block{nullptr, 64}); //7/8 of the blocks of a pool of the arena
+
+            for(Block& slot : slots) {
+                slot.memory = probe.allocate(slot.size);
+                if(slot.memory != nullptr) {
+                    touch(slot.memory, slot.size);
+                }
+            }
+
+            probe.checkpoint();
+
+            size_t operations = 2000000 * scale;
+            for(size_t i = 0; i < operations; i++) {
+                Block& slot = slots[random.next() % slots.size()];
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+
+                slot.memory = probe.allocate(slot.size);
+                if(slot.memory != nullptr) {
+                    touch(slot.memory, slot.size);
+                }
+            }
+
+            for(Block& slot : slots) {
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+            }
+        }
+
+        void Streaming(Heap& heap, Probe& probe, const double& scale) {
+            Random random(6);
+            std::vector<Block> slots(48, Block{nullptr, 0}); //about half of the arena in use
+
+            size_t operations = 200000 * scale;
+            for(size_t i = 0; i < operations; i++) {
+                Block& slot = slots[random.next() % slots.size()];
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+
+                slot.size = (size_t) 4096 << (random.next() % 13); //4 KB to 16 MB
+                slot.memory = probe.allocate(slot.size);
+                if(slot.memory != nullptr) {
+                    touch(slot.memory, slot.size);
+                }
+
+                if(i % 64 == 0) {
+                    probe.checkpoint();
+                }
+            }
+
+            for(Block& slot : slots) {
+                if(slot.memory != nullptr) {
+                    probe.deallocate(slot);
+                }
+            }
+        }
+
+        class Ring { //single producer, single consumer
+        private:
+            enum : size_t {
+                CAPACITY = 1024
+            };
+
+            Block mSlots[CAPACITY];
+            alignas(64) std::atomic<size_t> mHead; //next slot to read
+            alignas(64) std::atomic<size_t> mTail; //next slot to write
+        public:
+            Ring() : mHead(0), mTail(0) {}
+
+            bool push(const Block& block) {
+                size_t tail = mTail.load(std::memory_order_relaxed);
+                if(tail - mHead.load(std::memory_order_acquire) == CAPACITY) {
+                    return false;
+                }
+
+                mSlots[tail % CAPACITY] = block;
+                mTail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool pop(Block& block) {
+                size_t head = mHead.load(std::memory_order_relaxed);
+                if(head == mTail.load(std::memory_order_acquire)) {
+                    return false;
+                }
+
+                block = mSlots[head % CAPACITY];
+                mHead.store(head + 1, std::memory_order_release);
+                return true;
+            }
+        };
+
+        void ProducerConsumer(Heap& heap, Probe& probe, const double& scale) {
+            Ring ring;
+            Probe consumerProbe(heap, probe.getMode());
+            size_t messages = 500000 * scale;
+
+            std::thread consumer([&] {
+                Block block;
+                for(size_t i = 0; i < messages; i++) {
+                    while(!ring.pop(block)) {
+                        std::this_thread::yield();
+                    }
+
+                    if(block.memory != nullptr) {
+                        consumerProbe.deallocate(block);
+                    }
+                }
+            });
+
+            Random random(4);
+            for(size_t i = 0; i < messages; i++) {
+                Block block = {nullptr, random.size(16, 512)};
+                block.memory = probe.allocate(block.size);
+                if(block.memory != nullptr) {
+                    touch(block.memory, block.size);
+                }
+
+                while(!ring.push(block)) {
+                    std::this_thread::yield();
+                }
+
+                if(i % 256 == 0) {
+                    probe.checkpoint(probe.getLive() + consumerProbe.getLive());
+                }
+            }
+
+            consumer.join();
+            probe.merge(consumerProbe);
+        }
+
+        class Barrier { //the threads wait until all of them arrive
+        private:
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            size_t mThreads; //number of threads to wait for
+            size_t mWaiting; //number of threads arrived
+            size_t mGeneration; //number of times all of them arrived
+        public:
+            Barrier(const size_t& threads) : mThreads(threads), mWaiting(0), mGeneration(0) {}
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                size_t generation = mGeneration;
+                if(++mWaiting == mThreads) {
+                    mWaiting = 0;
+                    mGeneration++;
+                    mCondition.notify_all();
+                    return;
+                }
+
+                mCondition.wait(lock, [&] { return generation != mGeneration; });
+            }
+        };
+
+        template<size_t THREADS>
+        void ParallelJobs(Heap& heap, Probe& probe, const double& scale) {
+            const size_t allocationsPerFrame = 8192; //split among the threads, so the runs do the same work
+            Barrier barrier(THREADS);
+            std::unique_ptr<Probe> workerProbes[THREADS];
+            Probe* probes[THREADS];
+            std::vector<Block> blocks[THREADS];
+
+            probes[0] = &probe;
+            for(size_t thread = 1; thread < THREADS; thread++) {
+                workerProbes[thread].reset(new Probe(heap, probe.getMode()));
+                probes[thread] = workerProbes[thread].get();
+            }
+
+            size_t frames = 200 * scale;
+            auto work = [&](const size_t& thread) {
+                Random random(7 + thread);
+                for(size_t frame = 0; frame < frames; frame++) {
+                    for(size_t i = 0; i < allocationsPerFrame / THREADS; i++) {
+                        Block block = {nullptr, random.size(16, 256)};
+                        block.memory = probes[thread]->allocate(block.size);
+                        if(block.memory != nullptr) {
+                            touch(block.memory, block.size);
+                            blocks[thread].push_back(block);
+                        }
+                    }
+
+                    barrier.wait(); //the end of the frame, nobody allocates
+
+                    if(thread == 0) {
+                        int64_t live = 0;
+                        for(size_t other = 0; other < THREADS; other++) {
+                            live += probes[other]->getLive();
+                        }
+
+                        probe.checkpoint(live);
+
+                        for(size_t other = 0; other < THREADS; other++) { //the first one clears a heap which can
+                            probes[other]->release(blocks[other].data(), blocks[other].size());
+                            blocks[other].clear();
+                        }
+                    }
+
+                    barrier.wait();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for(size_t thread = 1; thread < THREADS; thread++) {
+                workers.emplace_back(work, thread);
+            }
+
+            work(0);
+
+            for(size_t thread = 1; thread < THREADS; thread++) {
+                workers[thread - 1].join();
+                probe.merge(*probes[thread]);
+            }
+        }
+    }
+
+    const std::vector<Workload>& GetWorkloads() {
+        static const std::vector<Workload> workloads = {
+            {"bursty", {16 * MB, 256, 4000}, 1, false, Bursty},
+            {"lifo", {8 * MB, 4096, 6 * 8}, 1, false, Lifo},
+            {"churn", {32 * MB, 1024, 16384}, 1, true, Churn},
+            {"producer_consumer", {8 * MB, 512, 1024 + 2}, 2, true, ProducerConsumer},
+            {"occupancy", {8 * MB, 64, 8 * MB / 64 * 7 / 8}, 1, true, Occupancy},
+            {"streaming", {256 * MB, 16 * MB, 48}, 1, true, Streaming},
+            {"parallel_jobs", {16 * MB, 256, 8192}, 1, false, ParallelJobs<1>},
+            {"parallel_jobs", {16 * MB, 256, 8192}, 2, false, ParallelJobs<2>},
+            {"parallel_jobs", {16 * MB, 256, 8192}, 4, false, ParallelJobs<4>},
+            {"parallel_jobs", {16 * MB, 256, 8192}, 8, false, ParallelJobs<8>}
+        };
+
+        return workloads;
+    }
+}//bench
+}//mfg
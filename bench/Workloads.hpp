@@ -0,0 +1,66 @@
+/*! \file   Workloads.hpp
+ *  \brief  Allocation patterns of a game frame, replayed by the benchmark.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BENCH_WORKLOADS_HPP
+#define MFG_BENCH_WORKLOADS_HPP
+
+#include <vector>
+
+#include "Probe.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+//! \namespace  bench
+namespace bench {
+    /*! \struct Workload
+     *  \brief  A deterministic allocation pattern. Every run with the same scale
+     *          makes the same requests, so the runs of one workload are comparable.
+     */
+    struct Workload {
+        const char* name;
+        HeapConfig config; //what it needs from the heap
+        size_t threads; //number of threads calling the heap
+        bool needsDeallocate; //frees single blocks, so stacks can not run it
+        void (*run)(Heap& heap, Probe& probe, const double& scale); //probe is the one of the calling thread
+    };
+
+    /*! \fn     const std::vector<Workload>& GetWorkloads()
+     *  \return Every workload:
+     *          bursty: frames allocating a burst of small objects, some of them die
+     *                  during the frame, the rest at its end.
+     *          lifo: nested scopes of scratch memory released in reverse order.
+     *          churn: random sized objects replaced at random, the heap never empties.
+     *          producer_consumer: one thread allocates messages, another one frees them.
+     *          occupancy: objects of one size fill 7/8 of the blocks of a pool, then they are
+     *                  replaced at random, so a free block is hard to find. Allocators with
+     *                  headers may run out.
+     *          streaming: power of two sized buffers from 4 KB to 16 MB replaced at random,
+     *                  like the textures and sounds of a streaming system. The arena fragments,
+     *                  so a few requests may fail, and the pools do not have enough blocks.
+     *          parallel_jobs: the threads of a job system allocate small scratch objects, all of them
+     *                  are released at the end of every frame. It runs with 1, 2, 4 and 8 threads,
+     *                  the same work split among them, to show how the allocators scale.
+     */
+    const std::vector<Workload>& GetWorkloads();
+}//bench
+}//mfg
+
+#endif // MFG_BENCH_WORKLOADS_HPP
@@ -0,0 +1,133 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Scaling benchmark of CachedPoolAllocator against a PoolAllocator behind a mutex.
+1..N threads share one pool, and each of them allocates bursts of 32 blocks of 64 bytes,
+then frees them. Every thread does the same number of operations, so on as many cores
+as threads an allocator which scales keeps its ns per operation. Prints one CSV line
+per allocator and number of threads:
+    allocator,threads,ops,ns_per_op
+ns_per_op   Wall-clock time of the run divided by the operations of one thread.
+
+Usage: mfg_cached_pool_scaling [max threads, 4 or the number of cores by default]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CachedPoolAllocator.hpp"
+
+namespace {
+    const size_t BLOCK_SIZE = 64;
+    const size_t BURST = 32; //blocks a thread allocates before freeing them
+    const size_t BURSTS_PER_THREAD = 20000;
+    const size_t MAX_THREADS = 64;
+
+    class LockedPool { //the way the pool is shared without the cache
+    private:
+        std::mutex mMutex;
+        mfg::PoolAllocator mPool;
+    public:
+        LockedPool(void* memory, const size_t& size) : mPool(memory, size, BLOCK_SIZE) {}
+
+        void* allocate(const size_t& size) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mPool.allocate(size);
+        }
+
+        void deallocate(void* memory) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPool.deallocate(memory);
+        }
+    };
+
+    template<typename Pool>
+    void work(Pool& pool, bool& failed) {
+        void* blocks[BURST];
+        for(size_t i = 0; i < BURSTS_PER_THREAD; i++) {
+            for(size_t j = 0; j < BURST; j++) {
+                blocks[j] = pool.allocate(BLOCK_SIZE);
+                if(blocks[j] == nullptr) {
+                    failed = true;
+                    return;
+                }
+
+                *((volatile char*) blocks[j]) = (char) j;
+            }
+
+            for(size_t j = 0; j < BURST; j++) {
+                pool.deallocate(blocks[j]);
+            }
+        }
+    }
+
+    template<typename Pool>
+    bool run(Pool& pool, const char* name, const size_t& threads) {
+        bool failed[MAX_THREADS] = {};
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> workers;
+        for(size_t thread = 1; thread < threads; thread++) {
+            workers.emplace_back([&, thread] { work(pool, failed[thread]); });
+        }
+
+        work(pool, failed[0]);
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if(std::find(failed, failed + threads, true) != failed + threads) {
+            fprintf(stderr, "%s ran out of blocks with %zu threads\n", name, threads);
+            return false;
+        }
+
+        size_t operations = BURSTS_PER_THREAD * BURST * 2;
+        printf("%s,%zu,%zu,%.2f\n", name, threads, operations * threads, seconds * 1e9 / operations);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    if(argc > 1) {
+        maxThreads = std::max(1, atoi(argv[1]));
+    }
+
+    maxThreads = std::min(maxThreads, MAX_THREADS);
+
+    size_t size = MAX_THREADS * 256 * BLOCK_SIZE; //room for every burst and magazine
+    std::vector<unsigned char> lockedMemory(size);
+    std::vector<unsigned char> cachedMemory(size);
+    LockedPool locked(lockedMemory.data(), size);
+    mfg::CachedPoolAllocator cached(cachedMemory.data(), size, BLOCK_SIZE);
+
+    printf("allocator,threads,ops,ns_per_op\n");
+    for(size_t threads = 1; threads <= maxThreads; threads++) {
+        if(!run(locked, "pool+mutex", threads) || !run(cached, "cached_pool", threads)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Benchmark of standard containers on the default heap and on mfg allocators.
+Every round builds a vector of strings, grows a vector of integers and fills an
+unordered_map, then replaces half of the map entries. The containers use the
+allocators both as a std::pmr::memory_resource (MemoryResource) and as a typed
+allocator (StlAllocator). The stack can not free single blocks, so it is cleared
+after every round. Prints one CSV line per allocator and interface:
+    allocator,interface,rounds,ns_per_round
+
+Usage: mfg_containers [rounds, 2000 by default]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BlockAllocator.hpp"
+#include "MemoryResource.hpp"
+#include "StackAllocator.hpp"
+#include "StlAllocator.hpp"
+#include "TlsfAllocator.hpp"
+
+namespace {
+    const size_t ARENA_SIZE = 16 * 1024 * 1024;
+
+    class Random { //xorshift64*
+    private:
+        uint64_t mState;
+    public:
+        Random(const uint64_t& seed) : mState(seed) {}
+
+        uint64_t next() {
+            mState ^= mState >> 12;
+            mState ^= mState << 25;
+            mState ^= mState >> 27;
+            return mState * 0x2545F4914F6CDD1DULL;
+        }
+
+        size_t size(const size_t& min, const size_t& max) { return min + next() % (max - min + 1); }
+    };
+
+    struct Pmr { //the containers of std::pmr on a memory resource
+        typedef std::pmr::string String;
+        typedef std::pmr::vector<String> Strings;
+        typedef std::pmr::vector<uint32_t> Integers;
+        typedef std::pmr::unordered_map<uint32_t, String> Map;
+
+        std::pmr::memory_resource* resource;
+
+        std::pmr::memory_resource* get() const { return resource; }
+    };
+
+    template<template<class> class Alloc>
+    struct Typed { //the standard containers with an allocator parameter
+        typedef std::basic_string<char, std::char_traits<char>, Alloc<char>> String;
+        typedef std::vector<String, Alloc<String>> Strings;
+        typedef std::vector<uint32_t, Alloc<uint32_t>> Integers;
+        typedef std::unordered_map<uint32_t, String, std::hash<uint32_t>, std::equal_to<uint32_t>, Alloc<std::pair<const uint32_t, String>>> Map;
+
+        Alloc<char> allocator;
+
+        const Alloc<char>& get() const { return allocator; }
+    };
+
+    template<typename Types>
+    void Round(const Types& types, Random& random) {
+        typename Types::Strings names(types.get());
+        typename Types::Integers integers(types.get());
+        typename Types::Map index(types.get());
+
+        for(size_t i = 0; i < 64; i++) {
+            names.push_back(typename Types::String(random.size(16, 200), (char) ('a' + i % 26), types.get()));
+            index.emplace((uint32_t) random.next(), names.back());
+        }
+
+        size_t count = random.size(1, 4096);
+        for(size_t i = 0; i < count; i++) {
+            integers.push_back((uint32_t) random.next());
+        }
+
+        for(size_t i = 0; i < 64; i++) { //half of the entries are replaced
+            if(random.next() % 2 == 0) {
+                index.erase(index.begin());
+                index.emplace((uint32_t) random.next(), names[random.next() % names.size()]);
+            }
+        }
+    }
+
+    template<typename Types>
+    void Run(const char* allocator, const char* interface, const Types& types, mfg::Allocator* clear, const size_t& rounds) {
+        Random random(1);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for(size_t round = 0; round < rounds; round++) {
+            Round(types, random);
+            if(clear != nullptr) { //the containers are gone, but the stack still holds their memory
+                clear->clear();
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        printf("%s,%s,%zu,%.1f\n", allocator, interface, rounds, seconds * 1e9 / rounds);
+    }
+
+    void Run(const char* name, mfg::Allocator& allocator, const size_t& rounds) {
+        mfg::MemoryResource resource(&allocator);
+        mfg::Allocator* clear = resource.isMonotonic() ? &allocator : nullptr;
+        try {
+            Run(name, "pmr", Pmr{&resource}, clear, rounds);
+            Run(name, "stl", Typed<mfg::StlAllocator>{mfg::StlAllocator<char>(&allocator)}, clear, rounds);
+        }
+        catch(const std::bad_alloc&) {
+            fprintf(stderr, "%s ran out of memory\n", name);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t rounds = 2000;
+    if(argc > 1) {
+        rounds = std::max(1, atoi(argv[1]));
+    }
+
+    std::vector<unsigned char> memory(ARENA_SIZE);
+
+    printf("allocator,interface,rounds,ns_per_round\n");
+    Run("default", "pmr", Pmr{std::pmr::new_delete_resource()}, nullptr, rounds);
+    Run("default", "stl", Typed<std::allocator>{std::allocator<char>()}, nullptr, rounds);
+
+    {
+        mfg::StackAllocator stack(memory.data(), ARENA_SIZE);
+        Run("stack", stack, rounds);
+    }
+
+    {
+        mfg::BlockAllocator block(memory.data(), ARENA_SIZE);
+        Run("block", block, rounds);
+    }
+
+    {
+        mfg::TlsfAllocator tlsf(memory.data(), ARENA_SIZE);
+        Run("tlsf", tlsf, rounds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Runs every workload on every allocator, and prints one CSV line per pair:
+    workload,allocator,threads,ops,ns_per_op,p50_ns,p99_ns,rss_kb,peak_live_kb,footprint_kb,fragmentation,failures
+ns_per_op       The best of the throughput runs, both allocations and deallocations count.
+p50_ns, p99_ns  Latency of single calls, from a separate run timing every 8th call.
+rss_kb          Growth of the resident memory of the process during a separate memory run,
+                the arena of an mfg allocator included.
+peak_live_kb    The most requested bytes in use at once.
+footprint_kb    The bytes the allocator held for them: its used size, or what the C library reports.
+fragmentation   1 - peak_live / footprint, the share lost to headers, padding and rounding,
+                or -1 if the footprint is unknown.
+failures        Allocations which returned nullptr in any run, the results are not valid if it is not 0.
+A mutex guards the allocators which are not thread safe in the workloads with more threads,
+they are named like pool+mutex. Workloads freeing single blocks skip the allocators which can not,
+and every workload skips the pools with fewer blocks than it keeps in use.
+
+Usage: mfg_bench [--workload=name,...] [--allocator=name,...] [--scale=1.0] [--repeat=3] [--list]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <malloc.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Heap.hpp"
+#include "Probe.hpp"
+#include "Workloads.hpp"
+
+using namespace mfg::bench;
+
+namespace {
+    struct Options {
+        std::vector<std::string> workloads;
+        std::vector<std::string> allocators;
+        double scale;
+        size_t repeat;
+    };
+
+    std::vector<std::string> split(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while(std::getline(stream, item, ',')) {
+            if(!item.empty()) {
+                items.push_back(item);
+            }
+        }
+
+        return items;
+    }
+
+    bool selected(const std::vector<std::string>& selection, const std::string& name) {
+        return selection.empty() || std::find(selection.begin(), selection.end(), name) != selection.end();
+    }
+
+    //a field of /proc/self/status in kB, or -1
+    long readStatus(const char* field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        size_t length = strlen(field);
+        while(std::getline(status, line)) {
+            if(line.compare(0, length, field) == 0) {
+                return atol(line.c_str() + length);
+            }
+        }
+
+        return -1;
+    }
+
+    //sets the peak resident size to the current one
+    bool resetPeakRss() {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+        clearRefs.flush();
+        return clearRefs.good();
+    }
+
+    std::unique_ptr<Heap> createHeap(const Workload& workload, const std::string& name) {
+        std::unique_ptr<Heap> heap = CreateHeap(name, workload.config);
+        if(heap != nullptr && workload.threads > 1 && !heap->isThreadSafe()) {
+            heap.reset(new LockedHeap(std::move(heap)));
+        }
+
+        return heap;
+    }
+
+    void measure(const Workload& workload, const std::string& name, const Options& options) {
+        std::unique_ptr<Heap> heap = createHeap(workload, name);
+        if(heap == nullptr || (workload.needsDeallocate && !heap->canDeallocate()) || !heap->supports(workload.config)) {
+            return;
+        }
+
+        uint64_t failures = 0;
+        uint64_t operations = 0;
+        double nsPerOp = 0;
+        for(size_t i = 0; i < options.repeat; i++) {
+            heap = createHeap(workload, name);
+            Probe probe(*heap, Probe::THROUGHPUT);
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            workload.run(*heap, probe, options.scale);
+            double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+            operations = probe.getOperations();
+            failures += probe.getFailures();
+            if(i == 0 || elapsed / operations < nsPerOp) {
+                nsPerOp = elapsed / operations;
+            }
+        }
+
+        heap = createHeap(workload, name);
+        Probe latency(*heap, Probe::LATENCY);
+        workload.run(*heap, latency, options.scale);
+        failures += latency.getFailures();
+
+        heap.reset();
+        malloc_trim(0); //the memory freed by the previous runs does not count
+        long rss = readStatus("VmRSS:");
+        bool peakReset = resetPeakRss();
+
+        heap = createHeap(workload, name);
+        heap->enableStatistics();
+        Probe memory(*heap, Probe::MEMORY);
+        workload.run(*heap, memory, options.scale);
+        failures += memory.getFailures();
+
+        long rssGrowth = peakReset && rss >= 0 ? readStatus("VmHWM:") - rss : -1;
+        double fragmentation = -1;
+        if(memory.getPeakFootprint() > 0) {
+            fragmentation = std::max(0.0, 1.0 - (double) memory.getPeakLive() / memory.getPeakFootprint());
+        }
+
+        std::string allocator = name + (dynamic_cast<LockedHeap*>(heap.get()) != nullptr ? "+mutex" : "");
+        printf("%s,%s,%zu,%llu,%.2f,%.0f,%.0f,%ld,%lld,%zu,%.4f,%llu\n",
+            workload.name, allocator.c_str(), workload.threads, (unsigned long long) operations, nsPerOp,
+            latency.getPercentile(0.5), latency.getPercentile(0.99), rssGrowth,
+            (long long) memory.getPeakLive() / 1024, memory.getPeakFootprint() / 1024, fragmentation,
+            (unsigned long long) failures);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = {{}, {}, 1.0, 3};
+    for(int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if(argument.compare(0, 11, "--workload=") == 0) {
+            options.workloads = split(argument.substr(11));
+        }
+        else if(argument.compare(0, 12, "--allocator=") == 0) {
+            options.allocators = split(argument.substr(12));
+        }
+        else if(argument.compare(0, 8, "--scale=") == 0) {
+            options.scale = atof(argument.c_str() + 8);
+        }
+        else if(argument.compare(0, 9, "--repeat=") == 0) {
+            options.repeat = std::max(1, atoi(argument.c_str() + 9));
+        }
+        else if(argument == "--list") {
+            for(const Workload& workload : GetWorkloads()) {
+                printf("workload %s\n", workload.name);
+            }
+
+            for(const std::string& name : GetHeapNames()) {
+                printf("allocator %s\n", name.c_str());
+            }
+
+            return 0;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--workload=name,...] [--allocator=name,...] [--scale=1.0] [--repeat=3] [--list]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("workload,allocator,threads,ops,ns_per_op,p50_ns,p99_ns,rss_kb,peak_live_kb,footprint_kb,fragmentation,failures\n");
+    for(const Workload& workload : GetWorkloads()) {
+        if(!selected(options.workloads, workload.name)) {
+            continue;
+        }
+
+        for(const std::string& name : GetHeapNames()) {
+            if(selected(options.allocators, name)) {
+                measure(workload, name, options);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Replays a trace written by mfg::TraceRecorder against mfg allocators, and prints one CSV line per allocator:
+    allocator,ops,ns_per_op,peak_live_kb,peak_used_kb,peak_fragmentation,failures,trace_failures,recovered,skipped
+ns_per_op           Time spent in the allocator per replayed operation.
+peak_live_kb        The most requested bytes in use at once.
+peak_used_kb        The high-water mark of the allocator, headers, padding and rounding included.
+peak_fragmentation  The highest 1 - largest free block / free memory of the samples, or -1 if unknown.
+failures            Allocations which failed in the replay, but not in the trace.
+trace_failures      Allocations which failed in the trace. Recovered is how many of them succeeded now.
+skipped             Deallocations of blocks allocated before the trace started.
+With --samples, one line per sample instead:
+    allocator,operation,timestamp_ns,live_kb,used_kb,largest_free_kb,fragmentation
+
+Usage: mfg_replay --trace=path [--allocator=name,...] [--index=0] [--arena=bytes] [--max-size=bytes]
+                  [--interval=4096] [--samples]
+The arena is as big as the traced allocator by default. The pools get blocks of --max-size,
+the biggest request of the trace by default.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Heap.hpp"
+#include "TraceReplay.hpp"
+
+using namespace mfg;
+using namespace mfg::bench;
+
+namespace {
+    struct Options {
+        std::string trace;
+        std::vector<std::string> allocators;
+        uint16_t index;
+        size_t arenaSize;
+        size_t maxSize;
+        size_t interval;
+        bool samples;
+    };
+
+    std::vector<std::string> split(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while(std::getline(stream, item, ',')) {
+            if(!item.empty()) {
+                items.push_back(item);
+            }
+        }
+
+        return items;
+    }
+
+    void replay(TraceReplay& trace, const std::string& name, const Options& options) {
+        std::unique_ptr<Heap> heap = CreateHeap(name, {options.arenaSize, options.maxSize});
+        MfgHeap* mfgHeap = dynamic_cast<MfgHeap*>(heap.get());
+        if(mfgHeap == nullptr) {
+            fprintf(stderr, "%s is not an mfg allocator\n", name.c_str());
+            return;
+        }
+
+        trace.run(*mfgHeap->getAllocator(), options.interval);
+
+        if(options.samples) {
+            for(const ReplaySample& sample : trace.getSamples()) {
+                printf("%s,%llu,%llu,%zu,%zu,%zu,%.4f\n",
+                    name.c_str(), (unsigned long long) sample.operation, (unsigned long long) sample.timestamp,
+                    sample.live / 1024, sample.used / 1024, sample.largestFreeBlock / 1024, sample.fragmentation);
+            }
+        }
+        else {
+            size_t operations = trace.getNumberOfOperations();
+            printf("%s,%zu,%.2f,%zu,%zu,%.4f,%llu,%llu,%llu,%llu\n",
+                name.c_str(), operations, operations > 0 ? (double) trace.getElapsed() / operations : 0.0,
+                trace.getPeakLive() / 1024, trace.getPeakUsed() / 1024, trace.getPeakFragmentation(),
+                (unsigned long long) trace.getFailures(), (unsigned long long) trace.getTraceFailures(),
+                (unsigned long long) trace.getRecovered(), (unsigned long long) trace.getSkipped());
+        }
+
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = {"", {"stack", "pool", "bitmap_pool", "block", "buddy", "tlsf", "slab", "lockfree_pool", "cached_pool"}, 0, 0, 0, 4096, false};
+    for(int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if(argument.compare(0, 8, "--trace=") == 0) {
+            options.trace = argument.substr(8);
+        }
+        else if(argument.compare(0, 12, "--allocator=") == 0) {
+            options.allocators = split(argument.substr(12));
+        }
+        else if(argument.compare(0, 8, "--index=") == 0) {
+            options.index = atoi(argument.c_str() + 8);
+        }
+        else if(argument.compare(0, 8, "--arena=") == 0) {
+            options.arenaSize = strtoull(argument.c_str() + 8, nullptr, 10);
+        }
+        else if(argument.compare(0, 11, "--max-size=") == 0) {
+            options.maxSize = strtoull(argument.c_str() + 11, nullptr, 10);
+        }
+        else if(argument.compare(0, 11, "--interval=") == 0) {
+            options.interval = strtoull(argument.c_str() + 11, nullptr, 10);
+        }
+        else if(argument == "--samples") {
+            options.samples = true;
+        }
+        else {
+            options.trace.clear();
+            break;
+        }
+    }
+
+    if(options.trace.empty()) {
+        fprintf(stderr, "usage: %s --trace=path [--allocator=name,...] [--index=0] [--arena=bytes] [--max-size=bytes] [--interval=4096] [--samples]\n", argv[0]);
+        return 1;
+    }
+
+    TraceReplay trace(options.trace.c_str(), options.index);
+    if(!trace.isLoaded()) {
+        fprintf(stderr, "%s is not a trace\n", options.trace.c_str());
+        return 1;
+    }
+
+    if(options.arenaSize == 0) {
+        options.arenaSize = trace.getArenaSize();
+        if(options.arenaSize == 0) {
+            fprintf(stderr, "the size of the allocator is not in the trace, give --arena\n");
+            return 1;
+        }
+    }
+
+    if(options.maxSize == 0) {
+        options.maxSize = (std::max(trace.getLargestRequest(), sizeof(void*)) + 7) & ~(size_t) 7;
+    }
+
+    if(options.samples) {
+        printf("allocator,operation,timestamp_ns,live_kb,used_kb,largest_free_kb,fragmentation\n");
+    }
+    else {
+        printf("allocator,ops,ns_per_op,peak_live_kb,peak_used_kb,peak_fragmentation,failures,trace_failures,recovered,skipped\n");
+    }
+
+    for(const std::string& name : options.allocators) {
+        replay(trace, name, options);
+    }
+
+    return 0;
+}
@@ -22,14 +22,18 @@ freely, subject to the following restrictions:
 #ifndef MFG_ALLOCATOR_HPP
 #define MFG_ALLOCATOR_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 
 #include "mfg.hpp"
+#include "HeapProfiler.hpp"
+#include "Statistics.hpp"
+#include "TraceRecorder.hpp"
 
 //! \namespace  mfg
-//! \def    MFG_MEMORY_REPORT   If defined, then you can use the memory report functions.
+//! \def    MFG_MEMORY_REPORT   If defined, every allocator switches on its statistics when constructed.
 //! \def    MFG_DEBUG           If defined assertions will work.
 namespace mfg {
     /*! \class  Allocator
@@ -39,20 +43,243 @@ namespace mfg {
      */
     class Allocator {
     protected:
-        /*! \fn     Allocator(void* memory, const size_t& size)
+        /*! \fn     Allocator(void* memory, const size_t& size, const bool& zeroMemory = true)
          *  \brief  Constructor for child classes.
          *  \param  memory The beginning of the memory.
          *  \param  size The size of the memory.
+         *  \param  zeroMemory If true, the memory is filled with zeros.
          */
-        Allocator(void* memory, const size_t& size);
+        Allocator(void* memory, const size_t& size, const bool& zeroMemory = true);
 
         void* mMemory;  //! \var    mMemory The beginning of the memory block.
         size_t mSize;   //! \var    mSize The size of the memory block.
 
-#ifdef MFG_MEMORY_REPORT
-        size_t mMrUsed;                 //! \var    mMrUsed Size of memory in use.
-        uint32_t mMrNumOfAllocations;   //! \var    mMrNumOfAllocations
-#endif
+        /*! \fn     Statistics* getStatistics() const
+         *  \return The statistics, or nullptr if they are switched off.
+         */
+        Statistics* getStatistics() const { return mStatistics.load(std::memory_order_relaxed); }
+
+        /*! \fn     bool isObserved() const
+         *  \return True if the statistics, the tracing or the profiling are on, so the hooks want to hear every block.
+         */
+        bool isObserved() const {
+            return getStatistics() != nullptr || mRecorder.load(std::memory_order_relaxed) != nullptr || mProfiler.load(std::memory_order_relaxed) != nullptr;
+        }
+
+        /*! \fn     void onAllocate(void* memory, const size_t& size, const size_t& used, const size_t& alignment = 0, const bool& top = false)
+         *  \brief  Records a successful allocation.
+         *  \param  memory The beginning of the block.
+         *  \param  size The requested size.
+         *  \param  used The size of memory taken by the allocation.
+         *  \param  alignment The requested alignment, or 0 if it has not been given.
+         *  \param  top True if it is on the upper stack of a DoubleEndedStackAllocator.
+         */
+        void onAllocate(void* memory, const size_t& size, const size_t& used, const size_t& alignment = 0, const bool& top = false) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordAllocate(size, used);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::ALLOCATE, (uintptr_t) memory, size, top ? TraceEvent::TOP : 0, alignment);
+            }
+
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr) {
+                profiler->recordAllocate(this, memory, size);
+            }
+        }
+
+        /*! \fn     void onAllocateBatch(void** memory, const size_t& size, const size_t& used, const size_t& count)
+         *  \brief  Records successful allocations with the same requested size.
+         *  \param  memory The beginning of the blocks.
+         *  \param  size The requested size.
+         *  \param  used The size of memory taken by all of them.
+         *  \param  count The number of allocations.
+         */
+        void onAllocateBatch(void** memory, const size_t& size, const size_t& used, const size_t& count) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordAllocate(size, used, count);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                for(size_t i = 0; i < count; i++) {
+                    recorder->record(mTraceIndex, TraceEvent::ALLOCATE, (uintptr_t) memory[i], size);
+                }
+            }
+
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr) {
+                for(size_t i = 0; i < count; i++) {
+                    profiler->recordAllocate(this, memory[i], size);
+                }
+            }
+        }
+
+        /*! \fn     void onFailedAllocation(const size_t& size, const size_t& alignment = 0, const bool& top = false)
+         *  \brief  Records an allocation which returned nullptr.
+         *  \param  size The requested size.
+         *  \param  alignment The requested alignment, or 0 if it has not been given.
+         *  \param  top True if it is on the upper stack of a DoubleEndedStackAllocator.
+         */
+        void onFailedAllocation(const size_t& size, const size_t& alignment = 0, const bool& top = false) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordFailure(size);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::ALLOCATE, 0, size, TraceEvent::FAILED | (top ? TraceEvent::TOP : 0), alignment);
+            }
+        }
+
+        /*! \fn     void onDeallocate(void* memory, const size_t& used)
+         *  \brief  Records a deallocation. It has to be called before the block can be reused.
+         *  \param  memory The beginning of the block.
+         *  \param  used The size of memory given back.
+         */
+        void onDeallocate(void* memory, const size_t& used) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordDeallocate(used);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::DEALLOCATE, (uintptr_t) memory, 0);
+            }
+
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr) {
+                profiler->recordDeallocate(memory);
+            }
+        }
+
+        /*! \fn     void onDeallocateBatch(void** memory, const size_t& used, const size_t& count)
+         *  \brief  Records deallocations. It has to be called before the blocks can be reused.
+         *  \param  memory The beginning of the blocks.
+         *  \param  used The size of memory given back by all of them.
+         *  \param  count The number of blocks.
+         */
+        void onDeallocateBatch(void** memory, const size_t& used, const size_t& count) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordDeallocate(used, count);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                for(size_t i = 0; i < count; i++) {
+                    recorder->record(mTraceIndex, TraceEvent::DEALLOCATE, (uintptr_t) memory[i], 0);
+                }
+            }
+
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr) {
+                for(size_t i = 0; i < count; i++) {
+                    profiler->recordDeallocate(memory[i]);
+                }
+            }
+        }
+
+        /*! \fn     void onMarker(const Marker& marker, const bool& top = false)
+         *  \brief  Records a marker handed out by a stack.
+         *  \param  marker Counted from the end for an upper stack.
+         *  \param  top True if it is the upper stack of a DoubleEndedStackAllocator.
+         */
+        void onMarker(const Marker& marker, const bool& top = false) {
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::MARKER, 0, marker, top ? TraceEvent::TOP : 0);
+            }
+        }
+
+        /*! \fn     void onDeallocateTo(const Marker& marker, const size_t& used, const size_t& count, const void* begin, const void* end, const bool& top = false)
+         *  \brief  Records that a stack rolled back to a marker. It has to be called before the memory can be reused.
+         *  \param  marker Counted from the end for an upper stack.
+         *  \param  used The size of memory given back.
+         *  \param  count The number of deallocated allocations.
+         *  \param  begin The beginning of the memory given back.
+         *  \param  end The end of the memory given back.
+         *  \param  top True if it is the upper stack of a DoubleEndedStackAllocator.
+         */
+        void onDeallocateTo(const Marker& marker, const size_t& used, const size_t& count, const void* begin, const void* end, const bool& top = false) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordDeallocate(used, count);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::DEALLOCATE_TO, 0, marker, top ? TraceEvent::TOP : 0);
+            }
+
+            onRelease(begin, end);
+        }
+
+        /*! \fn     void onBeginFrame(const size_t& used, const size_t& count, const void* begin, const void* end)
+         *  \brief  Records that a FrameAllocator switched frames. It has to be called before the memory can be reused.
+         *  \param  used The size of memory given back.
+         *  \param  count The number of deallocated allocations.
+         *  \param  begin The beginning of the memory given back.
+         *  \param  end The end of the memory given back.
+         */
+        void onBeginFrame(const size_t& used, const size_t& count, const void* begin, const void* end) {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordDeallocate(used, count);
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::BEGIN_FRAME, 0, 0);
+            }
+
+            onRelease(begin, end);
+        }
+
+        /*! \fn     void onRelease(const void* begin, const void* end)
+         *  \brief  Records for the profiler that every block in a range has been deallocated at once.
+         *          The statistics and the trace are told by the hook of the operation.
+         *  \param  begin The beginning of the range.
+         *  \param  end The end of the range.
+         */
+        void onRelease(const void* begin, const void* end) {
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr && begin != end) {
+                profiler->recordRelease(this, begin, end);
+            }
+        }
+
+        /*! \fn     void onClear()
+         *  \brief  Records that every allocation has been deallocated.
+         */
+        void onClear() {
+            Statistics* statistics = getStatistics();
+            if(statistics != nullptr) {
+                statistics->recordClear();
+            }
+
+            TraceRecorder* recorder = mRecorder.load(std::memory_order_relaxed);
+            if(recorder != nullptr) {
+                recorder->record(mTraceIndex, TraceEvent::CLEAR, 0, 0);
+            }
+
+            HeapProfiler* profiler = mProfiler.load(std::memory_order_relaxed);
+            if(profiler != nullptr) {
+                profiler->recordClear(this);
+            }
+        }
+    private:
+        std::atomic<Statistics*> mStatistics; //nullptr while statistics are off
+        Statistics* mStatisticsStorage; //kept until destruction, so switching off never frees it under a reader
+        std::atomic<TraceRecorder*> mRecorder; //nullptr while tracing is off
+        uint16_t mTraceIndex; //index of the allocator in the trace
+        std::atomic<HeapProfiler*> mProfiler; //nullptr while profiling is off
     public:
         Allocator(const Allocator& other) = delete;
         Allocator& operator=(const Allocator& other) = delete;
@@ -71,18 +298,50 @@ namespace mfg {
          */
         virtual void* allocate(const size_t& size) = 0;
 
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Pure virtual method for allocating aligned memory.
+         *  \param  size Required size of memory.
+         *  \param  alignment Required alignment of the memory. (Must be a power of two.)
+         *  \return The beginning of the memory.
+         */
+        virtual void* allocate(const size_t& size, const size_t& alignment) = 0;
+
         /*! \fn     void deallocate(void* memory)
          *  \brief  Pure virtual method for deallocating memory.
          *  \param  memory The beginning of the memory.
          */
         virtual void deallocate(void* memory) = 0;
 
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Resizes the specified memory block. By default a new block is allocated,
+         *          and the content is copied into it, unless the block is already big enough.
+         *          The allocators which can resize in place override it.
+         *  \param  memory The beginning of the memory block, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory block, or nullptr if it does not fit.
+         *          The old block is unchanged then.
+         */
+        virtual void* reallocate(void* memory, const size_t& size);
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the memory block which may be used, or 0 if the allocator
+         *          does not know it. reallocate() copies this many bytes by default.
+         */
+        virtual size_t getUsableSize(void* memory);
+
         /*! \fn     void clear()
          *  \brief  Pure virtual method for deallocating all the
          *          previously allocated memory.
          */
         virtual void clear() = 0;
 
+        /*! \fn     bool canDeallocate() const
+         *  \return False if deallocate() does not free anything, and memory
+         *          comes back only by clear(), otherwise true.
+         */
+        virtual bool canDeallocate() const;
+
         /*! \fn     bool isOutOfMemory()
          *  \return True if there is no more allocatable memory, otherwise false.
          */
@@ -98,19 +357,86 @@ namespace mfg {
          */
         size_t getSize();
 
-#ifdef MFG_MEMORY_REPORT
+        /*! \fn     void enableStatistics(const char* name = nullptr)
+         *  \brief  Switches on the statistics, and registers the allocator for
+         *          Statistics::SnapshotAll(). Allocations before it are not counted.
+         *          No other thread may use the allocator meanwhile.
+         *  \param  name Name for the snapshots, or nullptr.
+         */
+        void enableStatistics(const char* name = nullptr);
+
+        /*! \fn     void disableStatistics()
+         *  \brief  Switches off the statistics. They keep their values until switched on again.
+         *          No other thread may use the allocator meanwhile.
+         */
+        void disableStatistics();
+
+        /*! \fn     bool isStatisticsEnabled() const
+         *  \return True if the statistics are on.
+         */
+        bool isStatisticsEnabled() const;
+
+        /*! \fn     bool snapshotStatistics(StatisticsSnapshot& snapshot) const
+         *  \brief  Reads the statistics.
+         *  \param  snapshot Receives the statistics.
+         *  \return False if the statistics are off, otherwise true.
+         */
+        bool snapshotStatistics(StatisticsSnapshot& snapshot) const;
+
         /*! \fn     size_t getUsedSize()
-         *  \return The size of memory in use.
+         *  \return The size of memory in use, or 0 if the statistics are off.
          */
         size_t getUsedSize();
 
         /*! \fn     size_t getNumberOfAllocations()
-         *  \return The number of allocations.
+         *  \return The number of allocations in use, or 0 if the statistics are off.
          */
         size_t getNumberOfAllocations();
-#endif
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \brief  Shows how fragmented the free memory is. It may walk the free blocks,
+         *          so it is meant for diagnostics, not for every call.
+         *  \return The biggest size which can be allocated at once, or 0 if the allocator can not tell.
+         */
+        virtual size_t getLargestFreeBlock();
+
+        /*! \fn     void startTrace(TraceRecorder* recorder)
+         *  \brief  Starts to record every call into a trace. No other thread may use the allocator meanwhile.
+         *  \param  recorder It has to live until stopTrace() or the destruction of the allocator.
+         */
+        void startTrace(TraceRecorder* recorder);
+
+        /*! \fn     void stopTrace()
+         *  \brief  Stops recording. No other thread may use the allocator meanwhile.
+         */
+        void stopTrace();
+
+        /*! \fn     void startProfile(HeapProfiler* profiler)
+         *  \brief  Starts to sample the allocations. The stacks tell the profiler the memory
+         *          they release at a marker or at a new frame, so it forgets those samples.
+         *          No other thread may use the allocator meanwhile.
+         *  \param  profiler It has to live until stopProfile() or the destruction of the allocator.
+         */
+        void startProfile(HeapProfiler* profiler);
+
+        /*! \fn     void stopProfile()
+         *  \brief  Stops sampling, the samples of the allocator are forgotten.
+         *          No other thread may use the allocator meanwhile.
+         */
+        void stopProfile();
     };
 
-    static Allocator* defaultAllocator = nullptr;
+    /*! \fn     Allocator* GetDefaultAllocator()
+     *  \return The process-wide default allocator, or nullptr if it is not set.
+     */
+    Allocator* GetDefaultAllocator();
+
+    /*! \fn     Allocator* SetDefaultAllocator(Allocator* allocator)
+     *  \brief  Sets the process-wide default allocator. It can be called before the static
+     *          constructors run, the registry needs no construction.
+     *  \param  allocator It has to live while it is the default, nullptr unsets it.
+     *  \return The previous default allocator.
+     */
+    Allocator* SetDefaultAllocator(Allocator* allocator);
 }//mfg
 #endif // MFG_ALLOCATOR_HPP
@@ -0,0 +1,157 @@
+/*! \file   BitmapPoolAllocator.hpp
+ *  \brief  Pool allocator which keeps the state of its blocks in a bitmap.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BITMAPPOOLALLOCATOR_HPP
+#define MFG_BITMAPPOOLALLOCATOR_HPP
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  BitmapPoolAllocator
+     *  \brief  This class can allocate only the same size of blocks, like PoolAllocator,
+     *          but the blocks never hold allocator data. A bit per block tells whether it is
+     *          in use, and a summary bit per word of the bitmap tells whether the word is full.
+     *          An allocation takes the lowest free block: the summary is scanned (with SSE2)
+     *          from the lowest word which may have a free block, then tzcnt finds the bit,
+     *          so the blocks in use stay packed at the beginning. A deallocation only clears
+     *          bits, the block itself is not touched.
+     *          The bitmaps are at the beginning of the memory, the blocks are after them.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class BitmapPoolAllocator : public Allocator {
+    private:
+        enum : size_t {
+            BLOCK_ALIGNMENT = 64, //the first block starts a cache line
+            NO_SHIFT = ~(size_t) 0
+        };
+
+        uint64_t* mBitmap; //a bit per block, set if it is in use
+        uint64_t* mSummary; //a bit per word of mBitmap, set if the word is full
+        void* mBlocks; //the first block
+        size_t mBlockSize; //size of blocks
+        size_t mBlockShift; //log2 of mBlockSize, or NO_SHIFT if it is not a power of two
+        size_t mNumOfBlocks; //number of blocks
+        size_t mNumOfWords; //words of mBitmap
+        size_t mNumOfSummaryWords; //words of mSummary
+        size_t mHint; //no free block in the summary words below it
+
+        size_t blockIndex(const void* memory) const;
+        size_t findFreeWord();
+        void* takeBlock(const size_t& word, const size_t& bit);
+    public:
+        /*! \fn     BitmapPoolAllocator(void* memory, const size_t& size, const size_t& blockSize)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory, the bitmaps included.
+         *  \param  blockSize Size of blocks.
+         */
+        BitmapPoolAllocator(void* memory, const size_t& size, const size_t& blockSize);
+
+        BitmapPoolAllocator(const BitmapPoolAllocator& other) = delete;
+        BitmapPoolAllocator& operator=(const BitmapPoolAllocator& other) = delete;
+        BitmapPoolAllocator(BitmapPoolAllocator&& other) = delete;
+        BitmapPoolAllocator& operator=(BitmapPoolAllocator&& other) = delete;
+
+        /*! \fn ~BitmapPoolAllocator()
+         *  \brief Destructor.
+         */
+        ~BitmapPoolAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates the free block with the lowest address.
+         *  \param  size Can not be bigger than size of a block.
+         *  \return The beginning of the memory block, or nullptr if there is no free block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates the aligned free block with the lowest address. It is as fast as
+         *          the unaligned version if the size of blocks is aligned, otherwise it walks the free bits.
+         *  \param  size Can not be bigger than size of a block.
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory, only its bits are written.
+         *  \param  memory The beginning of the memory.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the blocks.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of a block, or 0 if every block is in use.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     bool isAllocated(const void* memory) const
+         *  \param  memory An address inside a block.
+         *  \return True if the block is in use, false if it is free or the memory is not in the pool.
+         */
+        bool isAllocated(const void* memory) const;
+
+        /*! \fn     void forEachLive(Function function) const
+         *  \brief  Calls function(void* memory) for every block in use, in address order.
+         *          Empty words of the bitmap are skipped 64 blocks at once. The function
+         *          may deallocate the block it gets, but nothing else.
+         *  \param  function
+         */
+        template<typename Function>
+        void forEachLive(Function function) const {
+            for(size_t word = 0; word < mNumOfWords; word++) {
+                uint64_t bits = mBitmap[word];
+                if(word == mNumOfWords - 1 && (mNumOfBlocks & 63) != 0) { //the bits after the last block are set
+                    bits &= ((uint64_t) 1 << (mNumOfBlocks & 63)) - 1;
+                }
+
+                while(bits != 0) {
+                    size_t bit = __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    function(mBlocks + (word * 64 + bit) * mBlockSize);
+                }
+            }
+        }
+
+        /*! \fn     const size_t& getBlockSize() const
+         *  \return The size of one block.
+         */
+        const size_t& getBlockSize() const;
+
+        /*! \fn     const size_t& getNumberOfBlocks() const
+         *  \return The number of blocks.
+         */
+        const size_t& getNumberOfBlocks() const;
+    };
+}//mfg
+
+#endif // MFG_BITMAPPOOLALLOCATOR_HPP
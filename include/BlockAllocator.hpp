@@ -23,21 +23,21 @@ freely, subject to the following restrictions:
 #define MFG_BLOCKALLOCATOR_HPP
 
 #include "Allocator.hpp"
+#include "BlockPolicy.hpp"
 
 //! \namespace  mfg
 namespace mfg {
     /*! \class  BlockAllocator
      *  \brief  This class can allocate different size of blocks.
+     *          Every block starts with its size, and free blocks also end
+     *          with it (boundary tags), so a deallocated block is merged with
+     *          its physical neighbours without walking the list of free blocks.
+     *          It is a virtual wrapper over BlockPolicy.
      *          Copy and move constructors and assignments are unavailable.
      */
     class BlockAllocator : public Allocator {
     private:
-        struct Block { //mask for blocks
-            size_t size;
-            Block* next;
-        };
-
-        Block* mBlocks; //blocks
+        BlockPolicy mPolicy; //the strategy
     public:
         /*! \fn     BlockAllocator(void* memory, const size_t& size)
          *  \brief  Constructor.
@@ -59,26 +59,75 @@ namespace mfg {
         /*! \fn     void* allocate(const size_t& size)
          *  \brief  Allocates one block of memory with the specified size.
          *  \param  size
-         *  \return The beginning of the memory block.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
          */
         void* allocate(const size_t& size) final;
 
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates one aligned block of memory with the specified size.
+         *          The space skipped in front of it stays a free block.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
         /*! \fn     void deallocate(void* memory)
          *  \brief  Deallocates the specified memory block.
          *  \param  memory The beginning of the memory block.
          */
         void deallocate(void* memory) final;
 
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Resizes the specified memory block in place if the physically next block
+         *          is free or it shrinks, otherwise it is moved into a new block.
+         *  \param  memory The beginning of the memory block, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         *          The old block is unchanged then.
+         */
+        void* reallocate(void* memory, const size_t& size) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block without the header.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     size_t allocateBatch(const size_t& size, const size_t& count, void** memory)
+         *  \brief  Allocates many blocks with the same size with one call. They are carved
+         *          one after another from as few free blocks as possible, and the list
+         *          of free blocks is updated once per free block.
+         *  \param  size
+         *  \param  count The number of blocks.
+         *  \param  memory Receives the beginning of the blocks.
+         *  \return The number of allocated blocks, less than count if the memory runs out.
+         */
+        size_t allocateBatch(const size_t& size, const size_t& count, void** memory);
+
+        /*! \fn     void deallocateBatch(void** memory, const size_t& count)
+         *  \brief  Deallocates many blocks with one call, each merged with its free neighbours.
+         *  \param  memory The beginning of the blocks.
+         *  \param  count The number of blocks.
+         */
+        void deallocateBatch(void** memory, const size_t& count);
+
         /*! \fn     void clear()
          *  \brief  Deallocates all the previously allocated blocks.
          */
         void clear() final;
 
-        /*! \fn     const size_t& CheckSize(void* memory)
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The biggest size which can be allocated at once. It walks the list of free blocks.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     size_t CheckSize(void* memory)
          *  \brief  Check the size of the specified memory block.
          *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, header included.
          */
-        static const size_t& CheckSize(void* memory);
+        static size_t CheckSize(void* memory);
 
 #ifdef MFG_DEBUG
         /*! \fn     void printSizeOfBlocks()
@@ -0,0 +1,519 @@
+/*! \file   BlockPolicy.hpp
+ *  \brief  Inline block strategy for compile-time composition.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BLOCKPOLICY_HPP
+#define MFG_BLOCKPOLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mfg.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  BlockPolicy
+     *  \brief  The block strategy without virtual dispatch. Every method is
+     *          inline, so it can be composed at compile time, and it returns
+     *          nullptr when there is no fitting block.
+     *          Every block starts with its size, and free blocks also end
+     *          with it (boundary tags), so a deallocated block is merged with
+     *          its physical neighbours without walking the list of free blocks.
+     *          BlockAllocator is a virtual wrapper over it.
+     */
+    class BlockPolicy {
+    private:
+        struct Block { //mask for free blocks, the size is repeated in the last word
+            size_t size; //size of the block with flags in the lowest bits
+            Block* next;
+            Block* prev;
+        };
+
+        enum : size_t {
+            BLOCK_FREE_BIT = 1, //the block is free
+            PREV_FREE_BIT = 2, //the physically previous block is free
+            SIZE_MASK = ~(size_t) 3,
+            MIN_BLOCK_SIZE = sizeof(Block) + sizeof(size_t) //a block has to be able to become free again
+        };
+
+        void* mMemory; //beginning of the memory
+        void* mEnd; //end of the usable memory
+        Block* mBlocks; //free blocks
+
+        void linkBlock(Block* block) {
+            block->prev = nullptr;
+            block->next = mBlocks;
+            if(mBlocks != nullptr) {
+                mBlocks->prev = block;
+            }
+            mBlocks = block;
+        }
+
+        void unlinkBlock(Block* block) {
+            if(block->next != nullptr) {
+                block->next->prev = block->prev;
+            }
+
+            if(block->prev != nullptr) {
+                block->prev->next = block->next;
+            }
+            else {
+                mBlocks = block->next;
+            }
+        }
+
+        size_t blockSizeFor(size_t size) const {
+            size_t newSize = (size + 2 * sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+            return newSize < MIN_BLOCK_SIZE ? (size_t) MIN_BLOCK_SIZE : newSize;
+        }
+
+        void* useBlock(Block* block, size_t gap, size_t newSize) {
+            size_t blockSize = block->size & SIZE_MASK;
+            size_t prevFree = 0; //the previous block of a free block is never free
+
+            unlinkBlock(block);
+
+            if(gap > 0) { //the front of the block stays free
+                block->size = gap | BLOCK_FREE_BIT;
+                *((size_t*) ((void*) block + gap) - 1) = gap;
+                linkBlock(block);
+
+                block = (Block*) ((void*) block + gap);
+                blockSize -= gap;
+                prevFree = PREV_FREE_BIT;
+            }
+
+            if(blockSize - newSize >= MIN_BLOCK_SIZE) { //the rest is still enough to became a new block
+                Block* rest = (Block*) ((void*) block + newSize);
+                rest->size = (blockSize - newSize) | BLOCK_FREE_BIT;
+                *((size_t*) ((void*) rest + (blockSize - newSize)) - 1) = blockSize - newSize;
+                linkBlock(rest);
+            }
+            else { //the block completely disappears
+                newSize = blockSize;
+
+                Block* next = (Block*) ((void*) block + blockSize);
+                if((void*) next < mEnd) {
+                    next->size &= ~(size_t) PREV_FREE_BIT;
+                }
+            }
+
+            block->size = newSize | prevFree;
+            return ((void*) block) + sizeof(size_t);
+        }
+    public:
+        /*! \fn     BlockPolicy(void* memory, size_t size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         */
+        BlockPolicy(void* memory, size_t size) :
+            mMemory(memory),
+            mEnd(memory + (size & ~(sizeof(size_t) - 1)))
+        {
+            ASSERT(size >= MIN_BLOCK_SIZE);
+
+            clear();
+        }
+
+        /*! \fn     void* allocate(size_t size)
+         *  \brief  Allocates the best fitting block of memory with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(size_t size) {
+            if(size >= (uintptr_t) mEnd - (uintptr_t) mMemory) {
+                return nullptr;
+            }
+
+            size_t newSize = blockSizeFor(size);
+            Block* bestFit = nullptr;
+            size_t bestFitSize = 0;
+
+            for(Block* block = mBlocks; block != nullptr; block = block->next) {
+                size_t blockSize = block->size & SIZE_MASK;
+                if(blockSize >= newSize && (bestFit == nullptr || blockSize < bestFitSize)) { //the block is enough and fits better
+                    bestFit = block;
+                    bestFitSize = blockSize;
+
+                    if(blockSize == newSize) { //can not fit better
+                        break;
+                    }
+                }
+            }
+
+            if(bestFit == nullptr) { //there is no block which fit.
+                return nullptr;
+            }
+
+            return useBlock(bestFit, 0, newSize);
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \brief  Allocates the best fitting aligned block of memory with the specified size.
+         *          The space skipped in front of it stays a free block.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            if(alignment <= sizeof(size_t)) { //every block is aligned this way
+                return allocate(size);
+            }
+
+            if(size >= (uintptr_t) mEnd - (uintptr_t) mMemory) {
+                return nullptr;
+            }
+
+            size_t newSize = blockSizeFor(size);
+            Block* bestFit = nullptr;
+            size_t bestFitSize = 0;
+            size_t bestFitGap = 0;
+
+            for(Block* block = mBlocks; block != nullptr; block = block->next) {
+                size_t blockSize = block->size & SIZE_MASK;
+
+                uintptr_t begin = (uintptr_t) block + sizeof(size_t);
+                size_t gap = ((begin + alignment - 1) & ~(uintptr_t) (alignment - 1)) - begin;
+                if(gap > 0 && gap < MIN_BLOCK_SIZE) { //the skipped space has to be able to become a free block
+                    gap = ((begin + MIN_BLOCK_SIZE + alignment - 1) & ~(uintptr_t) (alignment - 1)) - begin;
+                }
+
+                if(blockSize >= gap + newSize && (bestFit == nullptr || blockSize < bestFitSize)) { //the block is enough and fits better
+                    bestFit = block;
+                    bestFitSize = blockSize;
+                    bestFitGap = gap;
+
+                    if(blockSize == gap + newSize) { //can not fit better
+                        break;
+                    }
+                }
+            }
+
+            if(bestFit == nullptr) { //there is no block which fit.
+                return nullptr;
+            }
+
+            return useBlock(bestFit, bestFitGap, newSize);
+        }
+
+        /*! \fn     size_t allocateBatch(size_t size, size_t count, void** memory)
+         *  \brief  Allocates many blocks with the same size at once. They are carved
+         *          one after another from the smallest free block which holds all of
+         *          them (or from the biggest ones, if none does), so the list of free
+         *          blocks is updated once per free block instead of once per block.
+         *  \param  size
+         *  \param  count The number of blocks.
+         *  \param  memory Receives the beginning of the blocks.
+         *  \return The number of allocated blocks, less than count if the memory runs out.
+         */
+        size_t allocateBatch(size_t size, size_t count, void** memory) {
+            if(size >= (uintptr_t) mEnd - (uintptr_t) mMemory) {
+                return 0;
+            }
+
+            size_t newSize = blockSizeFor(size);
+            size_t allocated = 0;
+
+            while(allocated < count) {
+                size_t needed = (count - allocated) * newSize;
+                Block* chosen = nullptr;
+                size_t chosenSize = 0;
+
+                for(Block* block = mBlocks; block != nullptr; block = block->next) {
+                    size_t blockSize = block->size & SIZE_MASK;
+                    if(blockSize < newSize) {
+                        continue;
+                    }
+
+                    if(chosen == nullptr || (chosenSize < needed ? blockSize > chosenSize : blockSize >= needed && blockSize < chosenSize)) {
+                        chosen = block;
+                        chosenSize = blockSize;
+                    }
+                }
+
+                if(chosen == nullptr) { //there is no block which fit.
+                    break;
+                }
+
+                unlinkBlock(chosen);
+
+                size_t carved = chosenSize / newSize < count - allocated ? chosenSize / newSize : count - allocated;
+                void* block = (void*) chosen;
+                for(size_t i = 0; i < carved; i++) { //the previous block of each is in use
+                    ((Block*) block)->size = newSize;
+                    memory[allocated++] = block + sizeof(size_t);
+                    block += newSize;
+                }
+
+                size_t rest = chosenSize - carved * newSize;
+                if(rest >= MIN_BLOCK_SIZE) { //the rest is still enough to became a new block
+                    Block* restBlock = (Block*) block;
+                    restBlock->size = rest | BLOCK_FREE_BIT;
+                    *((size_t*) (block + rest) - 1) = rest;
+                    linkBlock(restBlock);
+                }
+                else { //the last block gets the rest
+                    ((Block*) (block - newSize))->size += rest;
+
+                    Block* next = (Block*) (block + rest);
+                    if((void*) next < mEnd) {
+                        next->size &= ~(size_t) PREV_FREE_BIT;
+                    }
+                }
+            }
+
+            return allocated;
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block, and merges it with its free neighbours.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) {
+            Block* deallocBlock = (Block*) (memory - sizeof(size_t));
+            size_t size = deallocBlock->size & SIZE_MASK;
+
+            ASSERT((deallocBlock->size & BLOCK_FREE_BIT) == 0);
+
+            Block* next = (Block*) ((void*) deallocBlock + size);
+
+            if(deallocBlock->size & PREV_FREE_BIT) { //exactly next to the previous block
+                size_t prevSize = *((size_t*) deallocBlock - 1);
+                Block* prev = (Block*) ((void*) deallocBlock - prevSize);
+                unlinkBlock(prev);
+                size += prevSize;
+                deallocBlock = prev;
+            }
+
+            if((void*) next < mEnd) {
+                if(next->size & BLOCK_FREE_BIT) { //exactly before the next block
+                    unlinkBlock(next);
+                    size += next->size & SIZE_MASK;
+                    next = (Block*) ((void*) deallocBlock + size);
+                }
+
+                if((void*) next < mEnd) {
+                    next->size |= PREV_FREE_BIT;
+                }
+            }
+
+            deallocBlock->size = size | BLOCK_FREE_BIT;
+            *((size_t*) ((void*) deallocBlock + size) - 1) = size;
+            linkBlock(deallocBlock);
+        }
+
+        /*! \fn     bool reallocate(void* memory, size_t size)
+         *  \brief  Resizes the specified memory block in place. It grows into the physically
+         *          next block if that is free, and the end of a shrinking block becomes free.
+         *  \param  memory The beginning of the memory block.
+         *  \param  size The new size.
+         *  \return False if the block can not grow in place, it is unchanged then.
+         */
+        bool reallocate(void* memory, size_t size) {
+            Block* block = (Block*) (memory - sizeof(size_t));
+            size_t blockSize = block->size & SIZE_MASK;
+
+            ASSERT((block->size & BLOCK_FREE_BIT) == 0);
+
+            if(size >= (uintptr_t) mEnd - (uintptr_t) mMemory) {
+                return false;
+            }
+
+            size_t newSize = blockSizeFor(size);
+            Block* next = (Block*) ((void*) block + blockSize);
+            size_t available = blockSize;
+            if(newSize > blockSize) {
+                if((void*) next >= mEnd || (next->size & BLOCK_FREE_BIT) == 0 || blockSize + (next->size & SIZE_MASK) < newSize) {
+                    return false;
+                }
+
+                unlinkBlock(next);
+                available += next->size & SIZE_MASK;
+                next = (Block*) ((void*) block + available);
+            }
+            else if(blockSize - newSize < MIN_BLOCK_SIZE) { //the end is too small to became a block
+                return true;
+            }
+
+            if(available - newSize >= MIN_BLOCK_SIZE) { //the rest becomes a free block
+                Block* rest = (Block*) ((void*) block + newSize);
+                size_t restSize = available - newSize;
+                if((void*) next < mEnd && (next->size & BLOCK_FREE_BIT)) { //only when shrinking
+                    unlinkBlock(next);
+                    restSize += next->size & SIZE_MASK;
+                    next = (Block*) ((void*) rest + restSize);
+                }
+
+                rest->size = restSize | BLOCK_FREE_BIT;
+                *((size_t*) ((void*) rest + restSize) - 1) = restSize;
+                linkBlock(rest);
+
+                if((void*) next < mEnd) {
+                    next->size |= PREV_FREE_BIT;
+                }
+            }
+            else { //the block takes the whole free block
+                newSize = available;
+
+                if((void*) next < mEnd) {
+                    next->size &= ~(size_t) PREV_FREE_BIT;
+                }
+            }
+
+            block->size = newSize | (block->size & PREV_FREE_BIT);
+            return true;
+        }
+
+        /*! \fn     size_t compact(void*& cursor, size_t maxBytesMoved, Relocate relocate)
+         *  \brief  Walks the blocks in address order from the cursor, and slides every block
+         *          in use down to the beginning of the free block in front of it, so the free
+         *          space gathers at the end and merges on the way. It stops when the next block
+         *          to move would exceed the budget, a block bigger than the whole budget is skipped.
+         *  \param  cursor The block where the walk starts, or nullptr to start from the beginning.
+         *          It is set to where the next call goes on, or to nullptr at the end. Deallocating
+         *          the block at the cursor or the one in front of it may merge the cursor away.
+         *  \param  maxBytesMoved The budget of one call, headers included.
+         *  \param  relocate Called as relocate(void* memory, void* newMemory) before a block
+         *          is moved, it returns false if the block may not move.
+         *  \return The number of bytes moved.
+         */
+        template<typename Relocate>
+        size_t compact(void*& cursor, size_t maxBytesMoved, Relocate relocate) {
+            size_t moved = 0;
+            void* block = cursor != nullptr ? cursor : mMemory;
+
+            while(block < mEnd) {
+                Block* current = (Block*) block;
+                size_t size = current->size & SIZE_MASK;
+                if((current->size & BLOCK_FREE_BIT) == 0) {
+                    block += size;
+                    continue;
+                }
+
+                Block* next = (Block*) (block + size); //in use, free neighbours are always merged
+                if((void*) next >= mEnd) {
+                    break;
+                }
+
+                size_t nextSize = next->size & SIZE_MASK;
+                if(nextSize > maxBytesMoved) { //never fits into the budget
+                    block = (void*) next + nextSize;
+                    continue;
+                }
+
+                if(moved + nextSize > maxBytesMoved) { //the next call goes on from here
+                    cursor = block;
+                    return moved;
+                }
+
+                if(!relocate((void*) next + sizeof(size_t), block + sizeof(size_t))) { //pinned
+                    block = (void*) next + nextSize;
+                    continue;
+                }
+
+                unlinkBlock(current);
+                memmove(block, (void*) next, nextSize);
+                current->size = nextSize; //the previous block of a free block is in use
+
+                Block* rest = (Block*) (block + nextSize);
+                size_t restSize = size;
+                Block* after = (Block*) ((void*) rest + restSize);
+                if((void*) after < mEnd && (after->size & BLOCK_FREE_BIT)) {
+                    unlinkBlock(after);
+                    restSize += after->size & SIZE_MASK;
+                    after = (Block*) ((void*) rest + restSize);
+                }
+
+                rest->size = restSize | BLOCK_FREE_BIT;
+                *((size_t*) ((void*) rest + restSize) - 1) = restSize;
+                linkBlock(rest);
+
+                if((void*) after < mEnd) {
+                    after->size |= PREV_FREE_BIT;
+                }
+
+                moved += nextSize;
+                block = (void*) rest;
+            }
+
+            cursor = nullptr;
+            return moved;
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() {
+            size_t size = (uintptr_t) mEnd - (uintptr_t) mMemory;
+
+            mBlocks = (Block*) mMemory;
+            mBlocks->size = size | BLOCK_FREE_BIT;
+            mBlocks->next = nullptr;
+            mBlocks->prev = nullptr;
+            *((size_t*) mEnd - 1) = size;
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if the memory is inside the handled memory.
+         */
+        bool owns(const void* memory) const {
+            return (uintptr_t) memory - (uintptr_t) mMemory < (uintptr_t) mEnd - (uintptr_t) mMemory;
+        }
+
+        /*! \fn     size_t CheckSize(void* memory)
+         *  \brief  Check the size of the specified memory block.
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, header included.
+         */
+        static size_t CheckSize(void* memory) {
+            return *((size_t*) (memory - sizeof(size_t))) & SIZE_MASK;
+        }
+
+        /*! \fn     size_t getLargestFreeBlock() const
+         *  \brief  Walks the list of free blocks.
+         *  \return The biggest size which can be allocated at once, or 0 if there is no free block.
+         */
+        size_t getLargestFreeBlock() const {
+            size_t largest = 0;
+            for(Block* block = mBlocks; block != nullptr; block = block->next) {
+                if((block->size & SIZE_MASK) > largest) {
+                    largest = block->size & SIZE_MASK;
+                }
+            }
+
+            return largest > 0 ? largest - sizeof(size_t) : 0; //the header stays
+        }
+
+#ifdef MFG_DEBUG
+        /*! \fn     void printSizeOfBlocks()
+         *  \brief  Print a list of sizes of free blocks.
+         *          Only for debug purposes.
+         */
+        void printSizeOfBlocks() {
+            for(Block* block = mBlocks; block != nullptr; block = block->next) {
+                std::cout << "blockSize: " << (block->size & SIZE_MASK) << std::endl;
+            }
+        }
+#endif // MFG_DEBUG
+    };
+}//mfg
+
+#endif // MFG_BLOCKPOLICY_HPP
@@ -0,0 +1,127 @@
+/*! \file   BucketizerPolicy.hpp
+ *  \brief  A set of pools by size range.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BUCKETIZERPOLICY_HPP
+#define MFG_BUCKETIZERPOLICY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "PoolPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  BucketizerPolicy
+     *  \brief  A set of same sized block policies. Bucket i serves the sizes
+     *          in (Min + (i - 1) * Step, Min + i * Step], the first one serves
+     *          every size up to Min. The memory is shared equally between the
+     *          buckets, so the owner of a memory is found by its address.
+     *  \tparam Min The block size of the first bucket.
+     *  \tparam Max The block size of the last bucket, bigger sizes are not served.
+     *  \tparam Step The difference between the block sizes of neighbouring buckets.
+     *  \tparam Policy The policy of a bucket, constructed from (memory, size, blockSize).
+     */
+    template<size_t Min, size_t Max, size_t Step, class Policy = PoolPolicy>
+    class BucketizerPolicy {
+        static_assert(Min >= sizeof(void*), "Min has to be at least the size of a pointer.");
+        static_assert(Step > 0 && Max >= Min && (Max - Min) % Step == 0, "Max - Min has to be a multiple of Step.");
+    public:
+        enum : size_t {
+            BUCKET_COUNT = (Max - Min) / Step + 1 //! \var BUCKET_COUNT Number of buckets.
+        };
+    private:
+        void* mMemory; //beginning of the memory
+        size_t mBucketSize; //size of the memory of a bucket
+        std::array<Policy, BUCKET_COUNT> mBuckets; //policies by block size
+
+        template<size_t... I>
+        BucketizerPolicy(void* memory, size_t bucketSize, std::index_sequence<I...>) :
+            mMemory(memory),
+            mBucketSize(bucketSize),
+            mBuckets{{Policy(memory + I * bucketSize, bucketSize, Min + I * Step)...}}
+        {}
+
+        static size_t bucketOf(size_t size) {
+            return size <= Min ? 0 : (size - Min + Step - 1) / Step;
+        }
+    public:
+        /*! \fn     BucketizerPolicy(void* memory, size_t size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         */
+        BucketizerPolicy(void* memory, size_t size) :
+            BucketizerPolicy(memory, size / BUCKET_COUNT / sizeof(void*) * sizeof(void*), std::make_index_sequence<BUCKET_COUNT>())
+        {}
+
+        /*! \fn     void* allocate(size_t size)
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if the size is bigger
+         *          than Max or the bucket is full.
+         */
+        void* allocate(size_t size) {
+            return size <= Max ? mBuckets[bucketOf(size)].allocate(size) : nullptr;
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if the size is bigger
+         *          than Max or the bucket has no aligned block.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            return size <= Max ? mBuckets[bucketOf(size)].allocate(size, alignment) : nullptr;
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the memory with the bucket which owns it.
+         *  \param  memory
+         */
+        void deallocate(void* memory) {
+            mBuckets[((uintptr_t) memory - (uintptr_t) mMemory) / mBucketSize].deallocate(memory);
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory of every bucket.
+         */
+        void clear() {
+            for(Policy& bucket : mBuckets) {
+                bucket.clear();
+            }
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if one of the buckets owns the memory.
+         */
+        bool owns(const void* memory) const {
+            return (uintptr_t) memory - (uintptr_t) mMemory < mBucketSize * BUCKET_COUNT;
+        }
+
+        /*! \fn     Policy& getBucket(size_t size)
+         *  \return The bucket which serves the specified size.
+         */
+        Policy& getBucket(size_t size) { return mBuckets[bucketOf(size)]; }
+    };
+}//mfg
+
+#endif // MFG_BUCKETIZERPOLICY_HPP
@@ -0,0 +1,158 @@
+/*! \file   BuddyAllocator.hpp
+ *  \brief  Allocator of power of two sized blocks, which splits and merges buddies.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_BUDDYALLOCATOR_HPP
+#define MFG_BUDDYALLOCATOR_HPP
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  BuddyAllocator
+     *  \brief  This class allocates blocks of the minimum block size times a power of two,
+     *          a request is rounded up to the next one. A free block of order k is split into
+     *          two buddies of order k - 1 until it fits, and a deallocated block is merged with
+     *          its buddy while the buddy is free, so both take O(log n) steps at most.
+     *          Every order has a list of its free blocks (kept inside the free blocks) and a bitmap
+     *          telling which of its blocks are free. The blocks in use have no header: the size of the
+     *          request is kept in a table with an entry per block of the minimum size.
+     *          The bitmaps and the table are at the beginning of the memory, the blocks are after them.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class BuddyAllocator : public Allocator {
+    private:
+        enum : size_t {
+            MAX_ORDERS = 48 //the biggest block is the minimum block size * 2^47
+        };
+
+        struct FreeBlock { //the beginning of a free block
+            FreeBlock* next;
+            FreeBlock* prev;
+        };
+
+        void* mBlocks; //the first block
+        size_t mMinBlockSize; //size of a block of order 0
+        size_t mMinBlockShift; //log2 of mMinBlockSize
+        size_t mNumOfMinBlocks; //number of blocks of order 0
+        size_t mNumOfOrders; //orders in use
+        uint64_t* mFreeBits[MAX_ORDERS]; //a bit per block of each order, set if it is in the free list
+        size_t* mRequestedSizes; //size of the request of the block in use starting at each block of order 0, otherwise 0
+        FreeBlock* mFreeLists[MAX_ORDERS]; //free blocks of each order
+        size_t mFreeOrders; //bit k is set if the free list of order k is not empty
+        size_t mRequestedSize; //bytes requested by the blocks in use
+        size_t mUsedSize; //bytes of the blocks in use
+
+        size_t orderOf(const size_t& size) const;
+        void pushBlock(void* block, const size_t& order);
+        void popBlock(void* block, const size_t& order);
+        void* takeBlock(const size_t& order, const size_t& size);
+    public:
+        /*! \fn     BuddyAllocator(void* memory, const size_t& size, const size_t& minBlockSize = 4096)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory, the bitmaps and the table included.
+         *  \param  minBlockSize Size of the smallest block, a power of two, at least 16.
+         *          The blocks start on a multiple of it.
+         */
+        BuddyAllocator(void* memory, const size_t& size, const size_t& minBlockSize = 4096);
+
+        BuddyAllocator(const BuddyAllocator& other) = delete;
+        BuddyAllocator& operator=(const BuddyAllocator& other) = delete;
+        BuddyAllocator(BuddyAllocator&& other) = delete;
+        BuddyAllocator& operator=(BuddyAllocator&& other) = delete;
+
+        /*! \fn ~BuddyAllocator()
+         *  \brief Destructor.
+         */
+        ~BuddyAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates a block of the smallest order which holds the size. The smallest non-empty
+         *          free list of that order or above is found with one bit scan, then the block is split.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no free block big enough.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates an aligned block. A block is aligned to its size, if the first block is,
+         *          so the request is rounded up to the alignment.
+         *  \param  size
+         *  \param  alignment Must be a power of two. Bigger alignments than the minimum block size
+         *          can fail if the memory itself is not aligned to them.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block, and merges it with its buddy while that is free.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, the request rounded up to its order.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of the biggest free block.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     double getInternalFragmentation() const
+         *  \return 1 - requested bytes / bytes of the blocks in use, the part of the used
+         *          memory wasted by rounding up to the orders. 0 if no block is in use.
+         */
+        double getInternalFragmentation() const;
+
+        /*! \fn     const size_t& getRequestedSize() const
+         *  \return The bytes requested by the blocks in use.
+         */
+        const size_t& getRequestedSize() const;
+
+        /*! \fn     const size_t& getUsedSize() const
+         *  \return The bytes of the blocks in use.
+         */
+        const size_t& getUsedSize() const;
+
+        /*! \fn     const size_t& getMinBlockSize() const
+         *  \return The size of a block of order 0.
+         */
+        const size_t& getMinBlockSize() const;
+
+#ifdef MFG_DEBUG
+        /*! \fn     void printFreeBlocks()
+         *  \brief  Print the number of free blocks of every order.
+         *          Only for debug purposes.
+         */
+        void printFreeBlocks();
+#endif // MFG_DEBUG
+    };
+}//mfg
+
+#endif // MFG_BUDDYALLOCATOR_HPP
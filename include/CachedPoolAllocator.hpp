@@ -0,0 +1,136 @@
+/*! \file   CachedPoolAllocator.hpp
+ *  \brief  Handles same sized blocks shared between threads.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_CACHEDPOOLALLOCATOR_HPP
+#define MFG_CACHEDPOOLALLOCATOR_HPP
+
+#include <mutex>
+#include <vector>
+
+#include "PoolAllocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    class ThreadMagazines;
+
+    /*! \class  CachedPoolAllocator
+     *  \brief  This class can allocate only the same size of blocks, from any thread.
+     *          Every thread gets a magazine of blocks taken from a shared PoolAllocator.
+     *          Magazines are refilled and flushed in batches under a lock, so most
+     *          calls touch no shared state. The statistics count only the blocks
+     *          handed out, not the ones sitting in magazines.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class CachedPoolAllocator : public Allocator {
+        friend class ThreadMagazines;
+    private:
+        struct Magazine {
+            void** blocks;  //cached blocks, the last one is the hottest
+            size_t count;   //number of cached blocks
+            bool orphan;    //its thread has exited, can be reused by a new thread
+        };
+
+        PoolAllocator mPool; //shared blocks
+        std::mutex mMutex; //guards mPool and mMagazines
+        std::vector<Magazine*> mMagazines; //magazines of all threads
+        size_t mMagazineSize; //capacity of a magazine
+        size_t mBatchSize; //number of blocks moved at once
+        uint64_t mId; //identifies this allocator in the thread caches
+
+        Magazine* getMagazine();
+        Magazine* createMagazine();
+        void refill(Magazine* magazine);
+        void flush(Magazine* magazine, const size_t& count);
+        void releaseMagazine(Magazine* magazine);
+    public:
+        /*! \fn     CachedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const size_t& magazineSize = 64, const bool& zeroMemory = false)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  blockSize Size of blocks. (Must be bigger than the size of a pointer.)
+         *  \param  magazineSize Maximum number of blocks cached by one thread.
+         *  \param  zeroMemory If true, the shared pool fills the memory and the blocks given back to it with zeros.
+         */
+        CachedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const size_t& magazineSize = 64, const bool& zeroMemory = false);
+
+        CachedPoolAllocator(const CachedPoolAllocator& other) = delete;
+        CachedPoolAllocator& operator=(const CachedPoolAllocator& other) = delete;
+        CachedPoolAllocator(CachedPoolAllocator&& other) = delete;
+        CachedPoolAllocator& operator=(CachedPoolAllocator&& other) = delete;
+
+        /*! \fn ~CachedPoolAllocator()
+         *  \brief  Destructor. No thread may use the allocator meanwhile.
+         */
+        ~CachedPoolAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates exactly one block from the magazine of the calling thread.
+         *  \param  size Can not be bigger than size of a block.
+         *  \return The beginning of the memory block, or nullptr if there is no free block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates exactly one aligned block from the magazine of the calling thread.
+         *          Works only if the memory and the size of blocks are both aligned.
+         *  \param  size Can not be bigger than size of a block.
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Puts the block into the magazine of the calling thread.
+         *          The block may come from any thread.
+         *  \param  memory The beginning of the memory.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the blocks.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks and empties
+         *          every magazine. No thread may use the allocator meanwhile.
+         */
+        void clear() final;
+
+        /*! \fn     void flushThreadCache()
+         *  \brief  Gives back every block cached by the calling thread to the shared pool.
+         */
+        void flushThreadCache();
+
+        /*! \fn     const size_t& getBlockSize() const
+         *  \return The size of one block.
+         */
+        const size_t& getBlockSize() const;
+
+        /*! \fn     const size_t& getMagazineSize() const
+         *  \return The maximum number of blocks cached by one thread.
+         */
+        const size_t& getMagazineSize() const;
+    };
+}//mfg
+
+#endif // MFG_CACHEDPOOLALLOCATOR_HPP
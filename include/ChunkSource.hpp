@@ -0,0 +1,91 @@
+/*! \file   ChunkSource.hpp
+ *  \brief  Sources of extra memory for growable allocators.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_CHUNKSOURCE_HPP
+#define MFG_CHUNKSOURCE_HPP
+
+#include <cstddef>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  ChunkSource
+     *  \brief  The parent of all chunk sources. Growable allocators get
+     *          their extra chunks of memory from it when they run out.
+     *          Every chunk is aligned to CHUNK_ALIGNMENT.
+     */
+    class ChunkSource {
+    public:
+        enum : size_t {
+            CHUNK_ALIGNMENT = alignof(std::max_align_t) //minimum alignment of every chunk
+        };
+
+        /*! \fn ~ChunkSource()
+         *  \brief Destructor.
+         */
+        virtual ~ChunkSource();
+
+        /*! \fn     void* acquire(const size_t& size)
+         *  \brief  Pure virtual method for getting a new chunk.
+         *  \param  size The size of the chunk.
+         *  \return The beginning of the chunk, or nullptr if there is no more memory.
+         */
+        virtual void* acquire(const size_t& size) = 0;
+
+        /*! \fn     void release(void* memory, const size_t& size)
+         *  \brief  Pure virtual method for giving back a chunk.
+         *  \param  memory The beginning of the chunk.
+         *  \param  size The size of the chunk, as it was acquired.
+         */
+        virtual void release(void* memory, const size_t& size) = 0;
+    };
+
+    /*! \class  MmapChunkSource
+     *  \brief  Maps every chunk directly from the system with mmap,
+     *          so the chunks are page aligned and zeroed by the kernel.
+     */
+    class MmapChunkSource : public ChunkSource {
+    public:
+        void* acquire(const size_t& size) final;
+        void release(void* memory, const size_t& size) final;
+    };
+
+    /*! \class  AllocatorChunkSource
+     *  \brief  Allocates every chunk from a backing allocator.
+     *          The backing allocator has to be able to deallocate (see Allocator::canDeallocate()).
+     */
+    class AllocatorChunkSource : public ChunkSource {
+    private:
+        Allocator* mAllocator; //the backing allocator
+    public:
+        /*! \fn     AllocatorChunkSource(Allocator* allocator)
+         *  \brief  Constructor.
+         *  \param  allocator The backing allocator. It has to outlive the chunks.
+         */
+        explicit AllocatorChunkSource(Allocator* allocator);
+
+        void* acquire(const size_t& size) final;
+        void release(void* memory, const size_t& size) final;
+    };
+}//mfg
+
+#endif // MFG_CHUNKSOURCE_HPP
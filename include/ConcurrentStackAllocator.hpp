@@ -0,0 +1,151 @@
+/*! \file   ConcurrentStackAllocator.hpp
+ *  \brief  Stack allocator shared by the threads of a job system.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_CONCURRENTSTACKALLOCATOR_HPP
+#define MFG_CONCURRENTSTACKALLOCATOR_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    struct ThreadChunk;
+    struct ThreadCounters;
+
+    /*! \class  ConcurrentStackAllocator
+     *  \brief  A linear allocator which any thread may allocate from at the same time.
+     *          A thread claims a chunk of the memory with one atomic fetch-add on the shared
+     *          marker, then allocates inside it by moving its own pointer, without atomics.
+     *          Requests bigger than a quarter of a chunk claim their own memory.
+     *          getMarker(), deallocateTo(Marker marker) and clear() may be called only at
+     *          quiescent points, like the end of a frame, when no other thread allocates.
+     *          They start a new epoch, and every thread drops its chunk at its next allocation.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class ConcurrentStackAllocator : public Allocator {
+    private:
+        alignas(64) std::atomic<size_t> mClaimed; //offset of the first unclaimed byte, on its own cache line
+        alignas(64) std::atomic<uint64_t> mEpoch; //incremented at every quiescent point, the chunks of older epochs are dropped
+        size_t mChunkSize; //size of a claimed chunk
+        uint64_t mId; //key of the chunks of the threads
+        std::vector<ThreadCounters*> mCounters; //allocations of every thread which has had a chunk, only while statistics are on
+        size_t mFlushedAllocations; //allocations of the threads already given to the checkpoints
+        size_t mFlushedUsed; //bytes of those allocations
+        MarkerCheckpoints mCheckpoints; //allocations below the markers, for the statistics
+        MarkerCheckpoints mUsedCheckpoints; //bytes below the markers, counted as one allocation per byte
+
+        ThreadChunk& getThreadChunk();
+        void* bump(ThreadChunk& chunk, const size_t& size, const size_t& alignment, size_t& used);
+        void onAllocated(ThreadChunk& chunk, const size_t& used);
+        void flushCounters();
+    public:
+        /*! \fn     ConcurrentStackAllocator(void* memory, const size_t& size, const size_t& chunkSize = 64 * 1024)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  chunkSize The size of memory a thread claims at once. The memory of
+         *          a chunk a thread does not fill is lost until the next quiescent point.
+         */
+        ConcurrentStackAllocator(void* memory, const size_t& size, const size_t& chunkSize = 64 * 1024);
+
+        ConcurrentStackAllocator(const ConcurrentStackAllocator& other) = delete;
+        ConcurrentStackAllocator& operator=(const ConcurrentStackAllocator& other) = delete;
+        ConcurrentStackAllocator(ConcurrentStackAllocator&& other) = delete;
+        ConcurrentStackAllocator& operator=(ConcurrentStackAllocator&& other) = delete;
+
+        /*! \fn ~ConcurrentStackAllocator()
+         *  \brief Destructor.
+         */
+        ~ConcurrentStackAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates memory with the specified size from the chunk of the calling thread.
+         *          Can be called from any thread.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size from the chunk of the calling thread.
+         *          The padding in front of it is counted as used memory. Can be called from any thread.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  In this class this method is not working.
+         *          Use void deallocateTo(Marker marker) instead.
+         *  \param  memory
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Copies the memory into a new allocation from the chunk of the calling thread,
+         *          the old one stays until deallocateTo(). Can be called from any thread.
+         *  \param  memory The beginning of the memory, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* reallocate(void* memory, const size_t& size) final;
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False, memory comes back only by deallocateTo(Marker marker) and clear().
+         */
+        bool canDeallocate() const final;
+
+        /*! \fn     void deallocateTo(Marker marker)
+         *  \brief  Deallocate all the items of every thread next to marker.
+         *          No other thread may allocate meanwhile.
+         *  \param  marker Given by getMarker().
+         */
+        void deallocateTo(Marker marker);
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory.
+         *          No other thread may allocate meanwhile.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of the memory which is not claimed by any thread.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     Marker getMarker()
+         *  \brief  Every allocation after it is above the marker, the threads start new chunks.
+         *          No other thread may allocate meanwhile.
+         *  \return The current marker, the end of the claimed memory.
+         */
+        Marker getMarker();
+
+        /*! \fn     const size_t& getChunkSize() const
+         *  \return The size of memory a thread claims at once.
+         */
+        const size_t& getChunkSize() const;
+    };
+}//mfg
+
+#endif // MFG_CONCURRENTSTACKALLOCATOR_HPP
@@ -0,0 +1,154 @@
+/*! \file   DoubleEndedStackAllocator.hpp
+ *  \brief  Stack allocator which allocates from both ends.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_DOUBLEENDEDSTACKALLOCATOR_HPP
+#define MFG_DOUBLEENDEDSTACKALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "StackPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  DoubleEndedStackAllocator
+     *  \brief  This class works like StackAllocator, but it allocates from both ends
+     *          of the memory, for example long lived data at the bottom and transient
+     *          data at the top. The two stacks have independent markers, and the
+     *          memory runs out when they meet. A top marker is the offset of the
+     *          top of the upper stack from the beginning of the memory.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class DoubleEndedStackAllocator : public Allocator {
+    private:
+        size_t mBottom; //end of the lower stack
+        size_t mTop; //beginning of the upper stack
+        MarkerCheckpoints mBottomCheckpoints; //allocations below the bottom markers, for the statistics
+        MarkerCheckpoints mTopCheckpoints; //allocations above the top markers, counted from the end
+    public:
+        /*! \fn     DoubleEndedStackAllocator(void* memory, const size_t& size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         */
+        DoubleEndedStackAllocator(void* memory, const size_t& size);
+
+        DoubleEndedStackAllocator(const DoubleEndedStackAllocator& other) = delete;
+        DoubleEndedStackAllocator& operator=(const DoubleEndedStackAllocator& other) = delete;
+        DoubleEndedStackAllocator(DoubleEndedStackAllocator&& other) = delete;
+        DoubleEndedStackAllocator& operator=(DoubleEndedStackAllocator&& other) = delete;
+
+        /*! \fn ~DoubleEndedStackAllocator()
+         *  \brief Destructor.
+         */
+        ~DoubleEndedStackAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates memory with the specified size at the bottom.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size at the bottom.
+         *          The padding in front of it is counted as used memory.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void* allocateTop(const size_t& size)
+         *  \brief  Allocates memory with the specified size at the top.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocateTop(const size_t& size);
+
+        /*! \fn     void* allocateTop(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size at the top.
+         *          The padding behind it is counted as used memory.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocateTop(const size_t& size, const size_t& alignment);
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  In this class this method is not working.
+         *          Use deallocateToBottom(Marker marker) or deallocateToTop(Marker marker) instead.
+         *  \param  memory
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Copies the memory into a new allocation at the same end of the memory,
+         *          the old one stays until it is rolled back.
+         *  \param  memory The beginning of the memory, or nullptr to allocate a new one at the bottom.
+         *  \param  size The new size.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* reallocate(void* memory, const size_t& size) final;
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False, memory comes back only by the markers and clear().
+         */
+        bool canDeallocate() const final;
+
+        /*! \fn     void deallocateToBottom(Marker marker)
+         *  \brief  Deallocate all the items of the bottom next to marker.
+         *  \param  marker A marker given by getBottomMarker().
+         */
+        void deallocateToBottom(Marker marker);
+
+        /*! \fn     void deallocateToTop(Marker marker)
+         *  \brief  Deallocate all the items of the top next to marker.
+         *  \param  marker A marker given by getTopMarker().
+         */
+        void deallocateToTop(Marker marker);
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory at both ends.
+         */
+        void clear() final;
+
+        /*! \fn     void clearBottom()
+         *  \brief  Deallocates all the previously allocated memory at the bottom.
+         */
+        void clearBottom();
+
+        /*! \fn     void clearTop()
+         *  \brief  Deallocates all the previously allocated memory at the top.
+         */
+        void clearTop();
+
+        /*! \fn     Marker getBottomMarker()
+         *  \return The current marker of the bottom.
+         */
+        Marker getBottomMarker();
+
+        /*! \fn     Marker getTopMarker()
+         *  \return The current marker of the top.
+         */
+        Marker getTopMarker();
+    };
+}//mfg
+
+#endif // MFG_DOUBLEENDEDSTACKALLOCATOR_HPP
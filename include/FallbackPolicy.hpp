@@ -0,0 +1,111 @@
+/*! \file   FallbackPolicy.hpp
+ *  \brief  Composes two policies: try the first, then the second.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_FALLBACKPOLICY_HPP
+#define MFG_FALLBACKPOLICY_HPP
+
+#include <cstddef>
+#include <utility>
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  FallbackPolicy
+     *  \brief  Tries to allocate with the primary policy, and if it fails,
+     *          with the fallback policy. Memory goes back to the policy which owns it.
+     *  \tparam Primary The policy which is tried first.
+     *  \tparam Fallback The policy which is used if the primary one fails.
+     */
+    template<class Primary, class Fallback>
+    class FallbackPolicy {
+    private:
+        Primary mPrimary;   //tried first
+        Fallback mFallback; //used if the primary fails
+    public:
+        /*! \fn     FallbackPolicy(Primary primary, Fallback fallback)
+         *  \brief  Constructor.
+         *  \param  primary The policy which is tried first.
+         *  \param  fallback The policy which is used if the primary one fails.
+         */
+        FallbackPolicy(Primary primary, Fallback fallback) :
+            mPrimary(std::move(primary)),
+            mFallback(std::move(fallback))
+        {}
+
+        /*! \fn     void* allocate(size_t size)
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if neither policy can serve it.
+         */
+        void* allocate(size_t size) {
+            void* memory = mPrimary.allocate(size);
+            return memory != nullptr ? memory : mFallback.allocate(size);
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if neither policy can serve it.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            void* memory = mPrimary.allocate(size, alignment);
+            return memory != nullptr ? memory : mFallback.allocate(size, alignment);
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the memory with the policy which owns it.
+         *  \param  memory
+         */
+        void deallocate(void* memory) {
+            if(mPrimary.owns(memory)) {
+                mPrimary.deallocate(memory);
+            }
+            else {
+                mFallback.deallocate(memory);
+            }
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory of both policies.
+         */
+        void clear() {
+            mPrimary.clear();
+            mFallback.clear();
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if one of the policies owns the memory.
+         */
+        bool owns(const void* memory) const {
+            return mPrimary.owns(memory) || mFallback.owns(memory);
+        }
+
+        /*! \fn     Primary& getPrimary()
+         *  \return The policy which is tried first.
+         */
+        Primary& getPrimary() { return mPrimary; }
+
+        /*! \fn     Fallback& getFallback()
+         *  \return The policy which is used if the primary one fails.
+         */
+        Fallback& getFallback() { return mFallback; }
+    };
+}//mfg
+
+#endif // MFG_FALLBACKPOLICY_HPP
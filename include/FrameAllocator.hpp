@@ -0,0 +1,121 @@
+/*! \file   FrameAllocator.hpp
+ *  \brief  Double buffered stack allocator for per-frame memory.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_FRAMEALLOCATOR_HPP
+#define MFG_FRAMEALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "StackPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  FrameAllocator
+     *  \brief  A double buffered stack allocator for per-frame scratch memory.
+     *          The memory is split into two stacks. Every frame allocates from one
+     *          of them, and beginFrame() swaps them and clears the new current one,
+     *          so the data of the previous frame stays readable for one more frame.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class FrameAllocator : public Allocator {
+    private:
+        StackPolicy mPolicies[2]; //the strategy on the two halves of the memory
+        size_t mCurrent; //index of the stack of the current frame
+        MarkerCheckpoints mCheckpoints[2]; //allocations of the two frames, for the statistics
+    public:
+        /*! \fn     FrameAllocator(void* memory, const size_t& size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory, half of it is usable by one frame.
+         */
+        FrameAllocator(void* memory, const size_t& size);
+
+        FrameAllocator(const FrameAllocator& other) = delete;
+        FrameAllocator& operator=(const FrameAllocator& other) = delete;
+        FrameAllocator(FrameAllocator&& other) = delete;
+        FrameAllocator& operator=(FrameAllocator&& other) = delete;
+
+        /*! \fn ~FrameAllocator()
+         *  \brief Destructor.
+         */
+        ~FrameAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates memory with the specified size for the current frame.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size for the current frame.
+         *          The padding in front of it is counted as used memory.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  In this class this method is not working.
+         *          The memory comes back two frames later, or by deallocateTo(Marker marker).
+         *  \param  memory
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Resizes the last allocation of the current frame in place by moving the marker.
+         *          Any other memory is copied into a new allocation, the old one stays until it is released.
+         *  \param  memory The beginning of the memory, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* reallocate(void* memory, const size_t& size) final;
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False, memory comes back only by beginFrame(), deallocateTo(Marker marker) and clear().
+         */
+        bool canDeallocate() const final;
+
+        /*! \fn     void deallocateTo(Marker marker)
+         *  \brief  Deallocate all the items of the current frame next to marker.
+         *  \param  marker
+         */
+        void deallocateTo(Marker marker);
+
+        /*! \fn     void beginFrame()
+         *  \brief  Starts a new frame. The memory of the previous frame stays untouched,
+         *          the memory of the frame before it is deallocated.
+         */
+        void beginFrame();
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory of both frames.
+         */
+        void clear() final;
+
+        /*! \fn     Marker getMarker()
+         *  \return The current marker of the current frame.
+         */
+        Marker getMarker();
+    };
+}//mfg
+
+#endif // MFG_FRAMEALLOCATOR_HPP
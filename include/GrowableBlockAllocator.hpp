@@ -0,0 +1,129 @@
+/*! \file   GrowableBlockAllocator.hpp
+ *  \brief  Block allocator which grows with new chunks.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_GROWABLEBLOCKALLOCATOR_HPP
+#define MFG_GROWABLEBLOCKALLOCATOR_HPP
+
+#include <vector>
+
+#include "Allocator.hpp"
+#include "BlockPolicy.hpp"
+#include "ChunkSource.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  GrowableBlockAllocator
+     *  \brief  This class works like BlockAllocator, but when no chunk has a fitting
+     *          block, it continues with a new chunk taken from a ChunkSource.
+     *          Every chunk is a separate BlockPolicy. Allocation tries the chunk of
+     *          the previous allocation first, deallocation finds the chunk by address.
+     *          Extra chunks are kept for reuse until clear(true).
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class GrowableBlockAllocator : public Allocator {
+    private:
+        struct Chunk {
+            BlockPolicy policy; //the strategy on the chunk
+            void* memory;       //beginning of the chunk
+            size_t size;        //size of the chunk
+        };
+
+        ChunkSource* mSource; //gives the extra chunks
+        size_t mChunkSize; //size of the extra chunks
+        std::vector<Chunk> mChunks; //sorted by address
+        size_t mLast; //index of the chunk of the previous allocation
+
+        void* allocateSlow(const size_t& size, const size_t& alignment);
+        size_t findChunk(const void* memory) const;
+        void releaseExtraChunks();
+    public:
+        /*! \fn     GrowableBlockAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the first chunk.
+         *  \param  size The size of the first chunk.
+         *  \param  source Gives the extra chunks. It has to outlive the allocator.
+         *  \param  chunkSize The size of the extra chunks. A bigger chunk is taken
+         *          if an allocation does not fit into it.
+         */
+        GrowableBlockAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize);
+
+        GrowableBlockAllocator(const GrowableBlockAllocator& other) = delete;
+        GrowableBlockAllocator& operator=(const GrowableBlockAllocator& other) = delete;
+        GrowableBlockAllocator(GrowableBlockAllocator&& other) = delete;
+        GrowableBlockAllocator& operator=(GrowableBlockAllocator&& other) = delete;
+
+        /*! \fn ~GrowableBlockAllocator()
+         *  \brief  Destructor. Gives back every extra chunk.
+         */
+        ~GrowableBlockAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates the best fitting block of a chunk with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if the source has no more chunks.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates the best fitting aligned block of a chunk with the specified size.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if the source has no more chunks.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block, and merges it
+         *          with its free neighbours in the same chunk.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block without the header.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks, and keeps the extra chunks.
+         */
+        void clear() final;
+
+        /*! \fn     void clear(const bool& releaseChunks)
+         *  \brief  Deallocates all the previously allocated blocks.
+         *  \param  releaseChunks If true, the extra chunks are given back to the source.
+         */
+        void clear(const bool& releaseChunks);
+
+        /*! \fn     size_t getNumberOfChunks() const
+         *  \return The number of chunks, the first one included.
+         */
+        size_t getNumberOfChunks() const;
+
+        /*! \fn     size_t getCapacity() const
+         *  \return The size of all the chunks.
+         */
+        size_t getCapacity() const;
+    };
+}//mfg
+
+#endif // MFG_GROWABLEBLOCKALLOCATOR_HPP
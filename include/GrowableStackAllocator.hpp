@@ -0,0 +1,153 @@
+/*! \file   GrowableStackAllocator.hpp
+ *  \brief  Stack allocator which grows with new chunks.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_GROWABLESTACKALLOCATOR_HPP
+#define MFG_GROWABLESTACKALLOCATOR_HPP
+
+#include <vector>
+
+#include "Allocator.hpp"
+#include "ChunkSource.hpp"
+#include "StackPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  GrowableStackAllocator
+     *  \brief  This class works like StackAllocator, but when the current chunk
+     *          runs out, it continues in a new chunk taken from a ChunkSource.
+     *          Markers are offsets counted through all the chunks, so
+     *          deallocateTo(Marker marker) can step back over chunk borders.
+     *          The unused end of a left chunk is counted as used memory.
+     *          Chunks above the top are kept for reuse until clear(true).
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class GrowableStackAllocator : public Allocator {
+    private:
+        struct Chunk {
+            void* memory;   //beginning of the chunk
+            size_t size;    //size of the chunk
+            Marker base;    //marker of the beginning of the chunk
+        };
+
+        StackPolicy mPolicy; //the strategy on the current chunk
+        ChunkSource* mSource; //gives the extra chunks
+        size_t mChunkSize; //size of the extra chunks
+        std::vector<Chunk> mChunks; //the first one is the memory given to the constructor
+        size_t mCurrent; //index of the current chunk
+        MarkerCheckpoints mCheckpoints; //allocations below the markers, for the statistics
+
+        void* grow(const size_t& size, const size_t& alignment);
+        void releaseFrom(const size_t& first);
+        Marker getTop() const;
+    public:
+        /*! \fn     GrowableStackAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the first chunk.
+         *  \param  size The size of the first chunk.
+         *  \param  source Gives the extra chunks. It has to outlive the allocator.
+         *  \param  chunkSize The size of the extra chunks. A bigger chunk is taken
+         *          if an allocation does not fit into it.
+         */
+        GrowableStackAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize);
+
+        GrowableStackAllocator(const GrowableStackAllocator& other) = delete;
+        GrowableStackAllocator& operator=(const GrowableStackAllocator& other) = delete;
+        GrowableStackAllocator(GrowableStackAllocator&& other) = delete;
+        GrowableStackAllocator& operator=(GrowableStackAllocator&& other) = delete;
+
+        /*! \fn ~GrowableStackAllocator()
+         *  \brief  Destructor. Gives back every extra chunk.
+         */
+        ~GrowableStackAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates memory with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if the source has no more chunks.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size.
+         *          The padding in front of it is counted as used memory.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if the source has no more chunks.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  In this class this method is not working.
+         *          Use void deallocateTo(Marker marker) instead.
+         *  \param  memory
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Resizes the last allocation in place by moving the marker, if it still fits in its chunk.
+         *          Any other memory is copied into a new allocation, the old one stays until deallocateTo().
+         *  \param  memory The beginning of the memory, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* reallocate(void* memory, const size_t& size) final;
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False, memory comes back only by deallocateTo(Marker marker) and clear().
+         */
+        bool canDeallocate() const final;
+
+        /*! \fn     void deallocateTo(Marker marker)
+         *  \brief  Deallocate all the items next to marker. The statistics count the released
+         *          allocations exactly if the marker has been given by getMarker() while they were on.
+         *  \param  marker
+         */
+        void deallocateTo(Marker marker);
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory, and keeps the extra chunks.
+         */
+        void clear() final;
+
+        /*! \fn     void clear(const bool& releaseChunks)
+         *  \brief  Deallocates all the previously allocated memory.
+         *  \param  releaseChunks If true, the extra chunks are given back to the source.
+         */
+        void clear(const bool& releaseChunks);
+
+        /*! \fn     Marker getMarker()
+         *  \return The current marker.
+         */
+        Marker getMarker();
+
+        /*! \fn     size_t getNumberOfChunks() const
+         *  \return The number of chunks, the first one included.
+         */
+        size_t getNumberOfChunks() const;
+
+        /*! \fn     size_t getCapacity() const
+         *  \return The size of all the chunks.
+         */
+        size_t getCapacity() const;
+    };
+}//mfg
+
+#endif // MFG_GROWABLESTACKALLOCATOR_HPP
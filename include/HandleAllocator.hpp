@@ -0,0 +1,165 @@
+/*! \file   HandleAllocator.hpp
+ *  \brief  Handles relocatable blocks behind stable handles.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_HANDLEALLOCATOR_HPP
+#define MFG_HANDLEALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "BlockPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    typedef uint64_t Handle; //! \typedef    uint64_t Handle
+
+    /*! \class  HandleAllocator
+     *  \brief  This class can allocate different size of blocks which can be moved.
+     *          The blocks of handles may be slid together by defragment() between
+     *          frames, so the free space gathers into one big block. The user keeps
+     *          the handle, and resolves it to the current address when it is used.
+     *          A handle is an index into a table at the front of the memory with
+     *          a generation, so a handle of a deallocated block never resolves.
+     *          The blocks of allocate() are pinned, they never move.
+     *          It is built on BlockPolicy, every block starts with the index of its handle.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class HandleAllocator : public Allocator {
+    public:
+        enum : Handle {
+            NULL_HANDLE = 0 //never given out
+        };
+    private:
+        struct Entry { //a slot of the handle table
+            void* memory; //the block, or nullptr if the slot is free
+            uint32_t generation; //increased when the slot is freed
+            uint32_t nextFree; //next free slot
+        };
+
+        enum : size_t {
+            PINNED_BIT = (size_t) 1 << (sizeof(size_t) * 8 - 1), //the tag of a pinned block holds the offset of the user memory
+            NO_SLOT = 0xFFFFFFFF
+        };
+
+        BlockPolicy mPolicy; //the strategy
+        Entry* mHandles; //the handle table
+        size_t mNumOfHandles; //size of the handle table
+        uint32_t mFreeHandle; //first free slot
+        size_t mFreeSize; //bytes in the free blocks, headers included
+        void* mCursor; //block where the next defragment() goes on, or nullptr
+
+        void* allocateBlock(const size_t& size, const size_t& alignment, const size_t& tag);
+        void deallocateBlock(void* block);
+    public:
+        /*! \fn     HandleAllocator(void* memory, const size_t& size, const size_t& maxHandles)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory, the handle table included.
+         *  \param  maxHandles The number of handles in use at once at most.
+         */
+        HandleAllocator(void* memory, const size_t& size, const size_t& maxHandles);
+
+        HandleAllocator(const HandleAllocator& other) = delete;
+        HandleAllocator& operator=(const HandleAllocator& other) = delete;
+        HandleAllocator(HandleAllocator&& other) = delete;
+        HandleAllocator& operator=(HandleAllocator&& other) = delete;
+
+        /*! \fn ~HandleAllocator()
+         *  \brief Destructor.
+         */
+        ~HandleAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates one pinned block of memory with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates one aligned pinned block of memory with the specified size.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block. The handle of a relocatable
+         *          block is deallocated as well.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of a pinned block, or of the block of a handle.
+         *  \return The size of the block without its header.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks, every handle becomes invalid.
+         */
+        void clear() final;
+
+        /*! \fn     Handle allocateHandle(const size_t& size)
+         *  \brief  Allocates one relocatable block with the specified size.
+         *          It is aligned to the size of a pointer.
+         *  \param  size
+         *  \return The handle of the block, or NULL_HANDLE if there is no fitting
+         *          block or every handle is in use.
+         */
+        Handle allocateHandle(const size_t& size);
+
+        /*! \fn     void deallocateHandle(Handle handle)
+         *  \brief  Deallocates the block of the handle.
+         *  \param  handle
+         */
+        void deallocateHandle(Handle handle);
+
+        /*! \fn     void* resolve(Handle handle) const
+         *  \brief  The address is valid until the next defragment().
+         *  \param  handle
+         *  \return The current beginning of the block, or nullptr if the handle has been deallocated.
+         */
+        void* resolve(Handle handle) const;
+
+        /*! \fn     size_t defragment(const size_t& maxBytesMoved)
+         *  \brief  Slides the blocks of handles down into the free blocks in front of them.
+         *          Every call goes on from where the previous one has stopped, and starts
+         *          again from the beginning after it has reached the end of the memory.
+         *  \param  maxBytesMoved The most bytes copied by this call. A block bigger than it is not moved.
+         *  \return The number of bytes moved.
+         */
+        size_t defragment(const size_t& maxBytesMoved);
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The biggest size which can be allocated at once. It walks the list of free blocks.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     double getFragmentation()
+         *  \return 1 - largest free block / free memory, 0 if the free memory is in one block.
+         *          It walks the list of free blocks.
+         */
+        double getFragmentation();
+    };
+}//mfg
+
+#endif // MFG_HANDLEALLOCATOR_HPP
@@ -0,0 +1,162 @@
+/*! \file   HeapProfiler.hpp
+ *  \brief  Samples allocations with their call stacks.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_HEAPPROFILER_HPP
+#define MFG_HEAPPROFILER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+//! \namespace  mfg
+namespace mfg {
+    class Allocator;
+
+    /*! \class  HeapProfiler
+     *  \brief  Samples about one allocation per sample rate bytes, and keeps the call
+     *          stacks of the sampled blocks until they are deallocated. The distance
+     *          between two samples is exponentially distributed (a Poisson process over
+     *          the allocated bytes), so every byte has the same chance, and a sample of
+     *          size s stands for s / (1 - exp(-s / rate)) bytes.
+     *          The live samples can be written as a folded stack file (flame graphs) or
+     *          as a heap profile which pprof reads.
+     *          Allocators switch it on with Allocator::startProfile(), until then the
+     *          hooks cost one branch.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class HeapProfiler {
+    public:
+        enum : size_t {
+            MAX_FRAMES = 32, //deepest call stack kept
+            DEFAULT_SAMPLE_RATE = 512 * 1024
+        };
+    private:
+        enum : size_t {
+            FILTER_SIZE = 1 << 16 //counters of the filter of sampled addresses
+        };
+
+        struct Sample {
+            const Allocator* allocator; //the allocator of the block
+            size_t size; //requested size
+            size_t weight; //estimated bytes it stands for
+            uint32_t depth; //number of frames
+            void* frames[MAX_FRAMES]; //return addresses, the innermost first
+        };
+
+        size_t mSampleRate; //mean bytes between samples
+        size_t mMaxSamples; //live samples kept at most
+        uint64_t mId; //identifies this profiler in the thread states
+        mutable std::mutex mMutex; //guards mSamples
+        std::unordered_map<uintptr_t, Sample> mSamples; //live samples by address
+        std::atomic<uint16_t>* mFilter; //live samples by hash of address, deallocate locks only if its counter is not 0
+        std::atomic<uint64_t> mNumOfDropped; //samples lost because the table was full
+
+        static size_t FilterIndex(uintptr_t address);
+        void addSample(const Allocator* allocator, void* memory, const size_t& size);
+    public:
+        /*! \fn     HeapProfiler(const size_t& sampleRate = DEFAULT_SAMPLE_RATE, const size_t& maxSamples = 16384)
+         *  \brief  Constructor.
+         *  \param  sampleRate Mean number of allocated bytes between two samples, 1 samples everything.
+         *  \param  maxSamples The most live samples kept, further ones are dropped.
+         */
+        explicit HeapProfiler(const size_t& sampleRate = DEFAULT_SAMPLE_RATE, const size_t& maxSamples = 16384);
+
+        HeapProfiler(const HeapProfiler& other) = delete;
+        HeapProfiler& operator=(const HeapProfiler& other) = delete;
+        HeapProfiler(HeapProfiler&& other) = delete;
+        HeapProfiler& operator=(HeapProfiler&& other) = delete;
+
+        /*! \fn     ~HeapProfiler()
+         *  \brief  Destructor. The allocators have to stop profiling before.
+         */
+        ~HeapProfiler();
+
+        /*! \fn     void recordAllocate(const Allocator* allocator, void* memory, const size_t& size)
+         *  \brief  Counts the bytes of an allocation, and samples it when the distance runs out.
+         *  \param  allocator
+         *  \param  memory The beginning of the block.
+         *  \param  size The requested size.
+         */
+        void recordAllocate(const Allocator* allocator, void* memory, const size_t& size);
+
+        /*! \fn     void recordDeallocate(void* memory)
+         *  \brief  Forgets the sample of the block if it has one.
+         *  \param  memory The beginning of the block.
+         */
+        void recordDeallocate(void* memory);
+
+        /*! \fn     void recordRelease(const Allocator* allocator, const void* begin, const void* end)
+         *  \brief  Forgets the samples of the allocator in a range deallocated at once,
+         *          like the top of a stack rolled back to a marker.
+         *  \param  allocator
+         *  \param  begin The beginning of the range.
+         *  \param  end The end of the range.
+         */
+        void recordRelease(const Allocator* allocator, const void* begin, const void* end);
+
+        /*! \fn     void recordClear(const Allocator* allocator)
+         *  \brief  Forgets every sample of the allocator.
+         *  \param  allocator
+         */
+        void recordClear(const Allocator* allocator);
+
+        /*! \fn     bool writeFolded(const char* path) const
+         *  \brief  Writes the live samples with one "outer;...;inner bytes" line per call stack,
+         *          as flamegraph.pl and speedscope read it. The bytes are estimated.
+         *  \param  path It is overwritten.
+         *  \return False if the file could not be written.
+         */
+        bool writeFolded(const char* path) const;
+
+        /*! \fn     bool writePprof(const char* path) const
+         *  \brief  Writes the live samples in the legacy heap profile text format of gperftools,
+         *          followed by the mapped libraries, so "pprof binary path" can symbolize it.
+         *          pprof estimates the bytes from the sample rate in the header.
+         *  \param  path It is overwritten.
+         *  \return False if the file could not be written.
+         */
+        bool writePprof(const char* path) const;
+
+        /*! \fn     size_t getNumberOfSamples() const
+         *  \return The number of live samples.
+         */
+        size_t getNumberOfSamples() const;
+
+        /*! \fn     size_t getEstimatedLiveSize() const
+         *  \return The estimated bytes in use by the profiled allocators.
+         */
+        size_t getEstimatedLiveSize() const;
+
+        /*! \fn     uint64_t getNumberOfDropped() const
+         *  \return The number of samples lost because maxSamples had been reached.
+         */
+        uint64_t getNumberOfDropped() const;
+
+        /*! \fn     const size_t& getSampleRate() const
+         *  \return Mean number of allocated bytes between two samples.
+         */
+        const size_t& getSampleRate() const;
+    };
+}//mfg
+
+#endif // MFG_HEAPPROFILER_HPP
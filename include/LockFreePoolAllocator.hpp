@@ -0,0 +1,109 @@
+/*! \file   LockFreePoolAllocator.hpp
+ *  \brief  Handles same sized blocks from many threads without locks.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_LOCKFREEPOOLALLOCATOR_HPP
+#define MFG_LOCKFREEPOOLALLOCATOR_HPP
+
+#include <atomic>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  LockFreePoolAllocator
+     *  \brief  This class can allocate only the same size of blocks, from any thread.
+     *          The free list is a Treiber stack. Its head packs the index of the first
+     *          free block with a version tag, which changes on every update, so a
+     *          compare-and-swap never succeeds on a recycled head (ABA).
+     *          Blocks which have never been used are handed out with an atomic
+     *          bump index, so construction and clear() are constant time.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class LockFreePoolAllocator : public Allocator {
+    private:
+        std::atomic<uint64_t> mHead; //version tag in the upper, block index in the lower half
+        std::atomic<size_t> mNext; //index of the first block which has never been used
+        size_t mBlockSize; //size of blocks
+        size_t mNumberOfBlocks; //number of blocks
+        bool mZeroMemory; //fill the memory and the deallocated blocks with zeros
+    public:
+        /*! \fn     LockFreePoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  blockSize Size of blocks. (Must be bigger than the size of a pointer.)
+         *  \param  zeroMemory If true, the memory is filled with zeros on construction and on
+         *          clear(), and every deallocated block is filled with zeros as well.
+         */
+        LockFreePoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false);
+
+        LockFreePoolAllocator(const LockFreePoolAllocator& other) = delete;
+        LockFreePoolAllocator& operator=(const LockFreePoolAllocator& other) = delete;
+        LockFreePoolAllocator(LockFreePoolAllocator&& other) = delete;
+        LockFreePoolAllocator& operator=(LockFreePoolAllocator&& other) = delete;
+
+        /*! \fn ~LockFreePoolAllocator()
+         *  \brief Destructor.
+         */
+        ~LockFreePoolAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates exactly one block. Can be called from any thread.
+         *  \param  size Can not be bigger than size of a block.
+         *  \return The beginning of the memory block, or nullptr if there is no free block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates exactly one aligned block. Can be called from any thread.
+         *          Works only if the memory and the size of blocks are both aligned.
+         *  \param  size Can not be bigger than size of a block.
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory. Can be called from any thread.
+         *  \param  memory The beginning of the memory.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the blocks.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         *          Quiescent only: no thread may allocate or deallocate meanwhile.
+         */
+        void clear() final;
+
+        /*! \fn     const size_t& getBlockSize() const
+         *  \return The size of one block.
+         */
+        const size_t& getBlockSize() const;
+    };
+}//mfg
+
+#endif // MFG_LOCKFREEPOOLALLOCATOR_HPP
@@ -0,0 +1,65 @@
+/*! \file   MemoryResource.hpp
+ *  \brief  Bridge from mfg allocators to std::pmr.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_MEMORYRESOURCE_HPP
+#define MFG_MEMORYRESOURCE_HPP
+
+#include <memory_resource>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  MemoryResource
+     *  \brief  A std::pmr::memory_resource which allocates with an mfg allocator,
+     *          so pmr containers can use it. If the allocator can not free
+     *          individual blocks (see Allocator::canDeallocate()), deallocation
+     *          does nothing, and the memory comes back only when the allocator
+     *          is cleared. Throws std::bad_alloc if the allocator runs out of memory.
+     */
+    class MemoryResource : public std::pmr::memory_resource {
+    private:
+        Allocator* mAllocator; //the allocator which serves the requests
+        bool mMonotonic; //deallocation does nothing
+    public:
+        /*! \fn     MemoryResource(Allocator* allocator)
+         *  \brief  Constructor.
+         *  \param  allocator The allocator which serves the requests. It has to outlive the resource.
+         */
+        explicit MemoryResource(Allocator* allocator);
+
+        /*! \fn     Allocator* getAllocator() const
+         *  \return The allocator which serves the requests.
+         */
+        Allocator* getAllocator() const;
+
+        /*! \fn     bool isMonotonic() const
+         *  \return True if deallocation does nothing, because the allocator can not free individual blocks.
+         */
+        bool isMonotonic() const;
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+}//mfg
+
+#endif // MFG_MEMORYRESOURCE_HPP
@@ -0,0 +1,154 @@
+/*! \file   NumaArena.hpp
+ *  \brief  Places the memory of allocators on the NUMA node of their threads.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_NUMAARENA_HPP
+#define MFG_NUMAARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ChunkSource.hpp"
+#include "PoolAllocator.hpp"
+#include "StackAllocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  NumaChunkSource
+     *  \brief  Maps every chunk with mmap, and places its pages on one NUMA node.
+     *          It binds the chunk with mbind, and if the kernel refuses it, a thread
+     *          pinned to the node touches every page first. On a machine with one
+     *          node it is the same as MmapChunkSource. The nodes are counted from 0 to
+     *          GetNumberOfNodes() - 1, even if the numbering of the system has holes.
+     */
+    class NumaChunkSource : public ChunkSource {
+    private:
+        size_t mNode; //node of the chunks
+    public:
+        /*! \fn     NumaChunkSource(const size_t& node)
+         *  \brief  Constructor.
+         *  \param  node Less than GetNumberOfNodes().
+         */
+        explicit NumaChunkSource(const size_t& node);
+
+        void* acquire(const size_t& size) final;
+        void release(void* memory, const size_t& size) final;
+
+        /*! \fn     const size_t& getNode() const
+         *  \return The node of the chunks.
+         */
+        const size_t& getNode() const;
+
+        /*! \fn     size_t GetNumberOfNodes()
+         *  \return The number of NUMA nodes, 1 if the topology can not be read.
+         */
+        static size_t GetNumberOfNodes();
+
+        /*! \fn     size_t GetCurrentNode()
+         *  \return The node of the CPU which runs the calling thread, 0 if it is unknown.
+         */
+        static size_t GetCurrentNode();
+
+        /*! \fn     bool BindThread(const size_t& node)
+         *  \brief  Lets the calling thread run only on the CPUs of the node.
+         *  \param  node
+         *  \return False if the affinity could not be set.
+         */
+        static bool BindThread(const size_t& node);
+    };
+
+    /*! \class  NumaArena
+     *  \brief  Gives every thread its own PoolAllocator and StackAllocator, in one chunk
+     *          from the NumaChunkSource of the node which runs the thread when it asks
+     *          first. Threads should be pinned (see NumaChunkSource::BindThread()) before,
+     *          otherwise the scheduler may move them away from their memory.
+     *          A thread keeps its allocators until the arena is destroyed.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class NumaArena {
+    private:
+        struct ThreadArena { //the allocators of one thread
+            void* memory; //the chunk
+            size_t size; //size of the chunk
+            size_t node; //node of the chunk
+            PoolAllocator* pool;
+            StackAllocator* stack;
+        };
+
+        std::vector<NumaChunkSource*> mSources; //one per node
+        size_t mPoolSize; //size of the memory of a pool
+        size_t mBlockSize; //size of blocks of the pools
+        size_t mStackSize; //size of the memory of a stack
+        uint64_t mId; //identifies this arena in the thread entries
+        std::mutex mMutex; //guards mArenas
+        std::vector<ThreadArena*> mArenas; //arenas of all threads
+
+        ThreadArena* getThreadArena();
+        ThreadArena* createThreadArena();
+    public:
+        /*! \fn     NumaArena(const size_t& poolSize, const size_t& blockSize, const size_t& stackSize)
+         *  \brief  Constructor.
+         *  \param  poolSize The size of the memory of the pool of a thread.
+         *  \param  blockSize The size of blocks of the pools.
+         *  \param  stackSize The size of the memory of the stack of a thread.
+         */
+        NumaArena(const size_t& poolSize, const size_t& blockSize, const size_t& stackSize);
+
+        NumaArena(const NumaArena& other) = delete;
+        NumaArena& operator=(const NumaArena& other) = delete;
+        NumaArena(NumaArena&& other) = delete;
+        NumaArena& operator=(NumaArena&& other) = delete;
+
+        /*! \fn     ~NumaArena()
+         *  \brief  Destructor. Gives back the memory of every thread, no thread may use it meanwhile.
+         */
+        ~NumaArena();
+
+        /*! \fn     PoolAllocator* getPool()
+         *  \return The pool of the calling thread on its node, or nullptr if there is no more memory.
+         */
+        PoolAllocator* getPool();
+
+        /*! \fn     StackAllocator* getStack()
+         *  \return The stack of the calling thread on its node, or nullptr if there is no more memory.
+         */
+        StackAllocator* getStack();
+
+        /*! \fn     size_t getNode()
+         *  \return The node of the memory of the calling thread.
+         */
+        size_t getNode();
+
+        /*! \fn     size_t getNumberOfNodes() const
+         *  \return The number of NUMA nodes.
+         */
+        size_t getNumberOfNodes() const;
+
+        /*! \fn     size_t getNumberOfThreads()
+         *  \return The number of threads which have got their allocators.
+         */
+        size_t getNumberOfThreads();
+    };
+}//mfg
+
+#endif // MFG_NUMAARENA_HPP
@@ -0,0 +1,268 @@
+/*! \file   ObjectPool.hpp
+ *  \brief  Typed pool of densely packed objects behind generational handles.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_OBJECTPOOL_HPP
+#define MFG_OBJECTPOOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "mfg.hpp"
+#include "PoolPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  ObjectPool
+     *  \brief  A slot map. The objects are packed at the beginning of an array, so they
+     *          can be iterated linearly, and removing one moves the last object into
+     *          its place. The user keeps a handle, which is the index of a slot with a
+     *          generation, and the slot tells where the object is now. The generation
+     *          of a slot is increased when its object is removed, so a stale handle
+     *          never reaches the object which has got the slot again.
+     *          The slots are blocks of a PoolPolicy, the generation is stored next to
+     *          the word the free list uses.
+     *          The memory is divided into the slots, the back references of the
+     *          objects to their slots, and the objects.
+     *          Copy and move constructors and assignments are unavailable.
+     *  \tparam T The type of the objects. It has to be move constructible.
+     *  \tparam H The type of the handles, uint32_t or uint64_t.
+     *  \tparam INDEX_BITS The bits of the index of the slot in a handle, the rest is the generation.
+     */
+    template<class T, typename H = uint64_t, size_t INDEX_BITS = sizeof(H) * 4>
+    class ObjectPool {
+        static_assert(INDEX_BITS > 0 && INDEX_BITS < sizeof(H) * 8, "a handle needs bits for the generation");
+        static_assert(INDEX_BITS <= 32 && sizeof(H) * 8 - INDEX_BITS <= 32, "the index and the generation of a slot are 32 bits");
+    public:
+        typedef H Handle; //! \typedef    H Handle
+
+        enum : H {
+            NULL_HANDLE = 0 //never given out
+        };
+    private:
+        enum : uint64_t {
+            INDEX_MASK = ((uint64_t) 1 << INDEX_BITS) - 1,
+            GENERATION_MASK = (~(uint64_t) 0 >> (64 - sizeof(H) * 8)) >> INDEX_BITS
+        };
+
+        struct Slot {
+            void* link; //written by the PoolPolicy while the slot is free
+            uint32_t generation; //increased when the object is removed
+            uint32_t index; //index of the object
+        };
+
+        Slot* mSlots; //the slots
+        uint32_t* mSlotOf; //slot of each object
+        T* mObjects; //the packed objects
+        size_t mCapacity; //the most objects at once
+        size_t mNumOfObjects; //the objects in use
+        PoolPolicy mPolicy; //gives out the slots
+
+        static size_t Layout(const size_t& capacity, size_t* slotOfOffset, size_t* objectsOffset) {
+            *slotOfOffset = capacity * sizeof(Slot);
+            *objectsOffset = (*slotOfOffset + capacity * sizeof(uint32_t) + alignof(T) - 1) & ~(alignof(T) - 1);
+            return *objectsOffset + capacity * sizeof(T);
+        }
+
+        static size_t CapacityFor(const size_t& size) {
+            size_t capacity = size / (sizeof(Slot) + sizeof(uint32_t) + sizeof(T));
+            size_t slotOfOffset, objectsOffset;
+            while(capacity > 0 && Layout(capacity, &slotOfOffset, &objectsOffset) > size) { //the padding of the objects
+                capacity--;
+            }
+
+            return capacity < INDEX_MASK ? capacity : (size_t) INDEX_MASK;
+        }
+
+        size_t slotIndex(const Slot* slot) const { return slot - mSlots; }
+
+        Slot* resolve(Handle handle) const {
+            size_t index = (size_t) (handle & INDEX_MASK);
+            if(index >= mCapacity) {
+                return nullptr;
+            }
+
+            uint32_t generation = (uint32_t) ((uint64_t) handle >> INDEX_BITS);
+            Slot* slot = mSlots + index;
+            if(generation == 0 || slot->generation != generation) { //the generation of a free slot is newer than its handles
+                return nullptr;
+            }
+
+            return slot;
+        }
+    public:
+        /*! \fn     ObjectPool(void* memory, const size_t& size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory. It has to be aligned to alignof(T) and to the size of a pointer.
+         *  \param  size The size of the memory, see RequiredSize().
+         */
+        ObjectPool(void* memory, const size_t& size) :
+            mSlots((Slot*) memory),
+            mCapacity(CapacityFor(size)),
+            mNumOfObjects(0),
+            mPolicy(memory, mCapacity * sizeof(Slot), sizeof(Slot))
+        {
+            ASSERT(mCapacity > 0);
+            ASSERT(((uintptr_t) memory & (alignof(T) - 1)) == 0);
+
+            memset(mSlots, 0, mCapacity * sizeof(Slot)); //the generations, they are never zeroed again
+
+            size_t slotOfOffset, objectsOffset;
+            Layout(mCapacity, &slotOfOffset, &objectsOffset);
+            mSlotOf = (uint32_t*) (memory + slotOfOffset);
+            mObjects = (T*) (memory + objectsOffset);
+        }
+
+        ObjectPool(const ObjectPool& other) = delete;
+        ObjectPool& operator=(const ObjectPool& other) = delete;
+        ObjectPool(ObjectPool&& other) = delete;
+        ObjectPool& operator=(ObjectPool&& other) = delete;
+
+        /*! \fn     ~ObjectPool()
+         *  \brief  Destructor. Destroys the objects in use.
+         */
+        ~ObjectPool() { clear(); }
+
+        /*! \fn     Handle emplace(Args&&... args)
+         *  \brief  Constructs an object at the end of the packed objects.
+         *  \param  args The arguments of the constructor of T.
+         *  \return The handle of the object, or NULL_HANDLE if the pool is full.
+         */
+        template<class... Args>
+        Handle emplace(Args&&... args) {
+            if(mNumOfObjects == mCapacity) { //every slot is in use
+                ASSERT(false);
+                return NULL_HANDLE;
+            }
+
+            new (mObjects + mNumOfObjects) T(std::forward<Args>(args)...); //nothing to undo if it throws
+
+            Slot* slot = (Slot*) mPolicy.allocate(sizeof(Slot));
+            if(slot->generation == 0) { //a handle is never NULL_HANDLE
+                slot->generation = 1;
+            }
+
+            slot->index = (uint32_t) mNumOfObjects;
+            mSlotOf[mNumOfObjects++] = (uint32_t) slotIndex(slot);
+
+            return (Handle) (((uint64_t) slot->generation << INDEX_BITS) | slotIndex(slot));
+        }
+
+        /*! \fn     bool remove(Handle handle)
+         *  \brief  Destroys the object, and moves the last object into its place.
+         *  \param  handle
+         *  \return False if the handle is stale, nothing is removed then.
+         */
+        bool remove(Handle handle) {
+            Slot* slot = resolve(handle);
+            if(slot == nullptr) {
+                return false;
+            }
+
+            size_t index = slot->index;
+            size_t last = --mNumOfObjects;
+            mObjects[index].~T();
+            if(index != last) { //swap-remove
+                new (mObjects + index) T(std::move(mObjects[last]));
+                mObjects[last].~T();
+                mSlotOf[index] = mSlotOf[last];
+                mSlots[mSlotOf[index]].index = (uint32_t) index;
+            }
+
+            slot->generation = (slot->generation + 1) & GENERATION_MASK;
+            mPolicy.deallocate(slot);
+            return true;
+        }
+
+        /*! \fn     T* get(Handle handle) const
+         *  \brief  The address is valid until the next remove().
+         *  \param  handle
+         *  \return The object, or nullptr if the handle is stale.
+         */
+        T* get(Handle handle) const {
+            Slot* slot = resolve(handle);
+            return slot != nullptr ? mObjects + slot->index : nullptr;
+        }
+
+        /*! \fn     bool contains(Handle handle) const
+         *  \return True if the object of the handle is still in the pool.
+         */
+        bool contains(Handle handle) const { return resolve(handle) != nullptr; }
+
+        /*! \fn     Handle getHandle(const size_t& index) const
+         *  \param  index Index of an object in the packed array.
+         *  \return The handle of the object.
+         */
+        Handle getHandle(const size_t& index) const {
+            ASSERT(index < mNumOfObjects);
+
+            const Slot& slot = mSlots[mSlotOf[index]];
+            return (Handle) (((uint64_t) slot.generation << INDEX_BITS) | mSlotOf[index]);
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Destroys every object, every handle becomes stale.
+         */
+        void clear() {
+            for(size_t i = 0; i < mNumOfObjects; i++) {
+                Slot& slot = mSlots[mSlotOf[i]];
+                slot.generation = (slot.generation + 1) & GENERATION_MASK;
+                mObjects[i].~T();
+            }
+
+            mNumOfObjects = 0;
+            mPolicy.clear();
+        }
+
+        /*! \fn     T* begin() const
+         *  \return The first of the packed objects.
+         */
+        T* begin() const { return mObjects; }
+
+        /*! \fn     T* end() const
+         *  \return The end of the packed objects.
+         */
+        T* end() const { return mObjects + mNumOfObjects; }
+
+        /*! \fn     size_t size() const
+         *  \return The number of objects.
+         */
+        size_t size() const { return mNumOfObjects; }
+
+        /*! \fn     const size_t& getCapacity() const
+         *  \return The most objects at once.
+         */
+        const size_t& getCapacity() const { return mCapacity; }
+
+        /*! \fn     size_t RequiredSize(const size_t& capacity)
+         *  \param  capacity The most objects at once.
+         *  \return The size of memory needed for them.
+         */
+        static size_t RequiredSize(const size_t& capacity) {
+            size_t slotOfOffset, objectsOffset;
+            return Layout(capacity, &slotOfOffset, &objectsOffset);
+        }
+    };
+}//mfg
+
+#endif // MFG_OBJECTPOOL_HPP
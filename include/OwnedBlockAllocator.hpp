@@ -0,0 +1,120 @@
+/*! \file   OwnedBlockAllocator.hpp
+ *  \brief  Block allocator of one thread, which other threads can deallocate into.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_OWNEDBLOCKALLOCATOR_HPP
+#define MFG_OWNEDBLOCKALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "BlockPolicy.hpp"
+#include "RemoteFreeList.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  OwnedBlockAllocator
+     *  \brief  This class can allocate different size of blocks, like BlockAllocator, on the
+     *          thread which owns it, and the blocks can be deallocated on any thread. The owner
+     *          deallocates into the BlockPolicy directly, the other threads push the block onto a
+     *          lock-free remote free list, which the owner drains at its next allocation with one
+     *          atomic exchange. A block freed remotely is counted as deallocated (statistics, trace,
+     *          profile) only when it is drained, on the owner.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class OwnedBlockAllocator : public Allocator {
+    private:
+        BlockPolicy mPolicy; //the strategy, used only by the owner
+        RemoteFreeList mRemote; //blocks deallocated by the other threads
+    public:
+        /*! \fn     OwnedBlockAllocator(void* memory, const size_t& size)
+         *  \brief  Constructor. The calling thread becomes the owner.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         */
+        OwnedBlockAllocator(void* memory, const size_t& size);
+
+        OwnedBlockAllocator(const OwnedBlockAllocator& other) = delete;
+        OwnedBlockAllocator& operator=(const OwnedBlockAllocator& other) = delete;
+        OwnedBlockAllocator(OwnedBlockAllocator&& other) = delete;
+        OwnedBlockAllocator& operator=(OwnedBlockAllocator&& other) = delete;
+
+        /*! \fn ~OwnedBlockAllocator()
+         *  \brief Destructor.
+         */
+        ~OwnedBlockAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates one block of memory with the specified size. Only the owner may call it.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates one aligned block of memory with the specified size. Only the owner may call it.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block. Can be called from any thread,
+         *          the owner merges it with its free neighbours.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block without the header.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks, the remotely deallocated ones
+         *          included. Only the owner may call it, and no other thread may deallocate meanwhile.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The biggest size which can be allocated at once, without the blocks which wait
+         *          to be drained. It walks the list of free blocks.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     void drainRemoteFrees()
+         *  \brief  Deallocates the blocks pushed by other threads. allocate() calls it when there are any,
+         *          it is needed only to give them back earlier. Only the owner may call it.
+         */
+        void drainRemoteFrees();
+
+        /*! \fn     bool isOwner() const
+         *  \return True if the calling thread is the owner.
+         */
+        bool isOwner() const;
+
+        /*! \fn     void setOwner()
+         *  \brief  The calling thread becomes the owner. The old owner may not use the allocator meanwhile.
+         */
+        void setOwner();
+    };
+}//mfg
+
+#endif // MFG_OWNEDBLOCKALLOCATOR_HPP
@@ -0,0 +1,126 @@
+/*! \file   OwnedPoolAllocator.hpp
+ *  \brief  Pool allocator of one thread, which other threads can deallocate into.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_OWNEDPOOLALLOCATOR_HPP
+#define MFG_OWNEDPOOLALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "PoolPolicy.hpp"
+#include "RemoteFreeList.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  OwnedPoolAllocator
+     *  \brief  This class can allocate only the same size of blocks, like PoolAllocator, on the
+     *          thread which owns it, and the blocks can be deallocated on any thread. The owner
+     *          deallocates into the PoolPolicy directly, the other threads push the block onto a
+     *          lock-free remote free list, which the owner drains at its next allocation with one
+     *          atomic exchange. A block freed remotely is counted as deallocated (statistics, trace,
+     *          profile) only when it is drained, on the owner.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class OwnedPoolAllocator : public Allocator {
+    private:
+        PoolPolicy mPolicy; //the strategy, used only by the owner
+        RemoteFreeList mRemote; //blocks deallocated by the other threads
+    public:
+        /*! \fn     OwnedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false)
+         *  \brief  Constructor. The calling thread becomes the owner.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  blockSize Size of blocks. (Must be bigger than the size of a pointer.)
+         *  \param  zeroMemory If true, the memory is filled with zeros on construction and on
+         *          clear(), and every deallocated block is filled with zeros as well.
+         */
+        OwnedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false);
+
+        OwnedPoolAllocator(const OwnedPoolAllocator& other) = delete;
+        OwnedPoolAllocator& operator=(const OwnedPoolAllocator& other) = delete;
+        OwnedPoolAllocator(OwnedPoolAllocator&& other) = delete;
+        OwnedPoolAllocator& operator=(OwnedPoolAllocator&& other) = delete;
+
+        /*! \fn ~OwnedPoolAllocator()
+         *  \brief Destructor.
+         */
+        ~OwnedPoolAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates exactly one block. Only the owner may call it.
+         *  \param  size Can not be bigger than size of a block.
+         *  \return The beginning of the memory block, or nullptr if there is no free block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates exactly one aligned block. Only the owner may call it.
+         *  \param  size Can not be bigger than size of a block.
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory. Can be called from any thread.
+         *  \param  memory The beginning of the memory.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the blocks.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks, the remotely deallocated ones
+         *          included. Only the owner may call it, and no other thread may deallocate meanwhile.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of a block, or 0 if every block is in use or waits to be drained.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     void drainRemoteFrees()
+         *  \brief  Deallocates the blocks pushed by other threads. allocate() calls it when there are any,
+         *          it is needed only to give them back earlier. Only the owner may call it.
+         */
+        void drainRemoteFrees();
+
+        /*! \fn     bool isOwner() const
+         *  \return True if the calling thread is the owner.
+         */
+        bool isOwner() const;
+
+        /*! \fn     void setOwner()
+         *  \brief  The calling thread becomes the owner. The old owner may not use the allocator meanwhile.
+         */
+        void setOwner();
+
+        /*! \fn     const size_t& getBlockSize() const
+         *  \return The size of one block.
+         */
+        const size_t& getBlockSize() const;
+    };
+}//mfg
+
+#endif // MFG_OWNEDPOOLALLOCATOR_HPP
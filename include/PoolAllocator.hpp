@@ -23,25 +23,31 @@ freely, subject to the following restrictions:
 #define MFG_POOLALLOCATOR_HPP
 
 #include "Allocator.hpp"
+#include "PoolPolicy.hpp"
 
 //! \namespace  mfg
 namespace mfg {
     /*! \class  PoolAllocator
      *  \brief  This class can allocate only the same size of blocks.
+     *          Blocks which have never been used are handed out with a bump pointer,
+     *          the deallocated ones are recycled through a free list. So construction
+     *          and clear() are constant time, and pages are touched only when used.
+     *          It is a virtual wrapper over PoolPolicy.
      *          Copy and move constructors and assignments are unavailable.
      */
     class PoolAllocator : public Allocator {
     private:
-        void** mPool; // memory blocks
-        size_t mBlockSize; //size of blocks
+        PoolPolicy mPolicy; //the strategy
     public:
-        /*! \fn     PoolAllocator(void* memory, const size_t& size, const size_t& blockSize)
+        /*! \fn     PoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false)
          *  \brief  Constructor.
          *  \param  memory The beginning of the memory.
          *  \param  size The size of the memory.
          *  \param  blockSize Size of blocks. (Must be bigger than the size of a pointer.)
+         *  \param  zeroMemory If true, the memory is filled with zeros on construction and on
+         *          clear(), and every deallocated block is filled with zeros as well.
          */
-        PoolAllocator(void* memory, const size_t& size, const size_t& blockSize);
+        PoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory = false);
 
         PoolAllocator(const PoolAllocator& other) = delete;
         PoolAllocator& operator=(const PoolAllocator& other) = delete;
@@ -56,21 +62,58 @@ namespace mfg {
         /*! \fn     void* allocate(const size_t& size)
          *  \brief  Allocates exactly one block.
          *  \param  size Can not be bigger than size of a block.
-         *  \return The beginning of the memory block.
+         *  \return The beginning of the memory block, or nullptr if there is no free block.
          */
         void* allocate(const size_t& size) final;
 
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates exactly one aligned block. It is as fast as the unaligned
+         *          version if the memory and the size of blocks are both aligned,
+         *          otherwise it searches the free list and the unused blocks for an aligned block.
+         *  \param  size Can not be bigger than size of a block.
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
         /*! \fn     void deallocate(void* memory)
          *  \brief  Deallocates the specified memory.
          *  \param  memory The beginning of the memory.
          */
         void deallocate(void* memory) final;
 
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the blocks.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     size_t allocateBatch(const size_t& count, void** memory)
+         *  \brief  Allocates many blocks with one call. A chain of the free list is
+         *          cut off in one step, and the rest is carved from the unused blocks.
+         *  \param  count The number of blocks.
+         *  \param  memory Receives the beginning of the blocks.
+         *  \return The number of allocated blocks, less than count if the pool runs out.
+         */
+        size_t allocateBatch(const size_t& count, void** memory);
+
+        /*! \fn     void deallocateBatch(void** memory, const size_t& count)
+         *  \brief  Deallocates many blocks with one call. They are pushed onto the free list as one chain.
+         *  \param  memory The beginning of the blocks.
+         *  \param  count The number of blocks.
+         */
+        void deallocateBatch(void** memory, const size_t& count);
+
         /*! \fn     void clear()
          *  \brief  Deallocates all the previously allocated blocks.
          */
         void clear() final;
 
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of a block, or 0 if every block is in use.
+         */
+        size_t getLargestFreeBlock() final;
+
         /*! \fn     const size_t& getBlockSize() const
          *  \return The size of one block.
          */
@@ -0,0 +1,240 @@
+/*! \file   PoolPolicy.hpp
+ *  \brief  Inline pool strategy for compile-time composition.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_POOLPOLICY_HPP
+#define MFG_POOLPOLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  PoolPolicy
+     *  \brief  The pool strategy without virtual dispatch. Every method is
+     *          inline, so it can be composed at compile time, and it returns
+     *          nullptr when the request can not be served.
+     *          PoolAllocator is a virtual wrapper over it.
+     */
+    class PoolPolicy {
+    private:
+        void* mMemory; //beginning of the memory
+        void** mPool; //deallocated memory blocks
+        void* mNext; //first block which has never been used
+        void* mEnd; //end of the last block
+        size_t mBlockSize; //size of blocks
+        bool mZeroMemory; //fill the memory and the deallocated blocks with zeros
+    public:
+        /*! \fn     PoolPolicy(void* memory, size_t size, size_t blockSize, bool zeroMemory = false)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  blockSize Size of blocks. (Must be bigger than the size of a pointer.)
+         *  \param  zeroMemory If true, the memory is filled with zeros on construction and on
+         *          clear(), and every deallocated block is filled with zeros as well.
+         */
+        PoolPolicy(void* memory, size_t size, size_t blockSize, bool zeroMemory = false) :
+            mMemory(memory),
+            mPool(nullptr),
+            mNext(memory),
+            mEnd(memory + size / blockSize * blockSize),
+            mBlockSize(blockSize),
+            mZeroMemory(zeroMemory)
+        {
+            if(zeroMemory) {
+                memset(memory, 0, size);
+            }
+        }
+
+        /*! \fn     void* allocate(size_t size)
+         *  \brief  Allocates exactly one block.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if the size
+         *          is bigger than a block or there is no free block.
+         */
+        void* allocate(size_t size) {
+            if(size > mBlockSize) {
+                return nullptr;
+            }
+
+            void* block;
+            if(mPool != nullptr) { //recycled blocks are hot
+                block = mPool;
+                mPool = (void**) *mPool;
+            }
+            else if(mNext != mEnd) {
+                block = mNext;
+                mNext += mBlockSize;
+            }
+            else { //every block is in use
+                return nullptr;
+            }
+
+            return block;
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \brief  Allocates exactly one aligned block. It is as fast as the unaligned
+         *          version if the memory and the size of blocks are both aligned,
+         *          otherwise it searches the free list and the unused blocks for an aligned block.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no aligned free block.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            if((((uintptr_t) mMemory | mBlockSize) & (alignment - 1)) == 0) { //every block is aligned
+                return allocate(size);
+            }
+
+            if(size > mBlockSize) {
+                return nullptr;
+            }
+
+            void** prev = nullptr;
+            void** block = mPool;
+            while(block != nullptr && ((uintptr_t) block & (alignment - 1)) != 0) {
+                prev = block;
+                block = (void**) *block;
+            }
+
+            if(block != nullptr) {
+                if(prev != nullptr) {
+                    *prev = *block;
+                }
+                else {
+                    mPool = (void**) *block;
+                }
+
+                return block;
+            }
+
+            while(mNext != mEnd && ((uintptr_t) mNext & (alignment - 1)) != 0) { //the skipped unused blocks go to the free list
+                *((void**) mNext) = mPool;
+                mPool = (void**) mNext;
+                mNext += mBlockSize;
+            }
+
+            if(mNext == mEnd) { //there is no aligned free block
+                return nullptr;
+            }
+
+            block = (void**) mNext;
+            mNext += mBlockSize;
+            return block;
+        }
+
+        /*! \fn     size_t allocateBatch(size_t count, void** memory)
+         *  \brief  Allocates many blocks at once. A chain of the free list is cut off
+         *          in one step, and the rest is carved from the unused blocks.
+         *  \param  count The number of blocks.
+         *  \param  memory Receives the beginning of the blocks.
+         *  \return The number of allocated blocks, less than count if the pool runs out.
+         */
+        size_t allocateBatch(size_t count, void** memory) {
+            size_t allocated = 0;
+
+            if(mPool != nullptr) { //recycled blocks are hot
+                void** block = mPool;
+                while(allocated < count && block != nullptr) {
+                    memory[allocated++] = block;
+                    block = (void**) *block;
+                }
+
+                mPool = block;
+            }
+
+            size_t unused = ((uintptr_t) mEnd - (uintptr_t) mNext) / mBlockSize;
+            size_t carved = count - allocated < unused ? count - allocated : unused;
+            for(size_t i = 0; i < carved; i++) {
+                memory[allocated++] = mNext + i * mBlockSize;
+            }
+
+            mNext += carved * mBlockSize;
+            return allocated;
+        }
+
+        /*! \fn     void deallocateBatch(void** memory, size_t count)
+         *  \brief  Deallocates many blocks at once. They are chained together,
+         *          and the chain is pushed onto the free list in one step.
+         *  \param  memory The beginning of the blocks.
+         *  \param  count The number of blocks.
+         */
+        void deallocateBatch(void** memory, size_t count) {
+            if(count == 0) {
+                return;
+            }
+
+            for(size_t i = 0; i < count; i++) {
+                if(mZeroMemory) {
+                    memset(memory[i], 0, mBlockSize);
+                }
+
+                *((void**) memory[i]) = i + 1 < count ? memory[i + 1] : (void*) mPool;
+            }
+
+            mPool = (void**) memory[0];
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified block.
+         *  \param  memory The beginning of the block.
+         */
+        void deallocate(void* memory) {
+            if(mZeroMemory) {
+                memset(memory, 0, mBlockSize);
+            }
+
+            *((void**) memory) = mPool;
+            mPool = (void**) memory;
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() {
+            if(mZeroMemory) { //the blocks after mNext have not been touched since the last time
+                memset(mMemory, 0, (uintptr_t) mNext - (uintptr_t) mMemory);
+            }
+
+            mPool = nullptr;
+            mNext = mMemory;
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if the memory is inside the handled memory.
+         */
+        bool owns(const void* memory) const {
+            return (uintptr_t) memory - (uintptr_t) mMemory < (uintptr_t) mEnd - (uintptr_t) mMemory;
+        }
+
+        /*! \fn     const size_t& getBlockSize() const
+         *  \return The size of one block.
+         */
+        const size_t& getBlockSize() const { return mBlockSize; }
+
+        /*! \fn     size_t getLargestFreeBlock() const
+         *  \return The size of a block, or 0 if every block is in use.
+         */
+        size_t getLargestFreeBlock() const { return mPool != nullptr || mNext != mEnd ? mBlockSize : 0; }
+    };
+}//mfg
+
+#endif // MFG_POOLPOLICY_HPP
@@ -0,0 +1,97 @@
+/*! \file   RemoteFreeList.hpp
+ *  \brief  Blocks deallocated by other threads than the owner of their allocator.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_REMOTEFREELIST_HPP
+#define MFG_REMOTEFREELIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  RemoteFreeList
+     *  \brief  A lock-free stack with many producers and one consumer. Any thread pushes
+     *          a block with a compare-and-swap, the first word of the block links it.
+     *          The owner takes the whole chain with one exchange, so a popped head is
+     *          never compared again, and the stack has no ABA problem.
+     *          It also remembers which thread owns the allocator.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class RemoteFreeList {
+    private:
+        alignas(64) std::atomic<void*> mHead; //the last pushed block, on its own cache line
+        std::atomic<std::thread::id> mOwner; //the thread which may allocate and drain
+    public:
+        /*! \fn     RemoteFreeList()
+         *  \brief  Constructor. The calling thread becomes the owner.
+         */
+        RemoteFreeList() :
+            mHead(nullptr),
+            mOwner(std::this_thread::get_id())
+        {}
+
+        RemoteFreeList(const RemoteFreeList& other) = delete;
+        RemoteFreeList& operator=(const RemoteFreeList& other) = delete;
+        RemoteFreeList(RemoteFreeList&& other) = delete;
+        RemoteFreeList& operator=(RemoteFreeList&& other) = delete;
+
+        /*! \fn     bool isOwner() const
+         *  \return True if the calling thread is the owner.
+         */
+        bool isOwner() const { return mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id(); }
+
+        /*! \fn     void setOwner()
+         *  \brief  The calling thread becomes the owner. The old owner may not use the allocator meanwhile.
+         */
+        void setOwner() { mOwner.store(std::this_thread::get_id(), std::memory_order_release); }
+
+        /*! \fn     void push(void* block)
+         *  \brief  Pushes a block deallocated by a thread which is not the owner. Can be called from any thread.
+         *  \param  block Its first word is overwritten.
+         */
+        void push(void* block) {
+            void* head = mHead.load(std::memory_order_relaxed);
+            do {
+                *(void**) block = head;
+            } while(!mHead.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        /*! \fn     bool isEmpty() const
+         *  \return True if there is no block to drain. One relaxed load, so it is cheap to check on every allocation.
+         */
+        bool isEmpty() const { return mHead.load(std::memory_order_relaxed) == nullptr; }
+
+        /*! \fn     void* takeAll()
+         *  \brief  Takes every pushed block. Only the owner may call it.
+         *  \return The last pushed block, the first word of each block is the next one, nullptr ends the chain.
+         */
+        void* takeAll() { return mHead.exchange(nullptr, std::memory_order_acquire); }
+
+        /*! \fn     void* Next(void* block)
+         *  \param  block A block of the chain returned by takeAll().
+         *  \return The next block in the chain, or nullptr.
+         */
+        static void* Next(void* block) { return *(void**) block; }
+    };
+}//mfg
+
+#endif // MFG_REMOTEFREELIST_HPP
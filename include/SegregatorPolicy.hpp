@@ -0,0 +1,110 @@
+/*! \file   SegregatorPolicy.hpp
+ *  \brief  Composes two policies: route the requests by size.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_SEGREGATORPOLICY_HPP
+#define MFG_SEGREGATORPOLICY_HPP
+
+#include <cstddef>
+#include <utility>
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  SegregatorPolicy
+     *  \brief  Routes the requests up to a size threshold to one policy,
+     *          and the bigger ones to an other. Memory goes back to the policy which owns it.
+     *  \tparam Threshold The biggest size served by the small policy.
+     *  \tparam Small The policy of the requests up to the threshold.
+     *  \tparam Large The policy of the requests above the threshold.
+     */
+    template<size_t Threshold, class Small, class Large>
+    class SegregatorPolicy {
+    private:
+        Small mSmall; //serves the sizes up to the threshold
+        Large mLarge; //serves the sizes above the threshold
+    public:
+        /*! \fn     SegregatorPolicy(Small small, Large large)
+         *  \brief  Constructor.
+         *  \param  small The policy of the requests up to the threshold.
+         *  \param  large The policy of the requests above the threshold.
+         */
+        SegregatorPolicy(Small small, Large large) :
+            mSmall(std::move(small)),
+            mLarge(std::move(large))
+        {}
+
+        /*! \fn     void* allocate(size_t size)
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if the chosen policy can not serve it.
+         */
+        void* allocate(size_t size) {
+            return size <= Threshold ? mSmall.allocate(size) : mLarge.allocate(size);
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if the chosen policy can not serve it.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            return size <= Threshold ? mSmall.allocate(size, alignment) : mLarge.allocate(size, alignment);
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the memory with the policy which owns it.
+         *  \param  memory
+         */
+        void deallocate(void* memory) {
+            if(mSmall.owns(memory)) {
+                mSmall.deallocate(memory);
+            }
+            else {
+                mLarge.deallocate(memory);
+            }
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory of both policies.
+         */
+        void clear() {
+            mSmall.clear();
+            mLarge.clear();
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if one of the policies owns the memory.
+         */
+        bool owns(const void* memory) const {
+            return mSmall.owns(memory) || mLarge.owns(memory);
+        }
+
+        /*! \fn     Small& getSmall()
+         *  \return The policy of the requests up to the threshold.
+         */
+        Small& getSmall() { return mSmall; }
+
+        /*! \fn     Large& getLarge()
+         *  \return The policy of the requests above the threshold.
+         */
+        Large& getLarge() { return mLarge; }
+    };
+}//mfg
+
+#endif // MFG_SEGREGATORPOLICY_HPP
@@ -0,0 +1,148 @@
+/*! \file   SlabAllocator.hpp
+ *  \brief  Handles small blocks in size-classed slabs.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_SLABALLOCATOR_HPP
+#define MFG_SLABALLOCATOR_HPP
+
+#include "Allocator.hpp"
+#include "BlockPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  SlabAllocator
+     *  \brief  This class can allocate different size of blocks without a header on them.
+     *          Small requests are rounded up to geometric size classes, and every class
+     *          takes its blocks from slabs like a PoolAllocator. Slabs are aligned to their
+     *          size and start with a header, so the slab of a block is found from its
+     *          address alone. Empty slabs can be reused by any class. Requests bigger than
+     *          MAX_SMALL_SIZE, and small ones when every slab is in use, are served by a
+     *          BlockPolicy from the front of the memory.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class SlabAllocator : public Allocator {
+    public:
+        enum : size_t {
+            MAX_SMALL_SIZE = 1024, //biggest size served from slabs
+            NUM_SIZE_CLASSES = 24 //8, 16, 24, 32, then 4 classes for every doubling
+        };
+    private:
+        struct Slab { //header at the beginning of every slab
+            Slab* next; //next slab in the list of its class or in the list of empty slabs
+            Slab* prev; //previous slab in the list of its class
+            void** freeList; //deallocated blocks
+            void* unused; //first block which has never been used
+            size_t blockSize; //size of blocks
+            size_t used; //number of blocks in use
+            size_t capacity; //number of blocks
+            size_t sizeClass; //index of the size class
+        };
+
+        enum : size_t {
+            SLAB_HEADER_SIZE = 64 //blocks start at this offset of a slab
+        };
+
+        BlockPolicy mBlocks; //the strategy for the big requests
+        void* mSlabs; //beginning of the first slab
+        size_t mSlabsSize; //size of all the slabs
+        size_t mSlabSize; //size of one slab
+        void* mNextSlab; //first slab which has never been used
+        Slab* mEmptySlabs; //slabs which can be used by any class
+        Slab* mPartialSlabs[NUM_SIZE_CLASSES]; //slabs of the classes with free blocks
+        uint8_t mSizeToClass[MAX_SMALL_SIZE / 8 + 1]; //size class of every multiple of 8
+
+        Slab* createSlab(const size_t& sizeClass);
+        void* allocateFromSlab(const size_t& sizeClass);
+        void linkSlab(Slab* slab);
+        void unlinkSlab(Slab* slab);
+    public:
+        /*! \fn     SlabAllocator(void* memory, const size_t& size, const size_t& blockMemorySize, const size_t& slabSize = 65536)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  blockMemorySize The size of the front of the memory which serves the big requests.
+         *  \param  slabSize Size of one slab. (Must be a power of two, big enough for a few blocks of MAX_SMALL_SIZE.)
+         */
+        SlabAllocator(void* memory, const size_t& size, const size_t& blockMemorySize, const size_t& slabSize = 65536);
+
+        SlabAllocator(const SlabAllocator& other) = delete;
+        SlabAllocator& operator=(const SlabAllocator& other) = delete;
+        SlabAllocator(SlabAllocator&& other) = delete;
+        SlabAllocator& operator=(SlabAllocator&& other) = delete;
+
+        /*! \fn ~SlabAllocator()
+         *  \brief Destructor.
+         */
+        ~SlabAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates one block of the size class of the specified size,
+         *          or a block of the BlockPolicy if the size is too big.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates one aligned block. It is taken from the first size class
+         *          which holds the size and whose blocks are all aligned, otherwise from the BlockPolicy.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block. Its slab is found from its address.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, without the header of a big block.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The biggest size which can be allocated at once, from the BlockPolicy or from a slab.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     size_t CheckSize(void* memory) const
+         *  \brief  Check the size of the specified memory block.
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, the header of a big block included.
+         */
+        size_t CheckSize(void* memory) const;
+
+        /*! \fn     const size_t& getSlabSize() const
+         *  \return The size of one slab.
+         */
+        const size_t& getSlabSize() const;
+    };
+}//mfg
+
+#endif // MFG_SLABALLOCATOR_HPP
@@ -23,19 +23,20 @@ freely, subject to the following restrictions:
 #define MFG_STACKALLOCATOR_HPP
 
 #include "Allocator.hpp"
+#include "StackPolicy.hpp"
 
 //! \namespace  mfg
 namespace mfg {
-    typedef size_t Marker;  //! \typedef    size_t Marker
-
     /*! \class  StackAllocator
      *  \brief  This class can allocate different size of memory,
      *          but can deallocate it only with a marker.
+     *          It is a virtual wrapper over StackPolicy.
      *          Copy and move constructors and assignments are unavailable.
      */
     class StackAllocator : public Allocator {
     private:
-        size_t mMarker; //current marker
+        StackPolicy mPolicy; //the strategy
+        MarkerCheckpoints mCheckpoints; //allocations below the markers, for the statistics
     public:
         /*! \fn     StackAllocator(void* memory, const size_t& size)
          *  \brief  Constructor.
@@ -61,6 +62,15 @@ namespace mfg {
          */
         void* allocate(const size_t& size);
 
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates aligned memory with the specified size.
+         *          The padding in front of it is counted as used memory.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(const size_t& size, const size_t& alignment);
+
         /*! \fn     void deallocate(void* memory)
          *  \brief  In this class this method is not working.
          *          Use void deallocateTo(void* memory) instead.
@@ -68,8 +78,23 @@ namespace mfg {
          */
         void deallocate(void* memory);
 
+        /*! \fn     void* reallocate(void* memory, const size_t& size)
+         *  \brief  Resizes the last allocation in place by moving the marker. Any other
+         *          memory is copied into a new allocation, the old one stays until deallocateTo().
+         *  \param  memory The beginning of the memory, or nullptr to allocate a new one.
+         *  \param  size The new size.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* reallocate(void* memory, const size_t& size);
+
+        /*! \fn     bool canDeallocate() const
+         *  \return False, memory comes back only by deallocateTo(Marker marker) and clear().
+         */
+        bool canDeallocate() const;
+
         /*! \fn     void deallocateTo(Marker marker)
-         *  \brief  Deallocate all the items next to marker.
+         *  \brief  Deallocate all the items next to marker. The statistics count the released
+         *          allocations exactly if the marker has been given by getMarker() while they were on.
          *  \param  marker
          */
         void deallocateTo(Marker marker);
@@ -79,6 +104,11 @@ namespace mfg {
          */
         void clear();
 
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of the memory above the current marker.
+         */
+        size_t getLargestFreeBlock();
+
         /*! \fn     Marker getMarker()
          *  \return The current marker.
          */
@@ -0,0 +1,160 @@
+/*! \file   StackPolicy.hpp
+ *  \brief  Inline stack strategy for compile-time composition.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_STACKPOLICY_HPP
+#define MFG_STACKPOLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+//! \namespace  mfg
+namespace mfg {
+    typedef size_t Marker;  //! \typedef    size_t Marker
+
+    /*! \class  StackPolicy
+     *  \brief  The stack strategy without virtual dispatch. Every method is
+     *          inline, so it can be composed at compile time, and it returns
+     *          nullptr instead of asserting when the memory runs out.
+     *          StackAllocator is a virtual wrapper over it.
+     */
+    class StackPolicy {
+    private:
+        void* mMemory;  //beginning of the memory
+        size_t mSize;   //size of the memory
+        size_t mMarker; //current marker
+        void* mLast;    //beginning of the last allocation, or nullptr if it is unknown
+    public:
+        /*! \fn     StackPolicy(void* memory, size_t size)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         */
+        StackPolicy(void* memory, size_t size) :
+            mMemory(memory),
+            mSize(size),
+            mMarker(0),
+            mLast(nullptr)
+        {}
+
+        /*! \fn     void* allocate(size_t size)
+         *  \brief  Allocates memory with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(size_t size) {
+            if(size > mSize - mMarker) {
+                return nullptr;
+            }
+
+            mMarker += size;
+            mLast = mMemory + mMarker - size;
+            return mLast;
+        }
+
+        /*! \fn     void* allocate(size_t size, size_t alignment)
+         *  \brief  Allocates aligned memory with the specified size.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory, or nullptr if it does not fit.
+         */
+        void* allocate(size_t size, size_t alignment) {
+            size_t padding = (alignment - (((uintptr_t) mMemory + mMarker) & (alignment - 1))) & (alignment - 1);
+            if(padding + size > mSize - mMarker) {
+                return nullptr;
+            }
+
+            mMarker += padding + size;
+            mLast = mMemory + mMarker - size;
+            return mLast;
+        }
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Does nothing, use deallocateTo(Marker marker) instead.
+         *  \param  memory
+         */
+        void deallocate(void* memory) {}
+
+        /*! \fn     void deallocateTo(Marker marker)
+         *  \brief  Deallocate all the items next to marker.
+         *  \param  marker
+         */
+        void deallocateTo(Marker marker) {
+            if(mLast != nullptr && (uintptr_t) mLast - (uintptr_t) mMemory >= marker) { //the last allocation is gone
+                mLast = nullptr;
+            }
+
+            mMarker = marker;
+        }
+
+        /*! \fn     bool reallocate(void* memory, size_t size)
+         *  \brief  Resizes the last allocation in place by moving the marker.
+         *  \param  memory The beginning of the memory block.
+         *  \param  size The new size.
+         *  \return False if the memory is not the last allocation, a marker has been taken
+         *          since it, or it does not fit. It is unchanged then.
+         */
+        bool reallocate(void* memory, size_t size) {
+            if(memory == nullptr || memory != mLast || size > mSize - ((uintptr_t) memory - (uintptr_t) mMemory)) {
+                return false;
+            }
+
+            mMarker = (uintptr_t) memory - (uintptr_t) mMemory + size;
+            return true;
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated memory.
+         */
+        void clear() {
+            mMarker = 0;
+            mLast = nullptr;
+        }
+
+        /*! \fn     bool owns(const void* memory) const
+         *  \return True if the memory is inside the handled memory.
+         */
+        bool owns(const void* memory) const {
+            return (uintptr_t) memory - (uintptr_t) mMemory < mSize;
+        }
+
+        /*! \fn     Marker getMarker() const
+         *  \return The current marker.
+         */
+        Marker getMarker() const { return mMarker; }
+
+        /*! \fn     Marker takeMarker()
+         *  \brief  Gives out the current marker to roll back to later. The last allocation
+         *          is not resized in place any more, because it would move the marker under it.
+         *  \return The current marker.
+         */
+        Marker takeMarker() {
+            mLast = nullptr;
+            return mMarker;
+        }
+
+        /*! \fn     size_t getLargestFreeBlock() const
+         *  \return The size of the memory above the marker.
+         */
+        size_t getLargestFreeBlock() const { return mSize - mMarker; }
+    };
+}//mfg
+
+#endif // MFG_STACKPOLICY_HPP
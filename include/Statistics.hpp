@@ -0,0 +1,296 @@
+/*! \file   Statistics.hpp
+ *  \brief  Runtime statistics of allocators.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_STATISTICS_HPP
+#define MFG_STATISTICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "StackPolicy.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    class Allocator;
+
+    /*! \struct StatisticsSnapshot
+     *  \brief  The statistics of one allocator at one moment.
+     */
+    struct StatisticsSnapshot {
+        enum : size_t {
+            NUM_BUCKETS = 32 //bucket 0 counts the empty requests, bucket i the sizes in [2^(i-1), 2^i), the last one everything bigger
+        };
+
+        const Allocator* allocator;         //the allocator
+        const char* name;                   //name given to Allocator::enableStatistics(), or nullptr
+        size_t usedSize;                    //bytes in use, padding and headers included
+        size_t highWaterMark;               //the most bytes in use at any time
+        size_t numOfAllocations;            //allocations in use
+        uint64_t totalAllocations;          //successful allocations
+        uint64_t totalDeallocations;        //deallocated allocations
+        uint64_t failedAllocations;         //allocations which returned nullptr
+        uint64_t histogram[NUM_BUCKETS];    //requests by size
+    };
+
+    /*! \class  Statistics
+     *  \brief  Runtime statistics of one allocator. The counters are sharded by thread.
+     *          A thread owns its shard while it lives, and writes it without read-modify-write
+     *          instructions, only the threads beyond the owned shards share the last one.
+     *          The bytes in use are sharded too, and summed when read. A shard keeps the peak and
+     *          the lowest value of its own bytes, the lowest is below 0 if the shard gave back the
+     *          bytes of other threads. The peak of a shard plus the lowest values of the others is a
+     *          lower bound of the real high-water mark. So the high-water mark is exact while one
+     *          thread allocates and deallocates, and it never overshoots. The more bytes are
+     *          deallocated by other threads than the ones which allocated them, the more it falls
+     *          behind, down to the largest sum read by getUsedSize() and snapshot(), which misses the
+     *          peaks between the reads. This keeps every record free of shared read-modify-write
+     *          instructions.
+     *          Every allocator with statistics switched on is registered, and
+     *          SnapshotAll(std::vector<StatisticsSnapshot>& snapshots) reads all of them.
+     */
+    class Statistics {
+    public:
+        enum : size_t {
+            NUM_SHARDS = 16, //number of counter shards
+            SHARED_SHARD = NUM_SHARDS - 1 //shard of the threads which could not get their own one
+        };
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> allocations;
+            std::atomic<uint64_t> deallocations;
+            std::atomic<uint64_t> failures;
+            std::atomic<uint64_t> histogram[StatisticsSnapshot::NUM_BUCKETS];
+            std::atomic<int64_t> used; //bytes allocated minus bytes deallocated through the shard
+            std::atomic<int64_t> peak; //the most bytes in use, not kept by the shared shard
+            std::atomic<int64_t> lowest; //the least bytes in use, below 0 if the shard gave back the bytes of others
+        };
+
+        struct ShardOwner { //gives back the shard of a thread when it exits
+            size_t index;
+
+            ShardOwner();
+            ~ShardOwner();
+        };
+
+        Shard mShards[NUM_SHARDS]; //counters of the threads
+        mutable std::atomic<int64_t> mHighWaterMark; //the most bytes in use read so far
+        const char* mName; //name for the snapshots
+
+        static std::atomic<uint32_t> sOwnedShards; //bit i is set while a thread owns shard i
+
+        static size_t GetShardIndex() {
+            static thread_local ShardOwner owner;
+            return owner.index;
+        }
+
+        static void Add(std::atomic<uint64_t>& counter, const uint64_t& value, const bool& owned) {
+            if(owned) { //nobody else writes it
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+            else {
+                counter.fetch_add(value, std::memory_order_relaxed);
+            }
+        }
+
+        size_t sampleUsedSize() const;
+
+        static size_t GetBucket(const size_t& size) {
+            size_t bucket = size == 0 ? 0 : sizeof(unsigned long long) * 8 - __builtin_clzll(size);
+            return bucket < StatisticsSnapshot::NUM_BUCKETS ? bucket : StatisticsSnapshot::NUM_BUCKETS - 1;
+        }
+    public:
+        /*! \fn     Statistics(const char* name)
+         *  \brief  Constructor.
+         *  \param  name Name for the snapshots, or nullptr.
+         */
+        explicit Statistics(const char* name);
+
+        Statistics(const Statistics& other) = delete;
+        Statistics& operator=(const Statistics& other) = delete;
+        Statistics(Statistics&& other) = delete;
+        Statistics& operator=(Statistics&& other) = delete;
+
+        /*! \fn     void recordAllocate(const size_t& size, const size_t& used, const size_t& count = 1)
+         *  \brief  Records successful allocations with the same requested size.
+         *  \param  size The requested size.
+         *  \param  used The size of memory taken by all the allocations.
+         *  \param  count The number of allocations.
+         */
+        void recordAllocate(const size_t& size, const size_t& used, const size_t& count = 1) {
+            size_t index = GetShardIndex();
+            Shard& shard = mShards[index];
+            Add(shard.allocations, count, index != SHARED_SHARD);
+            Add(shard.histogram[GetBucket(size)], count, index != SHARED_SHARD);
+
+            if(index != SHARED_SHARD) {
+                int64_t usedSize = shard.used.load(std::memory_order_relaxed) + used;
+                shard.used.store(usedSize, std::memory_order_relaxed);
+                if(usedSize > shard.peak.load(std::memory_order_relaxed)) {
+                    shard.peak.store(usedSize, std::memory_order_relaxed);
+                }
+            }
+            else {
+                shard.used.fetch_add(used, std::memory_order_relaxed);
+            }
+        }
+
+        /*! \fn     void recordDeallocate(const size_t& used, const size_t& count = 1)
+         *  \brief  Records deallocations.
+         *  \param  used The size of memory given back.
+         *  \param  count The number of deallocated allocations.
+         */
+        void recordDeallocate(const size_t& used, const size_t& count = 1) {
+            size_t index = GetShardIndex();
+            Shard& shard = mShards[index];
+            Add(shard.deallocations, count, index != SHARED_SHARD);
+
+            int64_t usedSize;
+            if(index != SHARED_SHARD) {
+                usedSize = shard.used.load(std::memory_order_relaxed) - used;
+                shard.used.store(usedSize, std::memory_order_relaxed);
+            }
+            else {
+                usedSize = shard.used.fetch_sub(used, std::memory_order_relaxed) - used;
+            }
+
+            int64_t lowest = shard.lowest.load(std::memory_order_relaxed);
+            while(usedSize < lowest && !shard.lowest.compare_exchange_weak(lowest, usedSize, std::memory_order_relaxed)); //only once a shard gives back the bytes of others
+        }
+
+        /*! \fn     void recordFailure(const size_t& size)
+         *  \brief  Records an allocation which returned nullptr.
+         *  \param  size The requested size.
+         */
+        void recordFailure(const size_t& size) {
+            size_t index = GetShardIndex();
+            Shard& shard = mShards[index];
+            Add(shard.failures, 1, index != SHARED_SHARD);
+            Add(shard.histogram[GetBucket(size)], 1, index != SHARED_SHARD);
+        }
+
+        /*! \fn     void recordClear()
+         *  \brief  Records that every allocation has been deallocated.
+         *          No other thread may use the allocator meanwhile.
+         */
+        void recordClear();
+
+        /*! \fn     size_t getUsedSize() const
+         *  \brief  Sums the bytes in use of the shards, and updates the high-water mark with it.
+         *  \return The bytes in use.
+         */
+        size_t getUsedSize() const;
+
+        /*! \fn     size_t getNumberOfAllocations() const
+         *  \return The number of allocations in use.
+         */
+        size_t getNumberOfAllocations() const;
+
+        /*! \fn     void setName(const char* name)
+         *  \param  name Name for the snapshots, or nullptr.
+         */
+        void setName(const char* name);
+
+        /*! \fn     void snapshot(StatisticsSnapshot& snapshot) const
+         *  \brief  Reads every counter. The counters of other threads may be a few operations behind.
+         *  \param  snapshot Receives the counters.
+         */
+        void snapshot(StatisticsSnapshot& snapshot) const;
+
+        /*! \fn     void Register(Allocator* allocator)
+         *  \brief  Adds an allocator to the ones read by SnapshotAll().
+         *  \param  allocator
+         */
+        static void Register(Allocator* allocator);
+
+        /*! \fn     void Unregister(Allocator* allocator)
+         *  \brief  Removes an allocator from the ones read by SnapshotAll().
+         *  \param  allocator
+         */
+        static void Unregister(Allocator* allocator);
+
+        /*! \fn     void SnapshotAll(std::vector<StatisticsSnapshot>& snapshots)
+         *  \brief  Reads the statistics of every allocator which has them switched on.
+         *  \param  snapshots Receives one snapshot per allocator.
+         */
+        static void SnapshotAll(std::vector<StatisticsSnapshot>& snapshots);
+    };
+
+    /*! \class  MarkerCheckpoints
+     *  \brief  Counts the allocations of a stack below the markers handed out, so
+     *          rolling back to a marker can tell how many allocations it releases.
+     *          It is used only while statistics are on. The count is exact for the
+     *          markers which have been handed out meanwhile.
+     */
+    class MarkerCheckpoints {
+    private:
+        std::vector<std::pair<Marker, size_t>> mCheckpoints; //markers with the number of allocations below them
+        size_t mAllocations; //number of allocations counted on the stack
+    public:
+        MarkerCheckpoints() : mAllocations(0) {}
+
+        /*! \fn     void onAllocate(const size_t& count = 1)
+         *  \brief  Counts allocations on the top of the stack.
+         *  \param  count The number of allocations.
+         */
+        void onAllocate(const size_t& count = 1) { mAllocations += count; }
+
+        /*! \fn     void record(Marker marker)
+         *  \brief  Records a marker handed out, the ones above it are stale.
+         *  \param  marker
+         */
+        void record(Marker marker) {
+            while(!mCheckpoints.empty() && mCheckpoints.back().first >= marker) {
+                mCheckpoints.pop_back();
+            }
+
+            mCheckpoints.push_back({marker, mAllocations});
+        }
+
+        /*! \fn     size_t rollBack(Marker marker)
+         *  \brief  Rolls back the count to a marker.
+         *  \param  marker
+         *  \return The number of allocations above the marker.
+         */
+        size_t rollBack(Marker marker) {
+            while(!mCheckpoints.empty() && mCheckpoints.back().first > marker) {
+                mCheckpoints.pop_back();
+            }
+
+            size_t below = mCheckpoints.empty() ? 0 : mCheckpoints.back().second;
+            size_t released = mAllocations - below;
+            mAllocations = below;
+            return released;
+        }
+
+        /*! \fn     void clear()
+         *  \brief  Forgets every allocation and marker.
+         */
+        void clear() {
+            mCheckpoints.clear();
+            mAllocations = 0;
+        }
+    };
+}//mfg
+
+#endif // MFG_STATISTICS_HPP
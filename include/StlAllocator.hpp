@@ -0,0 +1,104 @@
+/*! \file   StlAllocator.hpp
+ *  \brief  Typed allocator for STL containers.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_STLALLOCATOR_HPP
+#define MFG_STLALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  StlAllocator
+     *  \brief  A typed allocator for STL containers, which allocates with an mfg allocator.
+     *          If the allocator can not free individual blocks (see Allocator::canDeallocate()),
+     *          deallocation does nothing, and the memory comes back only when the
+     *          allocator is cleared. Throws std::bad_alloc if the allocator runs out of memory.
+     *  \tparam T The type of the elements.
+     */
+    template<class T>
+    class StlAllocator {
+        template<class U> friend class StlAllocator;
+    private:
+        Allocator* mAllocator; //the allocator which serves the requests
+    public:
+        typedef T value_type;
+
+        /*! \fn     StlAllocator(Allocator* allocator)
+         *  \brief  Constructor.
+         *  \param  allocator The allocator which serves the requests. It has to outlive the containers.
+         */
+        StlAllocator(Allocator* allocator) noexcept : mAllocator(allocator) {}
+
+        /*! \fn     StlAllocator()
+         *  \brief  Constructor, uses the default allocator of the process (see SetDefaultAllocator()).
+         */
+        StlAllocator() noexcept : mAllocator(GetDefaultAllocator()) {}
+
+        /*! \fn     StlAllocator(const StlAllocator<U>& other)
+         *  \brief  Converting constructor, uses the same allocator.
+         */
+        template<class U>
+        StlAllocator(const StlAllocator<U>& other) noexcept : mAllocator(other.mAllocator) {}
+
+        /*! \fn     T* allocate(size_t count)
+         *  \brief  Throws std::bad_array_new_length if the size of the elements overflows.
+         *  \param  count The number of elements. 0 allocates one byte, as MemoryResource does.
+         *  \return The beginning of the memory of the elements.
+         */
+        T* allocate(size_t count) {
+            if(count > SIZE_MAX / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+
+            void* memory = mAllocator->allocate(count > 0 ? count * sizeof(T) : 1, alignof(T));
+            if(memory == nullptr) {
+                throw std::bad_alloc();
+            }
+
+            return (T*) memory;
+        }
+
+        /*! \fn     void deallocate(T* memory, size_t count)
+         *  \param  memory The beginning of the memory of the elements.
+         *  \param  count The number of elements.
+         */
+        void deallocate(T* memory, size_t count) {
+            mAllocator->deallocate(memory); //does nothing if the allocator can not deallocate
+        }
+
+        /*! \fn     Allocator* getAllocator() const
+         *  \return The allocator which serves the requests.
+         */
+        Allocator* getAllocator() const { return mAllocator; }
+
+        template<class U>
+        bool operator==(const StlAllocator<U>& other) const { return mAllocator == other.mAllocator; }
+
+        template<class U>
+        bool operator!=(const StlAllocator<U>& other) const { return mAllocator != other.mAllocator; }
+    };
+}//mfg
+
+#endif // MFG_STLALLOCATOR_HPP
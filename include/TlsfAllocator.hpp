@@ -0,0 +1,142 @@
+/*! \file   TlsfAllocator.hpp
+ *  \brief  Handles different sized blocks with a two-level segregated-fit index.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_TLSFALLOCATOR_HPP
+#define MFG_TLSFALLOCATOR_HPP
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \class  TlsfAllocator
+     *  \brief  This class can allocate different size of blocks in constant time.
+     *          Free blocks are kept in size-class buckets indexed by a first and
+     *          a second level bitmap, so neither allocate nor deallocate walks a list.
+     *          It can be used in place of BlockAllocator. The memory handed out is
+     *          16 byte aligned, so malloc sized alignments need no gap in front.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class TlsfAllocator : public Allocator {
+    private:
+        enum : size_t {
+            SL_INDEX_COUNT_LOG2 = 5,  //number of second level buckets (log2)
+            ALIGN_SIZE_LOG2 = 4,      //every block size is a multiple of 16, so the memory handed out is aligned like malloc's
+            ALIGN_SIZE = (size_t) 1 << ALIGN_SIZE_LOG2,
+            FL_INDEX_MAX = 40,        //biggest block is below 1 TB
+            SL_INDEX_COUNT = (size_t) 1 << SL_INDEX_COUNT_LOG2,
+            FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2,
+            FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1,
+            SMALL_BLOCK_SIZE = (size_t) 1 << FL_INDEX_SHIFT
+        };
+
+        struct Block { //mask for blocks
+            Block* prevPhys;    //valid only if the previous block is free (lives in its last word)
+            size_t size;        //size of the block with flags in the lowest bits
+            Block* nextFree;    //valid only if this block is free
+            Block* prevFree;    //valid only if this block is free
+        };
+
+        size_t mFlBitmap;                                   //non-empty first level classes
+        uint32_t mSlBitmap[FL_INDEX_COUNT];                 //non-empty second level classes
+        Block* mFreeLists[FL_INDEX_COUNT][SL_INDEX_COUNT];  //heads of the free lists
+
+        void insertBlock(Block* block);
+        void removeBlock(Block* block);
+        Block* findSuitableBlock(const size_t& size);
+        void* useBlock(Block* block, const size_t& gap, size_t newSize);
+    public:
+        /*! \fn     TlsfAllocator(void* memory, const size_t& size, const bool& zeroMemory = true)
+         *  \brief  Constructor.
+         *  \param  memory The beginning of the memory.
+         *  \param  size The size of the memory.
+         *  \param  zeroMemory If true, the memory is filled with zeros. Fresh pages of mmap are zero already.
+         */
+        TlsfAllocator(void* memory, const size_t& size, const bool& zeroMemory = true);
+
+        TlsfAllocator(const TlsfAllocator& other) = delete;
+        TlsfAllocator& operator=(const TlsfAllocator& other) = delete;
+        TlsfAllocator(TlsfAllocator&& other) = delete;
+        TlsfAllocator& operator=(TlsfAllocator&& other) = delete;
+
+        /*! \fn ~TlsfAllocator()
+         *  \brief Destructor.
+         */
+        ~TlsfAllocator();
+
+        /*! \fn     void* allocate(const size_t& size)
+         *  \brief  Allocates one block of memory with the specified size.
+         *  \param  size
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size) final;
+
+        /*! \fn     void* allocate(const size_t& size, const size_t& alignment)
+         *  \brief  Allocates one aligned block of memory with the specified size.
+         *          The space skipped in front of it stays a free block.
+         *  \param  size
+         *  \param  alignment Must be a power of two.
+         *  \return The beginning of the memory block, or nullptr if there is no fitting block.
+         */
+        void* allocate(const size_t& size, const size_t& alignment) final;
+
+        /*! \fn     void deallocate(void* memory)
+         *  \brief  Deallocates the specified memory block, and merges it
+         *          with its free neighbours.
+         *  \param  memory The beginning of the memory block.
+         */
+        void deallocate(void* memory) final;
+
+        /*! \fn     size_t getUsableSize(void* memory)
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block without the header.
+         */
+        size_t getUsableSize(void* memory) final;
+
+        /*! \fn     void clear()
+         *  \brief  Deallocates all the previously allocated blocks.
+         */
+        void clear() final;
+
+        /*! \fn     size_t getLargestFreeBlock()
+         *  \return The size of the biggest free block without its header. It walks the free list
+         *          of the biggest non-empty class. Requests close to it may still fail, because
+         *          a request is rounded up to the next class.
+         */
+        size_t getLargestFreeBlock() final;
+
+        /*! \fn     size_t CheckSize(void* memory)
+         *  \brief  Check the size of the specified memory block.
+         *  \param  memory The beginning of the memory block.
+         *  \return The size of the block, header included.
+         */
+        static size_t CheckSize(void* memory);
+
+#ifdef MFG_DEBUG
+        /*! \fn     void printSizeOfBlocks()
+         *  \brief  Print a list of sizes of free blocks.
+         *          Only for debug purposes.
+         */
+        void printSizeOfBlocks();
+#endif // MFG_DEBUG
+    };
+}//mfg
+
+#endif // MFG_TLSFALLOCATOR_HPP
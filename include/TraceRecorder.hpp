@@ -0,0 +1,179 @@
+/*! \file   TraceRecorder.hpp
+ *  \brief  Records the calls of allocators into a binary trace file.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_TRACERECORDER_HPP
+#define MFG_TRACERECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \namespace  mfg
+namespace mfg {
+    class Allocator;
+    class ThreadTraceSlots;
+
+    /*! \struct TraceEvent
+     *  \brief  One call of an allocator. A trace file is a TraceHeader followed by events.
+     *          The events of different threads are not in order in the file, only their timestamps are.
+     */
+    struct TraceEvent {
+        enum Type : uint8_t {
+            ATTACH = 0,         //the allocator starts to be traced, value is its size, id its memory
+            ALLOCATE = 1,       //value is the requested size, id the address, or 0 if it failed
+            DEALLOCATE = 2,     //id is the address
+            MARKER = 3,         //a marker of a stack has been handed out, value is the marker
+            DEALLOCATE_TO = 4,  //a stack rolled back to the marker in value
+            BEGIN_FRAME = 5,    //a FrameAllocator switched frames
+            CLEAR = 6           //everything has been deallocated
+        };
+
+        enum Flag : uint8_t {
+            TOP = 1,    //the event belongs to the upper stack of a DoubleEndedStackAllocator
+            FAILED = 2  //the allocation returned nullptr
+        };
+
+        uint64_t timestamp;     //nanoseconds since the recorder has been created
+        uint64_t id;            //address of the block
+        uint64_t value;         //size or marker, the markers of upper stacks are counted from the end
+        uint16_t thread;        //thread of the call, numbered from 1 in order of their first event
+        uint16_t allocator;     //index of the allocator in the trace
+        uint8_t type;           //one of Type
+        uint8_t flags;          //Flag bits
+        uint8_t alignment;      //log2 of the alignment plus one, or 0 if it has not been given
+        uint8_t reserved;
+    };
+
+    /*! \struct TraceHeader
+     *  \brief  The beginning of a trace file.
+     */
+    struct TraceHeader {
+        char magic[8];          //"MFGTRACE"
+        uint32_t version;       //VERSION
+        uint32_t eventSize;     //sizeof(TraceEvent)
+
+        enum : uint32_t {
+            VERSION = 1
+        };
+    };
+
+    /*! \class  TraceRecorder
+     *  \brief  Streams the events of the allocators traced by it into a file.
+     *          Every thread writes its events into its own buffer without locks.
+     *          A full buffer is pushed onto a lock-free list, and a background
+     *          thread writes it to the file.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class TraceRecorder {
+        friend class ThreadTraceSlots;
+    public:
+        enum : size_t {
+            BUFFER_SIZE = 4096 //events in the buffer of a thread
+        };
+    private:
+        struct Buffer {
+            Buffer* next;   //next full buffer
+            size_t count;   //number of events
+            TraceEvent events[BUFFER_SIZE];
+        };
+
+        struct Slot { //the buffer of one thread
+            Buffer* buffer;
+            bool orphan; //its thread has exited, can be reused by a new thread
+        };
+
+        FILE* mFile; //the trace
+        std::atomic<Buffer*> mFull; //full buffers waiting for the writer, the newest first
+        std::mutex mWriteMutex; //serializes the writes to the file
+        std::mutex mMutex; //guards mSlots
+        std::vector<Slot*> mSlots; //buffers of all threads
+        std::atomic<bool> mRunning; //the writer thread runs
+        std::thread mWriter; //writes the full buffers
+        std::atomic<uint16_t> mNextAllocator; //index of the next traced allocator
+        std::atomic<uint64_t> mNumOfEvents; //events written to the file
+        std::chrono::steady_clock::time_point mStart; //time of the zero timestamp
+        uint64_t mId; //identifies this recorder in the thread slots
+
+        Slot* getSlot();
+        Slot* createSlot();
+        void push(Buffer* buffer);
+        void releaseSlot(Slot* slot);
+        bool write();
+    public:
+        /*! \fn     TraceRecorder(const char* path)
+         *  \brief  Constructor. Creates the trace file and starts the writer thread.
+         *  \param  path Path of the trace file, it is overwritten.
+         */
+        explicit TraceRecorder(const char* path);
+
+        TraceRecorder(const TraceRecorder& other) = delete;
+        TraceRecorder& operator=(const TraceRecorder& other) = delete;
+        TraceRecorder(TraceRecorder&& other) = delete;
+        TraceRecorder& operator=(TraceRecorder&& other) = delete;
+
+        /*! \fn     ~TraceRecorder()
+         *  \brief  Destructor. Writes every event and closes the file.
+         *          The allocators have to stop tracing before.
+         */
+        ~TraceRecorder();
+
+        /*! \fn     bool isOpen() const
+         *  \return False if the file could not be created.
+         */
+        bool isOpen() const;
+
+        /*! \fn     uint16_t attach(const Allocator* allocator, const size_t& size, void* memory)
+         *  \brief  Gives an index to an allocator, and records an ATTACH event.
+         *  \param  allocator
+         *  \param  size The size of its memory.
+         *  \param  memory The beginning of its memory.
+         *  \return The index of the allocator in the trace.
+         */
+        uint16_t attach(const Allocator* allocator, const size_t& size, void* memory);
+
+        /*! \fn     void record(const uint16_t& allocator, const uint8_t& type, const uint64_t& id, const uint64_t& value, const uint8_t& flags = 0, const size_t& alignment = 0)
+         *  \brief  Records an event into the buffer of the calling thread.
+         *  \param  allocator Index given by attach().
+         *  \param  type One of TraceEvent::Type.
+         *  \param  id Address of the block.
+         *  \param  value Size or marker.
+         *  \param  flags TraceEvent::Flag bits.
+         *  \param  alignment The alignment, or 0 if it has not been given.
+         */
+        void record(const uint16_t& allocator, const uint8_t& type, const uint64_t& id, const uint64_t& value, const uint8_t& flags = 0, const size_t& alignment = 0);
+
+        /*! \fn     void flush()
+         *  \brief  Writes every recorded event to the file. No thread may record meanwhile.
+         */
+        void flush();
+
+        /*! \fn     uint64_t getNumberOfEvents() const
+         *  \return The number of events written to the file.
+         */
+        uint64_t getNumberOfEvents() const;
+    };
+}//mfg
+
+#endif // MFG_TRACERECORDER_HPP
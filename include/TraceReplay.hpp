@@ -0,0 +1,186 @@
+/*! \file   TraceReplay.hpp
+ *  \brief  Replays a trace written by TraceRecorder against an allocator.
+ */
+
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MFG_TRACEREPLAY_HPP
+#define MFG_TRACEREPLAY_HPP
+
+#include <vector>
+
+#include "Allocator.hpp"
+
+//! \namespace  mfg
+namespace mfg {
+    /*! \struct ReplaySample
+     *  \brief  The state of the allocator at one point of a replay.
+     */
+    struct ReplaySample {
+        uint64_t operation;         //number of operations replayed before it
+        uint64_t timestamp;         //time of the operation in the trace, in nanoseconds
+        size_t live;                //requested bytes in use
+        size_t used;                //memory taken by them in the allocator
+        size_t largestFreeBlock;    //see Allocator::getLargestFreeBlock()
+        double fragmentation;       //1 - largestFreeBlock / free memory, or -1 if the allocator can not tell
+    };
+
+    /*! \class  TraceReplay
+     *  \brief  Loads the events of one allocator from a trace, and replays them in the
+     *          order of their timestamps on one thread. The events are compiled first,
+     *          so the timed loop only indexes arrays: every address becomes a slot,
+     *          and every rollback of a stack the list of allocations it releases.
+     *          A target which can deallocate gets each released block back, a
+     *          StackAllocator target gets its own markers back instead. Frames and upper
+     *          stacks can not be rolled back on a StackAllocator, they are freed by clear only.
+     *          Copy and move constructors and assignments are unavailable.
+     */
+    class TraceReplay {
+    private:
+        enum : uint32_t {
+            NO_MARKER = 0xFFFFFFFF //the rollback goes to the beginning of the stack
+        };
+
+        struct Operation {
+            uint8_t type;       //TraceEvent::Type
+            uint8_t flags;      //TraceEvent::Flag bits
+            uint8_t alignment;  //as in TraceEvent
+            uint32_t index;     //slot of the block, or index of the marker
+            uint32_t count;     //number of released blocks
+            uint64_t value;     //requested size, or the first of the released blocks in mReleases
+            uint64_t timestamp; //time of the event
+        };
+
+        std::vector<Operation> mOperations; //the compiled trace
+        std::vector<uint32_t> mReleases; //slots released by the rollbacks, in the order of allocation
+        size_t mNumOfSlots; //blocks in use at once at most
+        size_t mNumOfMarkers; //markers handed out
+        size_t mArenaSize; //size of the traced allocator
+        size_t mLargestRequest; //biggest size allocated in the trace
+        size_t mNumOfAllocators; //allocators in the trace
+        uint64_t mSkipped; //deallocations of unknown blocks, they are left out
+        bool mSingleStack; //there are no frames and upper stacks, so a StackAllocator can roll back
+        bool mLoaded; //the trace has been read
+
+        std::vector<ReplaySample> mSamples;
+        uint64_t mElapsed; //nanoseconds spent in the allocator
+        uint64_t mFailures; //allocations which failed in the replay only
+        uint64_t mTraceFailures; //allocations which failed in the trace
+        uint64_t mRecovered; //allocations which failed in the trace, but not in the replay
+        size_t mPeakLive; //the most requested bytes in use
+        size_t mPeakUsed; //high-water mark of the allocator
+        double mPeakFragmentation; //the highest one of the samples
+
+        void compile(const std::vector<TraceEvent>& events);
+        void sample(Allocator& allocator, const uint64_t& operation, const size_t& live);
+    public:
+        /*! \fn     TraceReplay(const char* path, const uint16_t& allocator = 0)
+         *  \brief  Constructor. Reads and compiles the trace.
+         *  \param  path Path of the trace file.
+         *  \param  allocator Index of the allocator in the trace.
+         */
+        explicit TraceReplay(const char* path, const uint16_t& allocator = 0);
+
+        TraceReplay(const TraceReplay& other) = delete;
+        TraceReplay& operator=(const TraceReplay& other) = delete;
+        TraceReplay(TraceReplay&& other) = delete;
+        TraceReplay& operator=(TraceReplay&& other) = delete;
+
+        /*! \fn     bool isLoaded() const
+         *  \return False if the file could not be read or it is not a trace.
+         */
+        bool isLoaded() const;
+
+        /*! \fn     bool run(Allocator& allocator, const size_t& sampleInterval = 4096)
+         *  \brief  Replays the trace. It switches on the statistics of the allocator, and
+         *          it leaves every block of the trace which has not been deallocated in it.
+         *  \param  allocator It has to be empty.
+         *  \param  sampleInterval A sample is taken after every sampleInterval operations and at the end.
+         *          Sampling is not timed.
+         *  \return False if the trace has not been loaded.
+         */
+        bool run(Allocator& allocator, const size_t& sampleInterval = 4096);
+
+        /*! \fn     const std::vector<ReplaySample>& getSamples() const
+         *  \return The samples of the last run.
+         */
+        const std::vector<ReplaySample>& getSamples() const;
+
+        /*! \fn     size_t getNumberOfOperations() const
+         *  \return The number of operations in the compiled trace.
+         */
+        size_t getNumberOfOperations() const;
+
+        /*! \fn     size_t getArenaSize() const
+         *  \return The size of the memory of the traced allocator, or 0 if its ATTACH event is missing.
+         */
+        size_t getArenaSize() const;
+
+        /*! \fn     size_t getLargestRequest() const
+         *  \return The biggest size allocated successfully in the trace.
+         */
+        size_t getLargestRequest() const;
+
+        /*! \fn     size_t getNumberOfAllocators() const
+         *  \return The number of allocators in the trace.
+         */
+        size_t getNumberOfAllocators() const;
+
+        /*! \fn     uint64_t getSkipped() const
+         *  \return The number of deallocations left out, because their blocks had been allocated before the trace.
+         */
+        uint64_t getSkipped() const;
+
+        /*! \fn     uint64_t getElapsed() const
+         *  \return Nanoseconds spent in the allocator during the last run.
+         */
+        uint64_t getElapsed() const;
+
+        /*! \fn     uint64_t getFailures() const
+         *  \return The number of allocations which failed in the last run, but not in the trace.
+         */
+        uint64_t getFailures() const;
+
+        /*! \fn     uint64_t getTraceFailures() const
+         *  \return The number of allocations which failed in the trace.
+         */
+        uint64_t getTraceFailures() const;
+
+        /*! \fn     uint64_t getRecovered() const
+         *  \return The number of allocations which failed in the trace, but not in the last run.
+         */
+        uint64_t getRecovered() const;
+
+        /*! \fn     size_t getPeakLive() const
+         *  \return The most requested bytes in use at once during the last run.
+         */
+        size_t getPeakLive() const;
+
+        /*! \fn     size_t getPeakUsed() const
+         *  \return The most memory used at once during the last run, by the statistics of the allocator.
+         */
+        size_t getPeakUsed() const;
+
+        /*! \fn     double getPeakFragmentation() const
+         *  \return The highest fragmentation in the samples of the last run, or -1 if the allocator can not tell.
+         */
+        double getPeakFragmentation() const;
+    };
+}//mfg
+
+#endif // MFG_TRACEREPLAY_HPP
@@ -26,7 +26,7 @@ namespace mfg {
 #ifdef MFG_ASSERTION
     #define debugBreak() asm("mov $60, %eax"); asm("xor %edi, %edi"); asm("syscall")
 
-    void ReportAssert(char *exp, char *file, char *baseFile, int line);
+    void ReportAssert(const char *exp, const char *file, const char *baseFile, int line);
 
     #define ASSERT(expression) \
         if (expression); \
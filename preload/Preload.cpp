@@ -0,0 +1,497 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Replaces malloc, free, calloc, realloc, the aligned allocations and the global operator new and delete
+of a process with an mfg allocator:
+    LD_PRELOAD=build/preload/libmfg_preload.so program
+MFG_PRELOAD         slab (default) serves the requests up to 1 KiB with a SlabAllocator, and the bigger ones
+                    (and the small ones when the slabs run out) with a TlsfAllocator. tlsf serves every
+                    request with the TlsfAllocator, system passes every request to the system heap.
+MFG_PRELOAD_SIZE    Size of the memory in MiB, 1024 by default. It is only reserved, pages are used when
+                    touched. The slabs get a quarter of it.
+MFG_PRELOAD_REPORT  If set, the statistics of the allocators are printed to stderr at exit.
+The slabs and the TLSF allocator have a lock each, so every small request of every thread waits for the same
+lock: the shim is meant to measure the allocators in unmodified programs, it does not scale with threads like a
+malloc with thread caches. It is built without MFG_ASSERTION, a request an allocator can not serve goes on.
+Requests which do not fit into the memory, and the ones made before the allocator is ready, are served by
+the system heap. Every pointer outside the memory of the allocator is given back to the system heap.
+fork() takes the locks of the allocators first, so the child never inherits one locked by another thread.
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <malloc.h>
+#include <mutex>
+#include <new>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "SlabAllocator.hpp"
+#include "TlsfAllocator.hpp"
+
+extern "C" { //the system heap, glibc exports it under these names as well
+    void* __libc_malloc(size_t size);
+    void __libc_free(void* memory);
+    void* __libc_realloc(void* memory, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace mfg {
+    namespace {
+        enum : size_t {
+            MALLOC_ALIGNMENT = alignof(max_align_t), //what malloc promises
+            SMALL_SIZE = 1024, //the biggest request of the slabs
+            SLAB_BLOCK_SIZE = (size_t) 1 << 20, //memory of the SlabAllocator for its own big requests, only used when the slabs run out
+            DEFAULT_SIZE = (size_t) 1024 << 20,
+            MIN_SIZE = (size_t) 16 << 20
+        };
+
+        enum : int {
+            UNINITIALIZED,
+            INITIALIZING, //the first request builds the allocators, the others go to the system heap meanwhile
+            READY,
+            DISABLED
+        };
+
+        /*  Sends the small requests to the small allocator, the rest and the ones it can not serve to
+         *  the large one. The allocators are not thread safe, so every call takes the lock of the one
+         *  it goes to, a small and a large request can be served at once.
+         *  It is registered as the default allocator, the program can use it directly.
+         */
+        class SharedAllocator final : public Allocator {
+        private:
+            Allocator* mSmall; //serves the requests up to SMALL_SIZE, or nullptr
+            Allocator* mLarge; //serves the rest
+            std::mutex mSmallMutex; //guards mSmall
+            std::mutex mLargeMutex; //guards mLarge
+
+            bool isSmall(void* memory) {
+                return mSmall != nullptr && (uintptr_t) memory - (uintptr_t) mSmall->getMemory() < mSmall->getSize();
+            }
+        public:
+            SharedAllocator(Allocator* small, Allocator* large, void* memory, const size_t& size) :
+                Allocator(memory, size, false),
+                mSmall(small),
+                mLarge(large)
+            {}
+
+            void* allocate(const size_t& size) final { return allocate(size, MALLOC_ALIGNMENT); }
+
+            void* allocate(const size_t& size, const size_t& alignment) final {
+                size_t newAlignment = alignment > MALLOC_ALIGNMENT ? alignment : (size_t) MALLOC_ALIGNMENT;
+                if(mSmall != nullptr && size <= SMALL_SIZE) {
+                    std::lock_guard<std::mutex> lock(mSmallMutex);
+                    void* memory = mSmall->allocate(size, newAlignment);
+                    if(memory != nullptr) {
+                        return memory;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mLargeMutex);
+                return mLarge->allocate(size, newAlignment);
+            }
+
+            void deallocate(void* memory) final {
+                if(isSmall(memory)) {
+                    std::lock_guard<std::mutex> lock(mSmallMutex);
+                    mSmall->deallocate(memory);
+                }
+                else {
+                    std::lock_guard<std::mutex> lock(mLargeMutex);
+                    mLarge->deallocate(memory);
+                }
+            }
+
+            size_t getUsableSize(void* memory) final {
+                if(isSmall(memory)) {
+                    std::lock_guard<std::mutex> lock(mSmallMutex);
+                    return mSmall->getUsableSize(memory);
+                }
+
+                std::lock_guard<std::mutex> lock(mLargeMutex);
+                return mLarge->getUsableSize(memory);
+            }
+
+            void clear() final { ASSERT(false); } //the process still holds the memory
+
+            size_t getLargestFreeBlock() final {
+                std::lock_guard<std::mutex> lock(mLargeMutex);
+                return mLarge->getLargestFreeBlock();
+            }
+
+            /*  Takes the locks before fork(), so no other thread is inside the allocators when
+             *  the process is copied, and the child gets consistent ones.
+             */
+            void lockForFork() {
+                mSmallMutex.lock();
+                mLargeMutex.lock();
+            }
+
+            void unlockAfterFork() {
+                mLargeMutex.unlock();
+                mSmallMutex.unlock();
+            }
+
+            //the child has only the forking thread, the locks are built again instead of unlocked
+            void resetAfterFork() {
+                new (&mSmallMutex) std::mutex();
+                new (&mLargeMutex) std::mutex();
+            }
+        };
+
+        //never destroyed, free() is called after the static destructors as well
+        alignas(SlabAllocator) char sSlabStorage[sizeof(SlabAllocator)];
+        alignas(TlsfAllocator) char sTlsfStorage[sizeof(TlsfAllocator)];
+        alignas(SharedAllocator) char sSharedStorage[sizeof(SharedAllocator)];
+
+        std::atomic<int> sState(UNINITIALIZED);
+        SlabAllocator* sSlab = nullptr; //the small allocator, or nullptr
+        TlsfAllocator* sTlsf = nullptr; //the large allocator
+        SharedAllocator* sShared = nullptr; //the allocators behind the lock
+        uintptr_t sBegin = 0; //memory of the allocators
+        size_t sSize = 0;
+
+        //set while the thread is inside the shim, the nested requests (of the hooks of the allocators,
+        //or of the initialization) go to the system heap; initial-exec, so reading it never allocates
+        __attribute__((tls_model("initial-exec"))) thread_local bool tInside = false;
+
+        std::atomic<size_t (*)(void*)> sSystemUsableSize(nullptr); //malloc_usable_size of the system heap
+
+        void report(const char* name, Allocator* allocator) {
+            StatisticsSnapshot snapshot;
+            if(allocator == nullptr || !allocator->snapshotStatistics(snapshot)) {
+                return;
+            }
+
+            fprintf(stderr, "mfg_preload %s: %llu allocations, %llu deallocations, %llu failed, %zu live, %zu bytes used, %zu bytes at most\n",
+                name, (unsigned long long) snapshot.totalAllocations, (unsigned long long) snapshot.totalDeallocations,
+                (unsigned long long) snapshot.failedAllocations, snapshot.numOfAllocations, snapshot.usedSize, snapshot.highWaterMark);
+        }
+
+        void reportAll() {
+            report("slab", sSlab);
+            report("tlsf", sTlsf);
+        }
+
+        //the handlers of fork(), the requests of the other handlers go to the system heap meanwhile
+        bool sLockedForFork = false; //written only by the forking thread
+
+        void prepareFork() {
+            sLockedForFork = sState.load(std::memory_order_acquire) == READY;
+            if(sLockedForFork) {
+                tInside = true;
+                sShared->lockForFork();
+            }
+        }
+
+        void afterForkInParent() {
+            if(sLockedForFork) {
+                sShared->unlockAfterFork();
+                tInside = false;
+            }
+        }
+
+        void afterForkInChild() {
+            if(sLockedForFork) {
+                sShared->resetAfterFork();
+                tInside = false;
+            }
+        }
+
+        void initialize() {
+            int state = UNINITIALIZED;
+            if(!sState.compare_exchange_strong(state, INITIALIZING, std::memory_order_acquire)) {
+                return;
+            }
+
+            tInside = true;
+
+            const char* name = getenv("MFG_PRELOAD");
+            const char* sizeText = getenv("MFG_PRELOAD_SIZE");
+            size_t size = sizeText != nullptr ? (size_t) strtoull(sizeText, nullptr, 10) << 20 : (size_t) DEFAULT_SIZE;
+            if(size < MIN_SIZE) {
+                size = MIN_SIZE;
+            }
+
+            void* memory = MAP_FAILED;
+            if(name == nullptr || strcmp(name, "system") != 0) {
+                memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            }
+
+            if(memory == MAP_FAILED) { //switched off, or no address space
+                tInside = false;
+                sState.store(DISABLED, std::memory_order_release);
+                return;
+            }
+
+            size_t slabSize = 0;
+            if(name == nullptr || strcmp(name, "tlsf") != 0) {
+                slabSize = size / 4;
+                sSlab = new (sSlabStorage) SlabAllocator(memory, slabSize, SLAB_BLOCK_SIZE);
+            }
+
+            sTlsf = new (sTlsfStorage) TlsfAllocator(memory + slabSize, size - slabSize, false); //the pages are zero
+            sShared = new (sSharedStorage) SharedAllocator(sSlab, sTlsf, memory, size);
+
+            if(getenv("MFG_PRELOAD_REPORT") != nullptr) {
+                if(sSlab != nullptr) {
+                    sSlab->enableStatistics("preload slab");
+                }
+                sTlsf->enableStatistics("preload tlsf");
+                atexit(reportAll);
+            }
+
+            sBegin = (uintptr_t) memory;
+            sSize = size;
+            SetDefaultAllocator(sShared);
+            pthread_atfork(prepareFork, afterForkInParent, afterForkInChild);
+
+            tInside = false;
+            sState.store(READY, std::memory_order_release);
+        }
+
+        bool isReady() {
+            if(sState.load(std::memory_order_acquire) == UNINITIALIZED) {
+                initialize();
+            }
+
+            return sState.load(std::memory_order_acquire) == READY;
+        }
+
+        bool owns(void* memory) {
+            return sState.load(std::memory_order_acquire) == READY && (uintptr_t) memory - sBegin < sSize;
+        }
+
+        void* allocateMemory(size_t size, const size_t& alignment) {
+            if(size == 0) { //malloc(0) returns a unique pointer
+                size = 1;
+            }
+
+            if(!tInside && isReady()) {
+                tInside = true;
+                void* memory = sShared->allocate(size, alignment);
+                tInside = false;
+
+                if(memory != nullptr) {
+                    return memory;
+                }
+            }
+
+            //not ready yet, nested, or the memory of the allocator is full
+            return alignment <= MALLOC_ALIGNMENT ? __libc_malloc(size) : __libc_memalign(alignment, size);
+        }
+
+        void freeMemory(void* memory) {
+            if(memory == nullptr) {
+                return;
+            }
+
+            if(!owns(memory)) { //allocated by the system heap
+                __libc_free(memory);
+                return;
+            }
+
+            if(tInside) { //a hook of the allocator frees the memory of the program, a lock may be taken: it is leaked
+                return;
+            }
+
+            tInside = true;
+            sShared->deallocate(memory);
+            tInside = false;
+        }
+
+        size_t usableSize(void* memory) {
+            if(memory == nullptr) {
+                return 0;
+            }
+
+            if(!owns(memory)) {
+                size_t (*systemUsableSize)(void*) = sSystemUsableSize.load(std::memory_order_acquire);
+                if(systemUsableSize == nullptr) {
+                    bool inside = tInside;
+                    tInside = true; //dlsym may allocate
+                    systemUsableSize = (size_t (*)(void*)) dlsym(RTLD_NEXT, "malloc_usable_size");
+                    tInside = inside;
+                    sSystemUsableSize.store(systemUsableSize, std::memory_order_release);
+                }
+
+                return systemUsableSize != nullptr ? systemUsableSize(memory) : 0;
+            }
+
+            if(tInside) {
+                return 0;
+            }
+
+            tInside = true;
+            size_t size = sShared->getUsableSize(memory);
+            tInside = false;
+            return size;
+        }
+
+        void* reallocateMemory(void* memory, const size_t& size) {
+            if(memory == nullptr) {
+                return allocateMemory(size, MALLOC_ALIGNMENT);
+            }
+
+            if(!owns(memory)) {
+                return __libc_realloc(memory, size);
+            }
+
+            if(size == 0) {
+                freeMemory(memory);
+                return nullptr;
+            }
+
+            size_t oldSize = usableSize(memory);
+            if(size <= oldSize) { //the rest of the block is wasted until it is freed
+                return memory;
+            }
+
+            void* newMemory = allocateMemory(size, MALLOC_ALIGNMENT);
+            if(newMemory == nullptr) {
+                return nullptr;
+            }
+
+            memcpy(newMemory, memory, oldSize);
+            freeMemory(memory);
+            return newMemory;
+        }
+
+        bool isPowerOfTwo(const size_t& value) { return value != 0 && (value & (value - 1)) == 0; }
+
+        void* allocateOrThrow(const size_t& size, const size_t& alignment) {
+            for(;;) {
+                void* memory = allocateMemory(size, alignment);
+                if(memory != nullptr) {
+                    return memory;
+                }
+
+                std::new_handler handler = std::get_new_handler();
+                if(handler == nullptr) {
+                    throw std::bad_alloc();
+                }
+
+                handler();
+            }
+        }
+
+        void* allocateOrNull(const size_t& size, const size_t& alignment) noexcept {
+            try {
+                return allocateOrThrow(size, alignment);
+            }
+            catch(...) {
+                return nullptr;
+            }
+        }
+    }
+}//mfg
+
+extern "C" {
+    void* malloc(size_t size) noexcept {
+        void* memory = mfg::allocateMemory(size, mfg::MALLOC_ALIGNMENT);
+        if(memory == nullptr) {
+            errno = ENOMEM;
+        }
+
+        return memory;
+    }
+
+    void free(void* memory) noexcept { mfg::freeMemory(memory); }
+
+    void* calloc(size_t count, size_t size) noexcept {
+        size_t total;
+        if(__builtin_mul_overflow(count, size, &total)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        void* memory = malloc(total);
+        if(memory != nullptr) { //a freed block is not zero, neither is the fallback of the system heap
+            memset(memory, 0, total);
+        }
+
+        return memory;
+    }
+
+    void* realloc(void* memory, size_t size) noexcept {
+        void* newMemory = mfg::reallocateMemory(memory, size);
+        if(newMemory == nullptr && size > 0) {
+            errno = ENOMEM;
+        }
+
+        return newMemory;
+    }
+
+    int posix_memalign(void** memory, size_t alignment, size_t size) noexcept {
+        if(!mfg::isPowerOfTwo(alignment) || alignment % sizeof(void*) != 0) {
+            return EINVAL;
+        }
+
+        void* newMemory = mfg::allocateMemory(size, alignment);
+        if(newMemory == nullptr) {
+            return ENOMEM;
+        }
+
+        *memory = newMemory;
+        return 0;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept {
+        if(!mfg::isPowerOfTwo(alignment)) {
+            errno = EINVAL;
+            return nullptr;
+        }
+
+        void* memory = mfg::allocateMemory(size, alignment);
+        if(memory == nullptr) {
+            errno = ENOMEM;
+        }
+
+        return memory;
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept { return aligned_alloc(alignment, size); }
+
+    size_t malloc_usable_size(void* memory) noexcept { return mfg::usableSize(memory); }
+}
+
+void* operator new(size_t size) { return mfg::allocateOrThrow(size, mfg::MALLOC_ALIGNMENT); }
+void* operator new[](size_t size) { return mfg::allocateOrThrow(size, mfg::MALLOC_ALIGNMENT); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return mfg::allocateOrNull(size, mfg::MALLOC_ALIGNMENT); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return mfg::allocateOrNull(size, mfg::MALLOC_ALIGNMENT); }
+void* operator new(size_t size, std::align_val_t alignment) { return mfg::allocateOrThrow(size, (size_t) alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return mfg::allocateOrThrow(size, (size_t) alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return mfg::allocateOrNull(size, (size_t) alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return mfg::allocateOrNull(size, (size_t) alignment); }
+
+void operator delete(void* memory) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory) noexcept { mfg::freeMemory(memory); }
+void operator delete(void* memory, size_t) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory, size_t) noexcept { mfg::freeMemory(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { mfg::freeMemory(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { mfg::freeMemory(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { mfg::freeMemory(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { mfg::freeMemory(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { mfg::freeMemory(memory); }
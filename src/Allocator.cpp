@@ -18,30 +18,135 @@ freely, subject to the following restrictions:
 #include "Allocator.hpp"
 
 namespace mfg {
-    Allocator::Allocator(void* memory, const size_t& size) :
+    namespace {
+        std::atomic<Allocator*> sDefaultAllocator(nullptr); //constant initialized, usable before the static constructors
+    }
+
+    Allocator* GetDefaultAllocator() { return sDefaultAllocator.load(std::memory_order_acquire); }
+
+    Allocator* SetDefaultAllocator(Allocator* allocator) { return sDefaultAllocator.exchange(allocator, std::memory_order_acq_rel); }
+
+    Allocator::Allocator(void* memory, const size_t& size, const bool& zeroMemory) :
         mMemory(memory),
-        mSize(size)
+        mSize(size),
+        mStatistics(nullptr),
+        mStatisticsStorage(nullptr),
+        mRecorder(nullptr),
+        mTraceIndex(0),
+        mProfiler(nullptr)
     {
         ASSERT(size > 0);
 
-        memset(mMemory, 0, mSize);
+        if(zeroMemory) {
+            memset(mMemory, 0, mSize);
+        }
 
 #ifdef MFG_MEMORY_REPORT
-        mMrUsed = 0;
-        mMrNumOfAllocations = 0;
+        enableStatistics();
 #endif
+    }
+
+    Allocator::~Allocator() {
+        if(mStatisticsStorage != nullptr) {
+            Statistics::Unregister(this);
+            delete mStatisticsStorage;
+        }
+    }
+
+    void* Allocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        size_t usableSize = getUsableSize(memory);
+        ASSERT(usableSize > 0); //the allocator can not resize
 
+        if(usableSize == 0) {
+            return nullptr;
+        }
+
+        if(size <= usableSize) {
+            return memory;
+        }
+
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        memcpy(newMemory, memory, usableSize);
+        deallocate(memory);
+        return newMemory;
     }
 
-    Allocator::~Allocator() {}
+    size_t Allocator::getUsableSize(void* memory) { return 0; }
 
+    bool Allocator::canDeallocate() const { return true; }
     bool Allocator::isOutOfMemory() { return mMemory == nullptr; }
     void* Allocator::getMemory() { return mMemory; }
     size_t Allocator::getSize() { return mSize; }
 
-#ifdef MFG_MEMORY_REPORT
-    size_t Allocator::getUsedSize() { return mMrUsed; }
-    size_t Allocator::getNumberOfAllocations() { return mMrNumOfAllocations; }
-#endif
+    void Allocator::enableStatistics(const char* name) {
+        if(mStatisticsStorage == nullptr) {
+            mStatisticsStorage = new Statistics(name);
+        }
+        else {
+            mStatisticsStorage->setName(name);
+        }
+
+        mStatistics.store(mStatisticsStorage, std::memory_order_release);
+        Statistics::Register(this);
+    }
+
+    void Allocator::disableStatistics() {
+        mStatistics.store(nullptr, std::memory_order_release);
+        Statistics::Unregister(this);
+    }
+
+    bool Allocator::isStatisticsEnabled() const { return getStatistics() != nullptr; }
+
+    bool Allocator::snapshotStatistics(StatisticsSnapshot& snapshot) const {
+        Statistics* statistics = getStatistics();
+        if(statistics == nullptr) {
+            return false;
+        }
+
+        statistics->snapshot(snapshot);
+        snapshot.allocator = this;
+        return true;
+    }
+
+    size_t Allocator::getUsedSize() {
+        Statistics* statistics = getStatistics();
+        return statistics != nullptr ? statistics->getUsedSize() : 0;
+    }
+
+    size_t Allocator::getNumberOfAllocations() {
+        Statistics* statistics = getStatistics();
+        return statistics != nullptr ? statistics->getNumberOfAllocations() : 0;
+    }
+
+    size_t Allocator::getLargestFreeBlock() { return 0; }
+
+    void Allocator::startTrace(TraceRecorder* recorder) {
+        if(recorder != nullptr) {
+            mTraceIndex = recorder->attach(this, mSize, mMemory);
+        }
+
+        mRecorder.store(recorder, std::memory_order_release);
+    }
+
+    void Allocator::stopTrace() { mRecorder.store(nullptr, std::memory_order_release); }
+
+    void Allocator::startProfile(HeapProfiler* profiler) {
+        mProfiler.store(profiler, std::memory_order_release);
+    }
+
+    void Allocator::stopProfile() {
+        HeapProfiler* profiler = mProfiler.exchange(nullptr, std::memory_order_acq_rel);
+        if(profiler != nullptr) {
+            profiler->recordClear(this);
+        }
+    }
 
 }//mfg
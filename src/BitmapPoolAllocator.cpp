@@ -0,0 +1,202 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BitmapPoolAllocator.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace mfg {
+    namespace {
+        const size_t NO_WORD = ~(size_t) 0;
+
+        inline size_t wordsFor(const size_t& bits) { return (bits + 63) / 64; }
+
+        //offset of the first block from the memory
+        inline size_t headerSize(void* memory, const size_t& numOfBlocks, const size_t& alignment) {
+            size_t words = wordsFor(numOfBlocks);
+            uintptr_t end = (uintptr_t) memory + (words + wordsFor(words)) * sizeof(uint64_t);
+            return ((end + alignment - 1) & ~(uintptr_t) (alignment - 1)) - (uintptr_t) memory;
+        }
+    }
+
+    BitmapPoolAllocator::BitmapPoolAllocator(void* memory, const size_t& size, const size_t& blockSize) :
+        Allocator(memory, size, false),
+        mBlockSize(blockSize),
+        mBlockShift((blockSize & (blockSize - 1)) == 0 ? __builtin_ctzll(blockSize) : NO_SHIFT)
+    {
+        ASSERT(blockSize > 0);
+        ASSERT(((uintptr_t) memory & (sizeof(uint64_t) - 1)) == 0);
+
+        mNumOfBlocks = size * 8 / (blockSize * 8 + 1);
+        while(mNumOfBlocks > 0 && headerSize(memory, mNumOfBlocks, BLOCK_ALIGNMENT) + mNumOfBlocks * blockSize > size) {
+            mNumOfBlocks--;
+        }
+
+        ASSERT(mNumOfBlocks > 0);
+
+        mNumOfWords = wordsFor(mNumOfBlocks);
+        mNumOfSummaryWords = wordsFor(mNumOfWords);
+        mBitmap = (uint64_t*) memory;
+        mSummary = mBitmap + mNumOfWords;
+        mBlocks = memory + headerSize(memory, mNumOfBlocks, BLOCK_ALIGNMENT);
+
+        clear();
+    }
+
+    BitmapPoolAllocator::~BitmapPoolAllocator() {}
+
+    size_t BitmapPoolAllocator::blockIndex(const void* memory) const {
+        size_t offset = (uintptr_t) memory - (uintptr_t) mBlocks;
+        return mBlockShift != NO_SHIFT ? offset >> mBlockShift : offset / mBlockSize;
+    }
+
+    size_t BitmapPoolAllocator::findFreeWord() {
+        size_t summary = mHint;
+
+#ifdef __SSE2__
+        const __m128i full = _mm_set1_epi32(-1);
+        while(summary + 2 <= mNumOfSummaryWords) { //two full summary words at once
+            __m128i words = _mm_loadu_si128((const __m128i*) (mSummary + summary));
+            if(_mm_movemask_epi8(_mm_cmpeq_epi32(words, full)) != 0xFFFF) {
+                break;
+            }
+            summary += 2;
+        }
+#endif
+
+        for(; summary < mNumOfSummaryWords; summary++) {
+            if(mSummary[summary] != ~(uint64_t) 0) {
+                mHint = summary;
+                return summary * 64 + __builtin_ctzll(~mSummary[summary]);
+            }
+        }
+
+        mHint = mNumOfSummaryWords;
+        return NO_WORD;
+    }
+
+    void* BitmapPoolAllocator::takeBlock(const size_t& word, const size_t& bit) {
+        mBitmap[word] |= (uint64_t) 1 << bit;
+        if(mBitmap[word] == ~(uint64_t) 0) {
+            mSummary[word / 64] |= (uint64_t) 1 << (word & 63);
+        }
+
+        return mBlocks + (word * 64 + bit) * mBlockSize;
+    }
+
+    void* BitmapPoolAllocator::allocate(const size_t& size) {
+        ASSERT(size <= mBlockSize);
+
+        size_t word = findFreeWord();
+        if(word == NO_WORD) { //every block is in use
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        void* memory = takeBlock(word, __builtin_ctzll(~mBitmap[word]));
+        onAllocate(memory, size, mBlockSize);
+        return memory;
+    }
+
+    void* BitmapPoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size <= mBlockSize);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if((((uintptr_t) mBlocks | mBlockSize) & (alignment - 1)) == 0) { //every block is aligned
+            return allocate(size);
+        }
+
+        for(size_t word = mHint * 64; word < mNumOfWords; word++) {
+            uint64_t free = ~mBitmap[word];
+            while(free != 0) {
+                size_t bit = __builtin_ctzll(free);
+                free &= free - 1;
+
+                if(((uintptr_t) mBlocks + (word * 64 + bit) * mBlockSize) & (alignment - 1)) {
+                    continue;
+                }
+
+                void* memory = takeBlock(word, bit);
+                onAllocate(memory, size, mBlockSize, alignment);
+                return memory;
+            }
+        }
+
+        onFailedAllocation(size, alignment);
+        return nullptr;
+    }
+
+    void BitmapPoolAllocator::deallocate(void* memory) {
+        size_t index = blockIndex(memory);
+        size_t word = index / 64;
+        uint64_t bit = (uint64_t) 1 << (index & 63);
+
+        ASSERT(index < mNumOfBlocks && memory == mBlocks + index * mBlockSize);
+        ASSERT(mBitmap[word] & bit);
+
+        onDeallocate(memory, mBlockSize);
+
+        mBitmap[word] &= ~bit;
+        mSummary[word / 64] &= ~((uint64_t) 1 << (word & 63));
+        if(word / 64 < mHint) {
+            mHint = word / 64;
+        }
+    }
+
+    size_t BitmapPoolAllocator::getUsableSize(void* memory) { return mBlockSize; }
+
+    void BitmapPoolAllocator::clear() {
+        memset(mBitmap, 0, (mNumOfWords + mNumOfSummaryWords) * sizeof(uint64_t));
+
+        if((mNumOfBlocks & 63) != 0) { //the bits after the last block are never free
+            mBitmap[mNumOfWords - 1] = ~(uint64_t) 0 << (mNumOfBlocks & 63);
+        }
+
+        if((mNumOfWords & 63) != 0) { //the words after the last word are never free
+            mSummary[mNumOfSummaryWords - 1] = ~(uint64_t) 0 << (mNumOfWords & 63);
+        }
+
+        mHint = 0;
+
+        onClear();
+    }
+
+    size_t BitmapPoolAllocator::getLargestFreeBlock() {
+        for(size_t summary = mHint; summary < mNumOfSummaryWords; summary++) {
+            if(mSummary[summary] != ~(uint64_t) 0) {
+                return mBlockSize;
+            }
+        }
+
+        return 0;
+    }
+
+    bool BitmapPoolAllocator::isAllocated(const void* memory) const {
+        if((uintptr_t) memory - (uintptr_t) mBlocks >= mNumOfBlocks * mBlockSize) {
+            return false;
+        }
+
+        size_t index = blockIndex(memory);
+        return (mBitmap[index / 64] >> (index & 63)) & 1;
+    }
+
+    const size_t& BitmapPoolAllocator::getBlockSize() const { return mBlockSize; }
+
+    const size_t& BitmapPoolAllocator::getNumberOfBlocks() const { return mNumOfBlocks; }
+}//mfg
@@ -19,145 +19,136 @@ freely, subject to the following restrictions:
 
 namespace mfg {
     BlockAllocator::BlockAllocator(void* memory, const size_t& size) :
-        Allocator(memory, size)
-    {
-        ASSERT(size > sizeof(Block));
-
-        mBlocks = (Block*) mMemory;
-        mBlocks->size = mSize;
-        mBlocks->next = nullptr;
-    }
+        Allocator(memory, size),
+        mPolicy(memory, size)
+    {}
 
     BlockAllocator::~BlockAllocator() {}
 
     void* BlockAllocator::allocate(const size_t& size) {
-        ASSERT(size >= sizeof(Block));
-        ASSERT(mBlocks != nullptr);
-
-        size_t newSize = size + sizeof(size_t);
+        ASSERT(size > 0);
 
-        Block* bestFitPrev = nullptr;
-        Block* bestFit = mBlocks;
-        Block* block = mBlocks->next;
-        Block* prev = mBlocks;
-
-        if(mBlocks->size < newSize && (mBlocks->size - newSize < sizeof(Block) || mBlocks->size - newSize != 0)) {
-            bestFit = mBlocks->next;
+        void* memory = mPolicy.allocate(size);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
         }
 
-        while(block != nullptr) {
-            if  (block->size >= newSize && //the block is enough
-                (block->size - newSize >= sizeof(Block) || block->size - newSize == 0) && //but if we allocate from it, its still enough to became a new block, or completly disappear
-                block->size < bestFit->size) //and its fits better.
-            {
-                bestFit = block;
-                bestFitPrev = prev;
-            }
+        onAllocate(memory, size, CheckSize(memory));
+        return memory;
+    }
 
-            prev = block;
-            block = block->next;
-        }
+    void* BlockAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
 
-        if(bestFit == nullptr) { //there is no block which fit.
+        void* memory = mPolicy.allocate(size, alignment);
+        if(memory == nullptr) { //there is no block which fit.
             ASSERT(false);
+            onFailedAllocation(size, alignment);
             return nullptr;
         }
 
-        if(bestFit->size - newSize == 0) {
-            if(bestFitPrev != nullptr) {
-                bestFitPrev->next = bestFit->next;
-            }
-            else {
-                mBlocks = mBlocks->next;
-            }
+        onAllocate(memory, size, CheckSize(memory), alignment);
+        return memory;
+    }
+
+    void BlockAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        onDeallocate(memory, CheckSize(memory));
+
+        mPolicy.deallocate(memory);
+    }
+
+    void* BlockAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
         }
-        else {
-            block = (Block*)((void*) bestFit + newSize);
-            block->size = bestFit->size - newSize;
-            block->next = bestFit->next;
 
-            if(bestFitPrev != nullptr) {
-                bestFitPrev->next = block;
-            }
-            else {
-                mBlocks = block;
-            }
+        ASSERT(size > 0);
+
+        size_t used = CheckSize(memory);
+        if(mPolicy.reallocate(memory, size)) { //recorded as a deallocation and an allocation
+            onDeallocate(memory, used);
+            onAllocate(memory, size, CheckSize(memory));
+            return memory;
         }
 
-        *((size_t*) bestFit) = newSize;
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed += newSize;
-        mMrNumOfAllocations++;
-#endif
-        return ((void*) bestFit) + sizeof(size_t);
+        memcpy(newMemory, memory, used - sizeof(size_t));
+        deallocate(memory);
+        return newMemory;
     }
 
-    void BlockAllocator::deallocate(void* memory) {
-        ASSERT(memory != nullptr);
-
-        Block* deallocBlock = (Block*) (memory - sizeof(size_t));
-        deallocBlock->next = nullptr;
+    size_t BlockAllocator::getUsableSize(void* memory) { return CheckSize(memory) - sizeof(size_t); }
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed -= deallocBlock->size;
-        mMrNumOfAllocations--;
-#endif
+    size_t BlockAllocator::allocateBatch(const size_t& size, const size_t& count, void** memory) {
+        ASSERT(size > 0);
+        ASSERT(memory != nullptr);
 
-        void* memoryEnd =((void*) deallocBlock) + deallocBlock->size;
-        Block* block = mBlocks;
-        Block* prev = nullptr;
+        size_t allocated = mPolicy.allocateBatch(size, count, memory);
+        ASSERT(allocated == count);
 
-        while(block != nullptr) {
-            if((void*) block >= memoryEnd) {
-                break;
+        if(allocated > 0 && isObserved()) {
+            size_t used = 0;
+            if(getStatistics() != nullptr) {
+                for(size_t i = 0; i < allocated; i++) {
+                    used += CheckSize(memory[i]);
+                }
             }
 
-            prev = block;
-            block = block->next;
+            onAllocateBatch(memory, size, used, allocated); //the statistics once, the trace and the profiler per block
         }
 
-        if(prev == nullptr) { //before all blocks
-            deallocBlock->next = mBlocks;
-            mBlocks = deallocBlock;
+        if(allocated < count) {
+            onFailedAllocation(size);
         }
-        else if((void*)prev + prev->size == (void*)deallocBlock) { //exactly next to the previous block
-            prev->size += deallocBlock->size;
-            deallocBlock->size = 0;
-            deallocBlock = prev;
-        }
-        else { //doesnt match with the previous block
-            deallocBlock->next = prev->next;
-            prev->next = deallocBlock;
+
+        return allocated;
+    }
+
+    void BlockAllocator::deallocateBatch(void** memory, const size_t& count) {
+        ASSERT(memory != nullptr);
+
+        if(isObserved()) {
+            size_t used = 0;
+            if(getStatistics() != nullptr) {
+                for(size_t i = 0; i < count; i++) {
+                    used += CheckSize(memory[i]);
+                }
+            }
+
+            onDeallocateBatch(memory, used, count);
         }
 
-        if(block != nullptr && (void*) block == memoryEnd) { //exactly before the next block
-            deallocBlock->size += block->size;
-            deallocBlock->next = block->next;
-            block->size = 0;
-            block->next = nullptr;
+        for(size_t i = 0; i < count; i++) {
+            mPolicy.deallocate(memory[i]);
         }
     }
 
     void BlockAllocator::clear() {
         memset(mMemory, 0, mSize);
 
-        mBlocks = (Block*) mMemory;
-        mBlocks->size = mSize;
-        mBlocks->next = nullptr;
+        mPolicy.clear();
+
+        onClear();
     }
 
-    const size_t& BlockAllocator::CheckSize(void* memory) {
-        return *((size_t*) (memory - sizeof(size_t)));
+    size_t BlockAllocator::getLargestFreeBlock() { return mPolicy.getLargestFreeBlock(); }
+
+    size_t BlockAllocator::CheckSize(void* memory) {
+        return BlockPolicy::CheckSize(memory);
     }
 
 #ifdef MFG_DEBUG
     void BlockAllocator::printSizeOfBlocks() {
-        Block* block = mBlocks;
-        while(block != nullptr) {
-            std::cout << "blockSize: " << block->size << std::endl;
-            block = block->next;
-        }
+        mPolicy.printSizeOfBlocks();
     }
-}
 #endif // MFG_DEBUG
+}//mfg
@@ -0,0 +1,269 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BuddyAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        enum : size_t {
+            ORDER_BITS = 6, //an entry of the table is the size of the request << ORDER_BITS | the order
+            ORDER_MASK = ((size_t) 1 << ORDER_BITS) - 1
+        };
+
+        inline size_t wordsFor(const size_t& bits) { return (bits + 63) / 64; }
+
+        inline size_t ordersFor(const size_t& numOfMinBlocks, const size_t& maxOrders) {
+            size_t orders = 64 - __builtin_clzll(numOfMinBlocks); //the biggest block fits
+            return orders < maxOrders ? orders : maxOrders;
+        }
+
+        //size of the bitmaps and the table
+        inline size_t headerSize(const size_t& numOfMinBlocks, const size_t& maxOrders) {
+            size_t words = 0;
+            for(size_t order = 0; order < ordersFor(numOfMinBlocks, maxOrders); order++) {
+                words += wordsFor((numOfMinBlocks + ((size_t) 1 << order) - 1) >> order);
+            }
+
+            return words * sizeof(uint64_t) + numOfMinBlocks * sizeof(size_t);
+        }
+
+        inline uintptr_t alignUp(const uintptr_t& address, const size_t& alignment) {
+            return (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        }
+    }
+
+    BuddyAllocator::BuddyAllocator(void* memory, const size_t& size, const size_t& minBlockSize) :
+        Allocator(memory, size, false),
+        mMinBlockSize(minBlockSize),
+        mMinBlockShift(__builtin_ctzll(minBlockSize))
+    {
+        ASSERT((minBlockSize & (minBlockSize - 1)) == 0);
+        ASSERT(minBlockSize >= sizeof(FreeBlock));
+
+        mNumOfMinBlocks = size / (minBlockSize + sizeof(size_t));
+        while(mNumOfMinBlocks > 0 && alignUp((uintptr_t) memory + headerSize(mNumOfMinBlocks, MAX_ORDERS), minBlockSize)
+                + (mNumOfMinBlocks << mMinBlockShift) > (uintptr_t) memory + size) {
+            mNumOfMinBlocks--;
+        }
+
+        ASSERT(mNumOfMinBlocks > 0);
+
+        mNumOfOrders = ordersFor(mNumOfMinBlocks, MAX_ORDERS);
+
+        uint64_t* bits = (uint64_t*) memory;
+        for(size_t order = 0; order < MAX_ORDERS; order++) {
+            mFreeBits[order] = order < mNumOfOrders ? bits : nullptr;
+            if(order < mNumOfOrders) {
+                bits += wordsFor((mNumOfMinBlocks + ((size_t) 1 << order) - 1) >> order);
+            }
+        }
+
+        mRequestedSizes = (size_t*) bits;
+        mBlocks = (void*) alignUp((uintptr_t) (mRequestedSizes + mNumOfMinBlocks), minBlockSize);
+
+        clear();
+    }
+
+    BuddyAllocator::~BuddyAllocator() {}
+
+    size_t BuddyAllocator::orderOf(const size_t& size) const {
+        if(size > (mNumOfMinBlocks << mMinBlockShift)) { //bigger than the memory
+            return MAX_ORDERS;
+        }
+
+        size_t blocks = (size + mMinBlockSize - 1) >> mMinBlockShift;
+        return blocks <= 1 ? 0 : 64 - __builtin_clzll(blocks - 1);
+    }
+
+    void BuddyAllocator::pushBlock(void* block, const size_t& order) {
+        size_t index = ((uintptr_t) block - (uintptr_t) mBlocks) >> (mMinBlockShift + order);
+        mFreeBits[order][index / 64] |= (uint64_t) 1 << (index & 63);
+
+        FreeBlock* freeBlock = (FreeBlock*) block;
+        freeBlock->next = mFreeLists[order];
+        freeBlock->prev = nullptr;
+        if(freeBlock->next != nullptr) {
+            freeBlock->next->prev = freeBlock;
+        }
+
+        mFreeLists[order] = freeBlock;
+        mFreeOrders |= (size_t) 1 << order;
+    }
+
+    void BuddyAllocator::popBlock(void* block, const size_t& order) {
+        size_t index = ((uintptr_t) block - (uintptr_t) mBlocks) >> (mMinBlockShift + order);
+        mFreeBits[order][index / 64] &= ~((uint64_t) 1 << (index & 63));
+
+        FreeBlock* freeBlock = (FreeBlock*) block;
+        if(freeBlock->prev != nullptr) {
+            freeBlock->prev->next = freeBlock->next;
+        }
+        else {
+            mFreeLists[order] = freeBlock->next;
+        }
+
+        if(freeBlock->next != nullptr) {
+            freeBlock->next->prev = freeBlock->prev;
+        }
+
+        if(mFreeLists[order] == nullptr) {
+            mFreeOrders &= ~((size_t) 1 << order);
+        }
+    }
+
+    void* BuddyAllocator::takeBlock(const size_t& order, const size_t& size) {
+        size_t orders = order < mNumOfOrders ? mFreeOrders >> order : 0;
+        if(orders == 0) { //no free block of this order or above
+            return nullptr;
+        }
+
+        size_t current = order + __builtin_ctzll(orders);
+        void* block = mFreeLists[current];
+        popBlock(block, current);
+
+        while(current > order) { //the upper half becomes free
+            current--;
+            pushBlock(block + (mMinBlockSize << current), current);
+        }
+
+        size_t index = ((uintptr_t) block - (uintptr_t) mBlocks) >> mMinBlockShift;
+        mRequestedSizes[index] = (size << ORDER_BITS) | order;
+        mRequestedSize += size;
+        mUsedSize += mMinBlockSize << order;
+
+        return block;
+    }
+
+    void* BuddyAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        void* memory = takeBlock(orderOf(size), size);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, getUsableSize(memory));
+        return memory;
+    }
+
+    void* BuddyAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if(alignment <= mMinBlockSize) { //every block is aligned this way
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+
+        void* memory = nullptr;
+        if(((uintptr_t) mBlocks & (alignment - 1)) == 0) { //a block of the size of the alignment is aligned
+            memory = takeBlock(orderOf(size > alignment ? size : alignment), size);
+        }
+
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, getUsableSize(memory), alignment);
+        return memory;
+    }
+
+    void BuddyAllocator::deallocate(void* memory) {
+        size_t index = ((uintptr_t) memory - (uintptr_t) mBlocks) >> mMinBlockShift;
+
+        ASSERT(index < mNumOfMinBlocks && memory == mBlocks + (index << mMinBlockShift));
+        ASSERT(mRequestedSizes[index] != 0);
+
+        size_t order = mRequestedSizes[index] & ORDER_MASK;
+        onDeallocate(memory, mMinBlockSize << order);
+
+        mRequestedSize -= mRequestedSizes[index] >> ORDER_BITS;
+        mUsedSize -= mMinBlockSize << order;
+        mRequestedSizes[index] = 0;
+
+        while(order + 1 < mNumOfOrders) { //merge while the buddy is free
+            size_t buddy = index ^ ((size_t) 1 << order);
+            if(buddy >= mNumOfMinBlocks || (mFreeBits[order][(buddy >> order) / 64] & ((uint64_t) 1 << ((buddy >> order) & 63))) == 0) {
+                break;
+            }
+
+            popBlock(mBlocks + (buddy << mMinBlockShift), order);
+            index &= ~((size_t) 1 << order);
+            order++;
+        }
+
+        pushBlock(mBlocks + (index << mMinBlockShift), order);
+    }
+
+    size_t BuddyAllocator::getUsableSize(void* memory) {
+        size_t index = ((uintptr_t) memory - (uintptr_t) mBlocks) >> mMinBlockShift;
+        return mMinBlockSize << (mRequestedSizes[index] & ORDER_MASK);
+    }
+
+    void BuddyAllocator::clear() {
+        memset(mFreeBits[0], 0, (uintptr_t) (mRequestedSizes + mNumOfMinBlocks) - (uintptr_t) mFreeBits[0]);
+        memset(mFreeLists, 0, sizeof(mFreeLists));
+        mFreeOrders = 0;
+        mRequestedSize = 0;
+        mUsedSize = 0;
+
+        //the biggest blocks which start on a multiple of their size, the tail is cut into smaller ones
+        size_t index = 0;
+        while(index < mNumOfMinBlocks) {
+            size_t order = mNumOfOrders - 1;
+            while((index & (((size_t) 1 << order) - 1)) != 0 || index + ((size_t) 1 << order) > mNumOfMinBlocks) {
+                order--;
+            }
+
+            pushBlock(mBlocks + (index << mMinBlockShift), order);
+            index += (size_t) 1 << order;
+        }
+
+        onClear();
+    }
+
+    size_t BuddyAllocator::getLargestFreeBlock() {
+        return mFreeOrders != 0 ? mMinBlockSize << (63 - __builtin_clzll(mFreeOrders)) : 0;
+    }
+
+    double BuddyAllocator::getInternalFragmentation() const {
+        return mUsedSize > 0 ? 1.0 - (double) mRequestedSize / mUsedSize : 0.0;
+    }
+
+    const size_t& BuddyAllocator::getRequestedSize() const { return mRequestedSize; }
+
+    const size_t& BuddyAllocator::getUsedSize() const { return mUsedSize; }
+
+    const size_t& BuddyAllocator::getMinBlockSize() const { return mMinBlockSize; }
+
+#ifdef MFG_DEBUG
+    void BuddyAllocator::printFreeBlocks() {
+        for(size_t order = 0; order < mNumOfOrders; order++) {
+            size_t count = 0;
+            for(FreeBlock* block = mFreeLists[order]; block != nullptr; block = block->next) {
+                count++;
+            }
+
+            std::cout << "blockSize: " << (mMinBlockSize << order) << " free: " << count << std::endl;
+        }
+    }
+#endif // MFG_DEBUG
+}//mfg
@@ -0,0 +1,240 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "CachedPoolAllocator.hpp"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace mfg {
+    namespace {
+        std::atomic<uint64_t> sNextId(1);
+
+        //live allocators by id, so an exiting thread never touches a destroyed one
+        std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_map<uint64_t, CachedPoolAllocator*>& registry() {
+            static std::unordered_map<uint64_t, CachedPoolAllocator*> allocators;
+            return allocators;
+        }
+    }
+
+    /*! \class  ThreadMagazines
+     *  \brief  The magazines of one thread. Gives them back when the thread exits.
+     */
+    class ThreadMagazines {
+    public:
+        struct Entry {
+            uint64_t id;
+            CachedPoolAllocator::Magazine* magazine;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t lastId = 0;
+        CachedPoolAllocator::Magazine* lastMagazine = nullptr;
+
+        ~ThreadMagazines() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for(const Entry& entry : entries) {
+                auto it = registry().find(entry.id);
+                if(it != registry().end()) {
+                    it->second->releaseMagazine(entry.magazine);
+                }
+            }
+        }
+    };
+
+    namespace {
+        thread_local ThreadMagazines tMagazines;
+    }
+
+    CachedPoolAllocator::CachedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const size_t& magazineSize, const bool& zeroMemory) :
+        Allocator(memory, size, false),
+        mPool(memory, size, blockSize, zeroMemory),
+        mMagazineSize(magazineSize),
+        mBatchSize(magazineSize > 1 ? magazineSize / 2 : 1),
+        mId(sNextId++)
+    {
+        ASSERT(magazineSize > 0);
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry()[mId] = this;
+    }
+
+    CachedPoolAllocator::~CachedPoolAllocator() {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().erase(mId);
+        }
+
+        for(Magazine* magazine : mMagazines) {
+            delete[] magazine->blocks;
+            delete magazine;
+        }
+    }
+
+    CachedPoolAllocator::Magazine* CachedPoolAllocator::getMagazine() {
+        if(tMagazines.lastId == mId) {
+            return tMagazines.lastMagazine;
+        }
+
+        for(const ThreadMagazines::Entry& entry : tMagazines.entries) {
+            if(entry.id == mId) {
+                tMagazines.lastId = mId;
+                tMagazines.lastMagazine = entry.magazine;
+                return entry.magazine;
+            }
+        }
+
+        return createMagazine();
+    }
+
+    CachedPoolAllocator::Magazine* CachedPoolAllocator::createMagazine() {
+        {
+            //forget the magazines of destroyed allocators
+            std::lock_guard<std::mutex> lock(registryMutex());
+            std::vector<ThreadMagazines::Entry>& entries = tMagazines.entries;
+            for(size_t i = 0; i < entries.size();) {
+                if(registry().count(entries[i].id) == 0) {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+
+        Magazine* magazine = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for(Magazine* orphan : mMagazines) {
+                if(orphan->orphan) {
+                    magazine = orphan;
+                    break;
+                }
+            }
+
+            if(magazine == nullptr) {
+                magazine = new Magazine;
+                magazine->blocks = new void*[mMagazineSize];
+                mMagazines.push_back(magazine);
+            }
+
+            magazine->count = 0;
+            magazine->orphan = false;
+        }
+
+        tMagazines.entries.push_back({mId, magazine});
+        tMagazines.lastId = mId;
+        tMagazines.lastMagazine = magazine;
+
+        return magazine;
+    }
+
+    void CachedPoolAllocator::refill(Magazine* magazine) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if(magazine->count < mBatchSize) {
+            magazine->count += mPool.allocateBatch(mBatchSize - magazine->count, magazine->blocks + magazine->count);
+        }
+    }
+
+    void CachedPoolAllocator::flush(Magazine* magazine, const size_t& count) {
+        {
+            //the coldest blocks go back, the hot ones stay in the magazine
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPool.deallocateBatch(magazine->blocks, count);
+        }
+
+        magazine->count -= count;
+        memmove(magazine->blocks, magazine->blocks + count, magazine->count * sizeof(void*));
+    }
+
+    void CachedPoolAllocator::releaseMagazine(Magazine* magazine) {
+        flush(magazine, magazine->count);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        magazine->orphan = true;
+    }
+
+    void* CachedPoolAllocator::allocate(const size_t& size) {
+        ASSERT(size <= mPool.getBlockSize());
+
+        Magazine* magazine = getMagazine();
+        if(magazine->count == 0) {
+            refill(magazine);
+            if(magazine->count == 0) { //the shared pool is empty too
+                onFailedAllocation(size);
+                return nullptr;
+            }
+        }
+
+        void* memory = magazine->blocks[--magazine->count];
+        onAllocate(memory, size, mPool.getBlockSize());
+        return memory;
+    }
+
+    void* CachedPoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if((((uintptr_t) mMemory | mPool.getBlockSize()) & (alignment - 1)) != 0) { //the blocks are not aligned
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        return allocate(size);
+    }
+
+    void CachedPoolAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        onDeallocate(memory, mPool.getBlockSize());
+
+        Magazine* magazine = getMagazine();
+        if(magazine->count == mMagazineSize) {
+            flush(magazine, mBatchSize);
+        }
+
+        magazine->blocks[magazine->count++] = memory;
+    }
+
+    size_t CachedPoolAllocator::getUsableSize(void* memory) { return getBlockSize(); }
+
+    void CachedPoolAllocator::clear() {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mPool.clear();
+        for(Magazine* magazine : mMagazines) {
+            magazine->count = 0;
+        }
+
+        onClear();
+    }
+
+    void CachedPoolAllocator::flushThreadCache() {
+        Magazine* magazine = getMagazine();
+        flush(magazine, magazine->count);
+    }
+
+    const size_t& CachedPoolAllocator::getBlockSize() const { return mPool.getBlockSize(); }
+    const size_t& CachedPoolAllocator::getMagazineSize() const { return mMagazineSize; }
+}//mfg
@@ -0,0 +1,48 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ChunkSource.hpp"
+
+#include <sys/mman.h>
+
+namespace mfg {
+    ChunkSource::~ChunkSource() {}
+
+    void* MmapChunkSource::acquire(const size_t& size) {
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+
+    void MmapChunkSource::release(void* memory, const size_t& size) {
+        munmap(memory, size);
+    }
+
+    AllocatorChunkSource::AllocatorChunkSource(Allocator* allocator) :
+        mAllocator(allocator)
+    {
+        ASSERT(allocator != nullptr);
+        ASSERT(allocator->canDeallocate());
+    }
+
+    void* AllocatorChunkSource::acquire(const size_t& size) {
+        return mAllocator->allocate(size, CHUNK_ALIGNMENT);
+    }
+
+    void AllocatorChunkSource::release(void* memory, const size_t& size) {
+        mAllocator->deallocate(memory);
+    }
+}//mfg
@@ -0,0 +1,309 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ConcurrentStackAllocator.hpp"
+
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace mfg {
+    /*! \struct ThreadChunk
+     *  \brief  The chunk of one thread in one ConcurrentStackAllocator.
+     */
+    struct ThreadChunk {
+        uint64_t id; //id of the allocator
+        uint64_t epoch; //epoch of the allocator when the chunk has been claimed
+        uintptr_t top; //first free byte of the chunk
+        uintptr_t end; //end of the chunk
+        ThreadCounters* counters; //allocations of the thread in the allocator
+    };
+
+    /*! \struct ThreadCounters
+     *  \brief  The allocations of one thread in one ConcurrentStackAllocator, only while statistics are on.
+     *          Only the thread writes them, and they are read at the quiescent points.
+     */
+    struct ThreadCounters {
+        std::atomic<size_t> allocations; //allocations since the allocator has been created
+        std::atomic<size_t> used; //bytes of those allocations
+    };
+
+    namespace {
+        std::atomic<uint64_t> sNextId(1);
+        thread_local std::vector<ThreadChunk> tChunks; //chunks of the thread by the id of their allocator
+
+        //ids of the live allocators, so the chunks of destroyed ones can be forgotten
+        std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_set<uint64_t>& registry() {
+            static std::unordered_set<uint64_t> ids;
+            return ids;
+        }
+
+        inline uintptr_t alignUp(const uintptr_t& address, const size_t& alignment) {
+            return (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        }
+    }
+
+    ConcurrentStackAllocator::ConcurrentStackAllocator(void* memory, const size_t& size, const size_t& chunkSize) :
+        Allocator(memory, size, false),
+        mClaimed(0),
+        mEpoch(0),
+        mChunkSize(chunkSize),
+        mId(sNextId++),
+        mFlushedAllocations(0),
+        mFlushedUsed(0)
+    {
+        ASSERT(size > 0);
+        ASSERT(chunkSize > 0);
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().insert(mId);
+    }
+
+    ConcurrentStackAllocator::~ConcurrentStackAllocator() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(mId);
+
+        for(ThreadCounters* counters : mCounters) {
+            delete counters;
+        }
+    }
+
+    ThreadChunk& ConcurrentStackAllocator::getThreadChunk() {
+        for(ThreadChunk& chunk : tChunks) {
+            if(chunk.id == mId) {
+                return chunk;
+            }
+        }
+
+        ThreadCounters* counters = new ThreadCounters;
+        counters->allocations = 0;
+        counters->used = 0;
+        {
+            //forget the chunks of destroyed allocators
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for(size_t i = 0; i < tChunks.size();) {
+                if(registry().count(tChunks[i].id) == 0) {
+                    tChunks[i] = tChunks.back();
+                    tChunks.pop_back();
+                }
+                else {
+                    i++;
+                }
+            }
+
+            mCounters.push_back(counters);
+        }
+
+        tChunks.push_back({mId, mEpoch.load(std::memory_order_relaxed), 0, 0, counters});
+        return tChunks.back();
+    }
+
+    void* ConcurrentStackAllocator::bump(ThreadChunk& chunk, const size_t& size, const size_t& alignment, size_t& used) {
+        uint64_t epoch = mEpoch.load(std::memory_order_relaxed); //a quiescent point has passed, the chunk may be reused by anyone
+        if(chunk.epoch != epoch) {
+            chunk.epoch = epoch;
+            chunk.top = 0;
+            chunk.end = 0;
+        }
+
+        uintptr_t memory = alignUp(chunk.top, alignment);
+        if(chunk.top != 0 && memory <= chunk.end && size <= chunk.end - memory) { //fits in the chunk
+            used = memory + size - chunk.top;
+            chunk.top = memory + size;
+            return (void*) memory;
+        }
+
+        if(size + alignment - 1 > mChunkSize / 4) { //too big for a chunk, claimed on its own, the chunk stays
+            size_t claim = size + alignment - 1;
+            size_t offset = mClaimed.fetch_add(claim, std::memory_order_relaxed);
+            if(offset >= mSize || claim > mSize - offset) {
+                return nullptr;
+            }
+
+            used = claim;
+            return (void*) alignUp((uintptr_t) mMemory + offset, alignment);
+        }
+
+        size_t offset = mClaimed.fetch_add(mChunkSize, std::memory_order_relaxed);
+        if(offset >= mSize) {
+            return nullptr;
+        }
+
+        //the last chunk is cut at the end of the memory, but it is still the thread's own
+        chunk.top = (uintptr_t) mMemory + offset;
+        chunk.end = (uintptr_t) mMemory + (mChunkSize < mSize - offset ? offset + mChunkSize : mSize);
+
+        memory = alignUp(chunk.top, alignment);
+        if(memory > chunk.end || size > chunk.end - memory) {
+            return nullptr;
+        }
+
+        used = memory + size - chunk.top;
+        chunk.top = memory + size;
+        return (void*) memory;
+    }
+
+    void ConcurrentStackAllocator::onAllocated(ThreadChunk& chunk, const size_t& used) {
+        if(getStatistics() != nullptr) { //nobody else writes them
+            ThreadCounters& counters = *chunk.counters;
+            counters.allocations.store(counters.allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            counters.used.store(counters.used.load(std::memory_order_relaxed) + used, std::memory_order_relaxed);
+        }
+    }
+
+    void ConcurrentStackAllocator::flushCounters() {
+        //the counters only grow, the checkpoints get what has been added since the last flush
+        size_t allocations = 0;
+        size_t used = 0;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for(ThreadCounters* counters : mCounters) {
+                allocations += counters->allocations.load(std::memory_order_relaxed);
+                used += counters->used.load(std::memory_order_relaxed);
+            }
+        }
+
+        mCheckpoints.onAllocate(allocations - mFlushedAllocations);
+        mUsedCheckpoints.onAllocate(used - mFlushedUsed);
+        mFlushedAllocations = allocations;
+        mFlushedUsed = used;
+    }
+
+    void* ConcurrentStackAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        size_t used = 0;
+        ThreadChunk& chunk = getThreadChunk();
+        void* memory = bump(chunk, size, 1, used);
+        ASSERT(memory != nullptr);
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, used);
+            onAllocated(chunk, used);
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return memory;
+    }
+
+    void* ConcurrentStackAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        size_t used = 0;
+        ThreadChunk& chunk = getThreadChunk();
+        void* memory = bump(chunk, size, alignment, used);
+        ASSERT(memory != nullptr);
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, used, alignment); //padding included
+            onAllocated(chunk, used);
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return memory;
+    }
+
+    void ConcurrentStackAllocator::deallocate(void* memory) {
+        ///do nothing, because you have to use deallocateTo
+    }
+
+    void* ConcurrentStackAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+
+        //the old size is unknown, in the chunk of the thread it ends below the top of the chunk,
+        //anywhere else it ends below the claimed memory
+        size_t claimed = mClaimed.load(std::memory_order_relaxed);
+        uintptr_t end = (uintptr_t) mMemory + (claimed < mSize ? claimed : mSize);
+        ThreadChunk& chunk = getThreadChunk();
+        if(chunk.epoch == mEpoch.load(std::memory_order_relaxed) && (uintptr_t) memory < chunk.top && chunk.end - (uintptr_t) memory <= mChunkSize) {
+            end = chunk.top;
+        }
+
+        ASSERT((uintptr_t) memory >= (uintptr_t) mMemory && (uintptr_t) memory < end);
+
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        size_t available = end - (uintptr_t) memory;
+        memcpy(newMemory, memory, size < available ? size : available);
+        return newMemory;
+    }
+
+    bool ConcurrentStackAllocator::canDeallocate() const { return false; }
+
+    void ConcurrentStackAllocator::deallocateTo(Marker marker) {
+        ASSERT(marker <= mClaimed.load(std::memory_order_relaxed) && marker <= mSize);
+
+        flushCounters();
+        size_t used = mUsedCheckpoints.rollBack(marker);
+        size_t claimed = mClaimed.load(std::memory_order_relaxed);
+        onDeallocateTo(marker, used, mCheckpoints.rollBack(marker), mMemory + marker, mMemory + (claimed < mSize ? claimed : mSize));
+
+        mClaimed.store(marker, std::memory_order_relaxed);
+        mEpoch.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ConcurrentStackAllocator::clear() {
+        mClaimed.store(0, std::memory_order_relaxed);
+        mEpoch.fetch_add(1, std::memory_order_relaxed);
+
+        flushCounters();
+        mCheckpoints.clear();
+        mUsedCheckpoints.clear();
+
+        onClear();
+    }
+
+    size_t ConcurrentStackAllocator::getLargestFreeBlock() {
+        size_t claimed = mClaimed.load(std::memory_order_relaxed);
+        return claimed < mSize ? mSize - claimed : 0;
+    }
+
+    Marker ConcurrentStackAllocator::getMarker() {
+        mEpoch.fetch_add(1, std::memory_order_relaxed); //the chunks may reach over the marker
+
+        size_t claimed = mClaimed.load(std::memory_order_relaxed);
+        Marker marker = claimed < mSize ? claimed : mSize;
+        if(getStatistics() != nullptr) {
+            flushCounters();
+            mCheckpoints.record(marker);
+            mUsedCheckpoints.record(marker);
+        }
+
+        onMarker(marker);
+
+        return marker;
+    }
+
+    const size_t& ConcurrentStackAllocator::getChunkSize() const { return mChunkSize; }
+}//mfg
@@ -0,0 +1,179 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "DoubleEndedStackAllocator.hpp"
+
+namespace mfg {
+    DoubleEndedStackAllocator::DoubleEndedStackAllocator(void* memory, const size_t& size) :
+        Allocator(memory, size),
+        mBottom(0),
+        mTop(size)
+    {
+        ASSERT(size > 0);
+    }
+
+    DoubleEndedStackAllocator::~DoubleEndedStackAllocator() {}
+
+    void* DoubleEndedStackAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        if(size > mTop - mBottom) {
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        mBottom += size;
+
+        void* memory = mMemory + mBottom - size;
+        onAllocate(memory, size, size);
+        mBottomCheckpoints.onAllocate();
+
+        return memory;
+    }
+
+    void* DoubleEndedStackAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        size_t padding = (alignment - (((uintptr_t) mMemory + mBottom) & (alignment - 1))) & (alignment - 1);
+        if(padding + size > mTop - mBottom) {
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        mBottom += padding + size;
+
+        void* memory = mMemory + mBottom - size;
+        onAllocate(memory, size, padding + size, alignment);
+        mBottomCheckpoints.onAllocate();
+
+        return memory;
+    }
+
+    void* DoubleEndedStackAllocator::allocateTop(const size_t& size) {
+        ASSERT(size > 0);
+
+        if(size > mTop - mBottom) {
+            ASSERT(false);
+            onFailedAllocation(size, 0, true);
+            return nullptr;
+        }
+
+        mTop -= size;
+
+        onAllocate(mMemory + mTop, size, size, 0, true);
+        mTopCheckpoints.onAllocate();
+
+        return mMemory + mTop;
+    }
+
+    void* DoubleEndedStackAllocator::allocateTop(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        size_t padding = ((uintptr_t) mMemory + mTop - size) & (alignment - 1);
+        if(size > mTop - mBottom || padding > mTop - mBottom - size) {
+            ASSERT(false);
+            onFailedAllocation(size, alignment, true);
+            return nullptr;
+        }
+
+        mTop -= padding + size;
+
+        onAllocate(mMemory + mTop, size, padding + size, alignment, true);
+        mTopCheckpoints.onAllocate();
+
+        return mMemory + mTop;
+    }
+
+    void DoubleEndedStackAllocator::deallocate(void* memory) {
+        ///do nothing, because you have to use deallocateToBottom or deallocateToTop
+    }
+
+    void* DoubleEndedStackAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+
+        size_t offset = (uintptr_t) memory - (uintptr_t) mMemory;
+        ASSERT(offset < mBottom || (offset >= mTop && offset < mSize));
+
+        bool top = offset >= mTop;
+        size_t available = top ? mSize - offset : mBottom - offset; //the old size is unknown, but it can not reach over its stack
+        void* newMemory = top ? allocateTop(size) : allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        memcpy(newMemory, memory, size < available ? size : available);
+        return newMemory;
+    }
+
+    bool DoubleEndedStackAllocator::canDeallocate() const { return false; }
+
+    void DoubleEndedStackAllocator::deallocateToBottom(Marker marker) {
+        ASSERT(marker <= mBottom);
+
+        onDeallocateTo(marker, mBottom - marker, mBottomCheckpoints.rollBack(marker), mMemory + marker, mMemory + mBottom);
+
+        mBottom = marker;
+    }
+
+    void DoubleEndedStackAllocator::deallocateToTop(Marker marker) {
+        ASSERT(marker >= mTop && marker <= mSize);
+
+        onDeallocateTo(mSize - marker, marker - mTop, mTopCheckpoints.rollBack(mSize - marker), mMemory + mTop, mMemory + marker, true);
+
+        mTop = marker;
+    }
+
+    void DoubleEndedStackAllocator::clear() {
+        mBottom = 0;
+        mTop = mSize;
+        mBottomCheckpoints.clear();
+        mTopCheckpoints.clear();
+
+        onClear();
+    }
+
+    void DoubleEndedStackAllocator::clearBottom() { deallocateToBottom(0); }
+    void DoubleEndedStackAllocator::clearTop() { deallocateToTop(mSize); }
+
+    Marker DoubleEndedStackAllocator::getBottomMarker() {
+        if(getStatistics() != nullptr) {
+            mBottomCheckpoints.record(mBottom);
+        }
+
+        onMarker(mBottom);
+
+        return mBottom;
+    }
+
+    Marker DoubleEndedStackAllocator::getTopMarker() {
+        if(getStatistics() != nullptr) {
+            mTopCheckpoints.record(mSize - mTop);
+        }
+
+        onMarker(mSize - mTop, true);
+
+        return mTop;
+    }
+}//mfg
@@ -0,0 +1,138 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "FrameAllocator.hpp"
+
+namespace mfg {
+    FrameAllocator::FrameAllocator(void* memory, const size_t& size) :
+        Allocator(memory, size),
+        mPolicies{StackPolicy(memory, size / 2), StackPolicy(memory + size / 2, size / 2)},
+        mCurrent(0)
+    {
+        ASSERT(size > 1);
+    }
+
+    FrameAllocator::~FrameAllocator() {}
+
+    void* FrameAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        void* memory = mPolicies[mCurrent].allocate(size);
+        ASSERT(memory != nullptr);
+
+        if(memory == nullptr) {
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, size);
+        mCheckpoints[mCurrent].onAllocate();
+
+        return memory;
+    }
+
+    void* FrameAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        Marker marker = mPolicies[mCurrent].getMarker();
+
+        void* memory = mPolicies[mCurrent].allocate(size, alignment);
+        ASSERT(memory != nullptr);
+
+        if(memory == nullptr) {
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, mPolicies[mCurrent].getMarker() - marker, alignment); //padding included
+        mCheckpoints[mCurrent].onAllocate();
+
+        return memory;
+    }
+
+    void FrameAllocator::deallocate(void* memory) {
+        ///do nothing, the memory comes back two frames later
+    }
+
+    void* FrameAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+        ASSERT((uintptr_t) memory - (uintptr_t) mMemory < mSize / 2 * 2);
+
+        size_t frame = (uintptr_t) memory - (uintptr_t) mMemory < mSize / 2 ? 0 : 1; //it may be of the previous frame
+        Marker marker = mPolicies[frame].getMarker();
+        size_t offset = (uintptr_t) memory - (uintptr_t) mMemory - frame * (mSize / 2);
+        if(frame == mCurrent && mPolicies[mCurrent].reallocate(memory, size)) { //recorded as a deallocation and an allocation
+            onDeallocate(memory, marker - offset);
+            onAllocate(memory, size, size);
+            return memory;
+        }
+
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        memcpy(newMemory, memory, size < marker - offset ? size : marker - offset); //the old size is unknown, but nothing is above the marker of its frame
+        return newMemory;
+    }
+
+    bool FrameAllocator::canDeallocate() const { return false; }
+
+    void FrameAllocator::deallocateTo(Marker marker) {
+        ASSERT(marker <= mPolicies[mCurrent].getMarker());
+
+        void* frame = mMemory + mCurrent * (mSize / 2);
+        onDeallocateTo(marker, mPolicies[mCurrent].getMarker() - marker, mCheckpoints[mCurrent].rollBack(marker), frame + marker, frame + mPolicies[mCurrent].getMarker());
+
+        mPolicies[mCurrent].deallocateTo(marker);
+    }
+
+    void FrameAllocator::beginFrame() {
+        mCurrent ^= 1;
+
+        void* frame = mMemory + mCurrent * (mSize / 2);
+        onBeginFrame(mPolicies[mCurrent].getMarker(), mCheckpoints[mCurrent].rollBack(0), frame, frame + mPolicies[mCurrent].getMarker());
+
+        mPolicies[mCurrent].clear();
+    }
+
+    void FrameAllocator::clear() {
+        mPolicies[0].clear();
+        mPolicies[1].clear();
+        mCurrent = 0;
+        mCheckpoints[0].clear();
+        mCheckpoints[1].clear();
+
+        onClear();
+    }
+
+    Marker FrameAllocator::getMarker() {
+        Marker marker = mPolicies[mCurrent].takeMarker();
+        if(getStatistics() != nullptr) {
+            mCheckpoints[mCurrent].record(marker);
+        }
+
+        onMarker(marker);
+
+        return marker;
+    }
+}//mfg
@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "GrowableBlockAllocator.hpp"
+
+#include <algorithm>
+
+namespace mfg {
+    namespace {
+        const size_t BLOCK_OVERHEAD = 8 * sizeof(size_t); //header, rounding and the smallest gap in front of an aligned block
+    }
+
+    GrowableBlockAllocator::GrowableBlockAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize) :
+        Allocator(memory, size, false),
+        mSource(source),
+        mChunkSize(chunkSize),
+        mLast(0)
+    {
+        ASSERT(source != nullptr);
+        ASSERT(chunkSize >= BLOCK_OVERHEAD);
+
+        mChunks.push_back({BlockPolicy(memory, size), memory, size});
+    }
+
+    GrowableBlockAllocator::~GrowableBlockAllocator() {
+        releaseExtraChunks();
+    }
+
+    void* GrowableBlockAllocator::allocateSlow(const size_t& size, const size_t& alignment) {
+        for(size_t i = 0; i < mChunks.size(); i++) {
+            if(i == mLast) { //it has been tried already
+                continue;
+            }
+
+            void* memory = mChunks[i].policy.allocate(size, alignment);
+            if(memory != nullptr) {
+                mLast = i;
+                return memory;
+            }
+        }
+
+        //no chunk has a fitting block
+        size_t chunkSize = size + alignment + BLOCK_OVERHEAD;
+        if(chunkSize < mChunkSize) {
+            chunkSize = mChunkSize;
+        }
+
+        void* chunk = mSource->acquire(chunkSize);
+        if(chunk == nullptr) {
+            return nullptr;
+        }
+
+        auto it = std::upper_bound(mChunks.begin(), mChunks.end(), chunk, [](const void* memory, const Chunk& other) {
+            return (uintptr_t) memory < (uintptr_t) other.memory;
+        });
+
+        mLast = it - mChunks.begin();
+        mChunks.insert(it, {BlockPolicy(chunk, chunkSize), chunk, chunkSize});
+        return mChunks[mLast].policy.allocate(size, alignment);
+    }
+
+    size_t GrowableBlockAllocator::findChunk(const void* memory) const {
+        if(mChunks[mLast].policy.owns(memory)) { //most of the time it is the chunk of the previous allocation
+            return mLast;
+        }
+
+        auto it = std::upper_bound(mChunks.begin(), mChunks.end(), memory, [](const void* memory, const Chunk& other) {
+            return (uintptr_t) memory < (uintptr_t) other.memory;
+        });
+
+        return it - mChunks.begin() - 1;
+    }
+
+    void GrowableBlockAllocator::releaseExtraChunks() {
+        for(size_t i = 0; i < mChunks.size(); i++) {
+            if(mChunks[i].memory != mMemory) {
+                mSource->release(mChunks[i].memory, mChunks[i].size);
+            }
+        }
+
+        mChunks.clear();
+        mChunks.push_back({BlockPolicy(mMemory, mSize), mMemory, mSize});
+    }
+
+    void* GrowableBlockAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        void* memory = mChunks[mLast].policy.allocate(size);
+        if(memory == nullptr) {
+            memory = allocateSlow(size, sizeof(size_t));
+            ASSERT(memory != nullptr);
+        }
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, BlockPolicy::CheckSize(memory));
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return memory;
+    }
+
+    void* GrowableBlockAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        void* memory = mChunks[mLast].policy.allocate(size, alignment);
+        if(memory == nullptr) {
+            memory = allocateSlow(size, alignment);
+            ASSERT(memory != nullptr);
+        }
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, BlockPolicy::CheckSize(memory), alignment);
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return memory;
+    }
+
+    void GrowableBlockAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        onDeallocate(memory, BlockPolicy::CheckSize(memory));
+
+        mChunks[findChunk(memory)].policy.deallocate(memory);
+    }
+
+    size_t GrowableBlockAllocator::getUsableSize(void* memory) { return BlockPolicy::CheckSize(memory) - sizeof(size_t); }
+
+    void GrowableBlockAllocator::clear() {
+        clear(false);
+    }
+
+    void GrowableBlockAllocator::clear(const bool& releaseChunks) {
+        if(releaseChunks) {
+            releaseExtraChunks();
+        }
+        else {
+            for(Chunk& chunk : mChunks) {
+                chunk.policy.clear();
+            }
+        }
+
+        mLast = 0;
+
+        onClear();
+    }
+
+    size_t GrowableBlockAllocator::getNumberOfChunks() const { return mChunks.size(); }
+
+    size_t GrowableBlockAllocator::getCapacity() const {
+        size_t capacity = 0;
+        for(const Chunk& chunk : mChunks) {
+            capacity += chunk.size;
+        }
+
+        return capacity;
+    }
+}//mfg
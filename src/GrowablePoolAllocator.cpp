@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "GrowablePoolAllocator.hpp"
+
+#include <algorithm>
+
+namespace mfg {
+    GrowablePoolAllocator::GrowablePoolAllocator(void* memory, const size_t& size, const size_t& blockSize, ChunkSource* source, const size_t& chunkSize) :
+        Allocator(memory, size, false),
+        mBlockSize(blockSize),
+        mSource(source),
+        mChunkSize(chunkSize),
+        mLast(0)
+    {
+        ASSERT(blockSize >= sizeof(void*));
+        ASSERT(source != nullptr);
+        ASSERT(chunkSize >= blockSize);
+
+        mChunks.push_back({PoolPolicy(memory, size, blockSize), memory, size});
+    }
+
+    GrowablePoolAllocator::~GrowablePoolAllocator() {
+        releaseExtraChunks();
+    }
+
+    void* GrowablePoolAllocator::allocateSlow(const size_t& size, const size_t& alignment) {
+        if(size > mBlockSize) { //no chunk would fit it
+            return nullptr;
+        }
+
+        for(size_t i = 0; i < mChunks.size(); i++) {
+            if(i == mLast) { //it has been tried already
+                continue;
+            }
+
+            void* memory = mChunks[i].policy.allocate(size, alignment);
+            if(memory != nullptr) {
+                mLast = i;
+                return memory;
+            }
+        }
+
+        //every block of every chunk is in use
+        void* chunk = mSource->acquire(mChunkSize);
+        if(chunk == nullptr) {
+            return nullptr;
+        }
+
+        auto it = std::upper_bound(mChunks.begin(), mChunks.end(), chunk, [](const void* memory, const Chunk& other) {
+            return (uintptr_t) memory < (uintptr_t) other.memory;
+        });
+
+        mLast = it - mChunks.begin();
+        mChunks.insert(it, {PoolPolicy(chunk, mChunkSize, mBlockSize), chunk, mChunkSize});
+        return mChunks[mLast].policy.allocate(size, alignment);
+    }
+
+    size_t GrowablePoolAllocator::findChunk(const void* memory) const {
+        if(mChunks[mLast].policy.owns(memory)) { //most of the time it is the chunk of the previous allocation
+            return mLast;
+        }
+
+        auto it = std::upper_bound(mChunks.begin(), mChunks.end(), memory, [](const void* memory, const Chunk& other) {
+            return (uintptr_t) memory < (uintptr_t) other.memory;
+        });
+
+        return it - mChunks.begin() - 1;
+    }
+
+    void GrowablePoolAllocator::releaseExtraChunks() {
+        for(size_t i = 0; i < mChunks.size(); i++) {
+            if(mChunks[i].memory != mMemory) {
+                mSource->release(mChunks[i].memory, mChunks[i].size);
+            }
+        }
+
+        mChunks.clear();
+        mChunks.push_back({PoolPolicy(mMemory, mSize, mBlockSize), mMemory, mSize});
+    }
+
+    void* GrowablePoolAllocator::allocate(const size_t& size) {
+        ASSERT(size <= mBlockSize);
+
+        void* block = mChunks[mLast].policy.allocate(size);
+        if(block == nullptr) {
+            block = allocateSlow(size, 1);
+            ASSERT(block != nullptr);
+        }
+
+        if(block != nullptr) {
+            onAllocate(block, size, mBlockSize);
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return block;
+    }
+
+    void* GrowablePoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size <= mBlockSize);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        void* block = mChunks[mLast].policy.allocate(size, alignment);
+        if(block == nullptr) {
+            block = allocateSlow(size, alignment);
+            ASSERT(block != nullptr);
+        }
+
+        if(block != nullptr) {
+            onAllocate(block, size, mBlockSize, alignment);
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return block;
+    }
+
+    void GrowablePoolAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        onDeallocate(memory, mBlockSize);
+
+        mLast = findChunk(memory); //recycled blocks are hot
+        mChunks[mLast].policy.deallocate(memory);
+    }
+
+    size_t GrowablePoolAllocator::getUsableSize(void* memory) { return mBlockSize; }
+
+    void GrowablePoolAllocator::clear() {
+        clear(false);
+    }
+
+    void GrowablePoolAllocator::clear(const bool& releaseChunks) {
+        if(releaseChunks) {
+            releaseExtraChunks();
+        }
+        else {
+            for(Chunk& chunk : mChunks) {
+                chunk.policy.clear();
+            }
+        }
+
+        mLast = 0;
+
+        onClear();
+    }
+
+    const size_t& GrowablePoolAllocator::getBlockSize() const { return mBlockSize; }
+    size_t GrowablePoolAllocator::getNumberOfChunks() const { return mChunks.size(); }
+
+    size_t GrowablePoolAllocator::getCapacity() const {
+        size_t capacity = 0;
+        for(const Chunk& chunk : mChunks) {
+            capacity += chunk.size;
+        }
+
+        return capacity;
+    }
+}//mfg
@@ -0,0 +1,220 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "GrowableStackAllocator.hpp"
+
+namespace mfg {
+    GrowableStackAllocator::GrowableStackAllocator(void* memory, const size_t& size, ChunkSource* source, const size_t& chunkSize) :
+        Allocator(memory, size, false),
+        mPolicy(memory, size),
+        mSource(source),
+        mChunkSize(chunkSize),
+        mCurrent(0)
+    {
+        ASSERT(size > 0);
+        ASSERT(source != nullptr);
+        ASSERT(chunkSize > 0);
+
+        mChunks.push_back({memory, size, 0});
+    }
+
+    GrowableStackAllocator::~GrowableStackAllocator() {
+        releaseFrom(1);
+    }
+
+    void* GrowableStackAllocator::grow(const size_t& size, const size_t& alignment) {
+        size_t next = mCurrent + 1;
+        size_t needed = size + alignment - 1;
+
+        if(next < mChunks.size() && mChunks[next].size < needed) { //the kept chunks are too small
+            releaseFrom(next);
+        }
+
+        if(next == mChunks.size()) {
+            size_t chunkSize = needed > mChunkSize ? needed : mChunkSize;
+            void* memory = mSource->acquire(chunkSize);
+            if(memory == nullptr) {
+                return nullptr;
+            }
+
+            mChunks.push_back({memory, chunkSize, 0});
+        }
+
+        mChunks[next].base = mChunks[mCurrent].base + mChunks[mCurrent].size;
+        mCurrent = next;
+        mPolicy = StackPolicy(mChunks[next].memory, mChunks[next].size);
+
+        return mPolicy.allocate(size, alignment);
+    }
+
+    void GrowableStackAllocator::releaseFrom(const size_t& first) {
+        for(size_t i = first; i < mChunks.size(); i++) {
+            mSource->release(mChunks[i].memory, mChunks[i].size);
+        }
+
+        mChunks.resize(first);
+    }
+
+    void* GrowableStackAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        Marker marker = getTop();
+
+        void* memory = mPolicy.allocate(size);
+        if(memory == nullptr) { //the current chunk is full
+            memory = grow(size, 1);
+            ASSERT(memory != nullptr);
+        }
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, getTop() - marker); //the end of a left chunk included
+            mCheckpoints.onAllocate();
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return memory;
+    }
+
+    void* GrowableStackAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        Marker marker = getTop();
+
+        void* memory = mPolicy.allocate(size, alignment);
+        if(memory == nullptr) { //the current chunk is full
+            memory = grow(size, alignment);
+            ASSERT(memory != nullptr);
+        }
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, getTop() - marker, alignment); //padding and the end of a left chunk included
+            mCheckpoints.onAllocate();
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return memory;
+    }
+
+    void GrowableStackAllocator::deallocate(void* memory) {
+        ///do nothing, because you have to use deallocateTo
+    }
+
+    void* GrowableStackAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+
+        size_t available; //bytes from the memory to the end of the used part of its chunk
+        if(mPolicy.owns(memory)) {
+            Marker marker = mPolicy.getMarker();
+            size_t offset = (uintptr_t) memory - (uintptr_t) mChunks[mCurrent].memory;
+            if(mPolicy.reallocate(memory, size)) { //recorded as a deallocation and an allocation
+                onDeallocate(memory, marker - offset);
+                onAllocate(memory, size, size);
+                return memory;
+            }
+
+            available = marker - offset;
+        }
+        else {
+            size_t chunk = 0;
+            while(chunk < mCurrent && (uintptr_t) memory - (uintptr_t) mChunks[chunk].memory >= mChunks[chunk].size) {
+                chunk++;
+            }
+
+            ASSERT(chunk < mCurrent);
+            available = (uintptr_t) mChunks[chunk].memory + mChunks[chunk].size - (uintptr_t) memory;
+        }
+
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        memcpy(newMemory, memory, size < available ? size : available); //the old size is unknown, but it can not reach over its chunk
+        return newMemory;
+    }
+
+    bool GrowableStackAllocator::canDeallocate() const { return false; }
+
+    void GrowableStackAllocator::deallocateTo(Marker marker) {
+        ASSERT(marker <= getTop());
+
+        size_t chunk = mCurrent;
+        void* end = mChunks[chunk].memory + mPolicy.getMarker();
+        while(marker < mChunks[chunk].base) { //the chunks above the one of the marker are given back whole
+            onRelease(mChunks[chunk].memory, end);
+            chunk--;
+            end = mChunks[chunk].memory + mChunks[chunk].size;
+        }
+
+        onDeallocateTo(marker, getTop() - marker, mCheckpoints.rollBack(marker), mChunks[chunk].memory + (marker - mChunks[chunk].base), end);
+
+        if(chunk != mCurrent) { //step back to the chunk of the marker
+            mCurrent = chunk;
+            mPolicy = StackPolicy(mChunks[mCurrent].memory, mChunks[mCurrent].size);
+        }
+
+        mPolicy.deallocateTo(marker - mChunks[mCurrent].base);
+    }
+
+    void GrowableStackAllocator::clear() {
+        clear(false);
+    }
+
+    void GrowableStackAllocator::clear(const bool& releaseChunks) {
+        if(releaseChunks) {
+            releaseFrom(1);
+        }
+
+        mCurrent = 0;
+        mPolicy = StackPolicy(mMemory, mSize);
+        mCheckpoints.clear();
+
+        onClear();
+    }
+
+    Marker GrowableStackAllocator::getTop() const { return mChunks[mCurrent].base + mPolicy.getMarker(); }
+
+    Marker GrowableStackAllocator::getMarker() {
+        Marker marker = mChunks[mCurrent].base + mPolicy.takeMarker();
+        if(getStatistics() != nullptr) {
+            mCheckpoints.record(marker);
+        }
+
+        onMarker(marker);
+
+        return marker;
+    }
+    size_t GrowableStackAllocator::getNumberOfChunks() const { return mChunks.size(); }
+
+    size_t GrowableStackAllocator::getCapacity() const {
+        size_t capacity = 0;
+        for(const Chunk& chunk : mChunks) {
+            capacity += chunk.size;
+        }
+
+        return capacity;
+    }
+}//mfg
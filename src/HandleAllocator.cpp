@@ -0,0 +1,221 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "HandleAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        inline size_t alignToWord(const size_t& size) {
+            return (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+        }
+    }
+
+    HandleAllocator::HandleAllocator(void* memory, const size_t& size, const size_t& maxHandles) :
+        Allocator(memory, size),
+        mPolicy(memory + alignToWord(maxHandles * sizeof(Entry)), size - alignToWord(maxHandles * sizeof(Entry))),
+        mHandles((Entry*) memory),
+        mNumOfHandles(maxHandles)
+    {
+        ASSERT(maxHandles > 0 && maxHandles < NO_SLOT);
+        ASSERT(alignToWord(maxHandles * sizeof(Entry)) < size);
+
+        for(size_t i = 0; i < mNumOfHandles; i++) {
+            mHandles[i].generation = 1;
+        }
+
+        clear();
+    }
+
+    HandleAllocator::~HandleAllocator() {}
+
+    void* HandleAllocator::allocateBlock(const size_t& size, const size_t& alignment, const size_t& tag) {
+        //the tag is in the first word of the block and in front of the user memory, they are the same word without alignment
+        size_t header = alignment > sizeof(size_t) ? alignment : sizeof(size_t);
+        void* block = alignment > sizeof(size_t) ? mPolicy.allocate(size + header, alignment) : mPolicy.allocate(size + header);
+        if(block == nullptr) {
+            return nullptr;
+        }
+
+        mFreeSize -= BlockPolicy::CheckSize(block);
+
+        *((size_t*) block) = tag;
+        *((size_t*) (block + header) - 1) = tag;
+        return block + header;
+    }
+
+    void HandleAllocator::deallocateBlock(void* block) {
+        size_t size = BlockPolicy::CheckSize(block);
+        if(mCursor == block - sizeof(size_t) || mCursor == block - sizeof(size_t) + size) { //it may be merged into the previous block
+            mCursor = nullptr;
+        }
+
+        mFreeSize += size;
+        mPolicy.deallocate(block);
+    }
+
+    void* HandleAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        void* memory = allocateBlock(size, 0, PINNED_BIT | sizeof(size_t));
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, BlockPolicy::CheckSize(memory - sizeof(size_t)));
+        return memory;
+    }
+
+    void* HandleAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        size_t header = alignment > sizeof(size_t) ? alignment : sizeof(size_t);
+        void* memory = allocateBlock(size, alignment, PINNED_BIT | header);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, BlockPolicy::CheckSize(memory - header), alignment);
+        return memory;
+    }
+
+    void HandleAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        size_t tag = *((size_t*) memory - 1);
+        if(tag & PINNED_BIT) {
+            void* block = memory - (tag & ~PINNED_BIT);
+            onDeallocate(memory, BlockPolicy::CheckSize(block));
+            deallocateBlock(block);
+            return;
+        }
+
+        Entry& entry = mHandles[tag];
+        ASSERT(entry.memory == memory);
+
+        void* block = memory - sizeof(size_t);
+        onDeallocate((void*) (((Handle) entry.generation << 32) | tag), BlockPolicy::CheckSize(block)); //traced by the handle, the address may change
+        deallocateBlock(block);
+
+        entry.memory = nullptr;
+        if(++entry.generation == 0) { //a handle is never NULL_HANDLE
+            entry.generation = 1;
+        }
+
+        entry.nextFree = mFreeHandle;
+        mFreeHandle = (uint32_t) tag;
+    }
+
+    size_t HandleAllocator::getUsableSize(void* memory) {
+        size_t tag = *((size_t*) memory - 1);
+        size_t header = tag & PINNED_BIT ? tag & ~PINNED_BIT : sizeof(size_t); //the block of a handle starts with its tag
+        return BlockPolicy::CheckSize(memory - header) - sizeof(size_t) - header;
+    }
+
+    void HandleAllocator::clear() {
+        mPolicy.clear();
+        mFreeSize = (mSize - alignToWord(mNumOfHandles * sizeof(Entry))) & ~(sizeof(size_t) - 1);
+        mCursor = nullptr;
+
+        for(size_t i = 0; i < mNumOfHandles; i++) {
+            if(mHandles[i].memory != nullptr && ++mHandles[i].generation == 0) {
+                mHandles[i].generation = 1;
+            }
+
+            mHandles[i].memory = nullptr;
+            mHandles[i].nextFree = i + 1 < mNumOfHandles ? (uint32_t) (i + 1) : (uint32_t) NO_SLOT;
+        }
+
+        mFreeHandle = 0;
+
+        onClear();
+    }
+
+    Handle HandleAllocator::allocateHandle(const size_t& size) {
+        ASSERT(size > 0);
+
+        if(mFreeHandle == NO_SLOT) { //every handle is in use
+            ASSERT(false);
+            onFailedAllocation(size);
+            return NULL_HANDLE;
+        }
+
+        uint32_t slot = mFreeHandle;
+        void* memory = allocateBlock(size, 0, slot);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return NULL_HANDLE;
+        }
+
+        Entry& entry = mHandles[slot];
+        mFreeHandle = entry.nextFree;
+        entry.memory = memory;
+
+        Handle handle = ((Handle) entry.generation << 32) | slot;
+        onAllocate((void*) handle, size, BlockPolicy::CheckSize(memory - sizeof(size_t)));
+        return handle;
+    }
+
+    void HandleAllocator::deallocateHandle(Handle handle) {
+        void* memory = resolve(handle);
+        ASSERT(memory != nullptr);
+
+        if(memory != nullptr) {
+            deallocate(memory);
+        }
+    }
+
+    void* HandleAllocator::resolve(Handle handle) const {
+        uint32_t slot = (uint32_t) handle;
+        if(slot >= mNumOfHandles || mHandles[slot].generation != (uint32_t) (handle >> 32)) { //deallocated meanwhile
+            return nullptr;
+        }
+
+        return mHandles[slot].memory;
+    }
+
+    size_t HandleAllocator::defragment(const size_t& maxBytesMoved) {
+        return mPolicy.compact(mCursor, maxBytesMoved, [this](void* block, void* newBlock) {
+            size_t tag = *((size_t*) block);
+            if(tag & PINNED_BIT) {
+                return false;
+            }
+
+            mHandles[tag].memory = newBlock + sizeof(size_t);
+            return true;
+        });
+    }
+
+    size_t HandleAllocator::getLargestFreeBlock() {
+        size_t largest = mPolicy.getLargestFreeBlock();
+        return largest > sizeof(size_t) ? largest - sizeof(size_t) : 0; //the tag stays
+    }
+
+    double HandleAllocator::getFragmentation() {
+        size_t largest = mPolicy.getLargestFreeBlock();
+        if(mFreeSize == 0 || largest == 0) {
+            return 0.0;
+        }
+
+        return 1.0 - (double) (largest + sizeof(size_t)) / mFreeSize; //the header of the block counts as free
+    }
+}//mfg
@@ -0,0 +1,298 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "HeapProfiler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mfg {
+    namespace {
+        std::atomic<uint64_t> sNextId(1);
+
+        struct ThreadState {
+            uint64_t id = 0; //profiler of the countdown
+            int64_t countdown = 0; //bytes until the next sample
+            uint64_t random = 0; //xorshift state
+            bool busy = false; //the profiler itself is running, its own allocations are not sampled
+        };
+
+        thread_local ThreadState tState;
+
+        int64_t nextDistance(ThreadState& state, const size_t& sampleRate) {
+            if(state.random == 0) {
+                state.random = ((uint64_t) (uintptr_t) &state ^ (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count()) | 1;
+            }
+
+            state.random ^= state.random << 13;
+            state.random ^= state.random >> 7;
+            state.random ^= state.random << 17;
+
+            double uniform = ((state.random >> 11) + 0.5) / 9007199254740992.0; //in (0, 1)
+            return (int64_t) (-log(uniform) * sampleRate) + 1;
+        }
+
+        std::string symbolize(void* address) {
+            Dl_info info;
+            char buffer[32];
+            if(dladdr(address, &info) == 0 || info.dli_fname == nullptr) {
+                snprintf(buffer, sizeof(buffer), "0x%llx", (unsigned long long) (uintptr_t) address);
+                return buffer;
+            }
+
+            if(info.dli_sname != nullptr) {
+                int status = 0;
+                char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                std::string name = status == 0 ? demangled : info.dli_sname;
+                free(demangled);
+                return name;
+            }
+
+            //a static function, the offset in the binary can be resolved by addr2line
+            const char* file = strrchr(info.dli_fname, '/');
+            snprintf(buffer, sizeof(buffer), "+0x%llx", (unsigned long long) ((uintptr_t) address - (uintptr_t) info.dli_fbase));
+            return std::string(file != nullptr ? file + 1 : info.dli_fname) + buffer;
+        }
+    }
+
+    HeapProfiler::HeapProfiler(const size_t& sampleRate, const size_t& maxSamples) :
+        mSampleRate(sampleRate > 0 ? sampleRate : 1),
+        mMaxSamples(maxSamples),
+        mId(sNextId++),
+        mFilter(new std::atomic<uint16_t>[FILTER_SIZE]),
+        mNumOfDropped(0)
+    {
+        for(size_t i = 0; i < FILTER_SIZE; i++) {
+            mFilter[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    HeapProfiler::~HeapProfiler() {
+        delete[] mFilter;
+    }
+
+    size_t HeapProfiler::FilterIndex(uintptr_t address) {
+        return (size_t) (((uint64_t) address * 0x9E3779B97F4A7C15ull) >> 48);
+    }
+
+    __attribute__((noinline)) void HeapProfiler::addSample(const Allocator* allocator, void* memory, const size_t& size) {
+        void* frames[MAX_FRAMES + 2];
+        int depth = backtrace(frames, MAX_FRAMES + 2);
+        int skipped = depth > 2 ? 2 : depth; //addSample() and recordAllocate()
+
+        Sample sample;
+        sample.allocator = allocator;
+        sample.size = size;
+
+        double probability = 1.0 - exp(-(double) size / mSampleRate);
+        sample.weight = probability > 0.0 ? (size_t) (size / probability) : mSampleRate;
+
+        sample.depth = depth - skipped;
+        memcpy(sample.frames, frames + skipped, sample.depth * sizeof(void*));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(mSamples.size() >= mMaxSamples) {
+            mNumOfDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto result = mSamples.emplace((uintptr_t) memory, sample);
+        if(result.second) {
+            mFilter[FilterIndex((uintptr_t) memory)].fetch_add(1, std::memory_order_relaxed);
+        }
+        else { //the deallocation has not been seen
+            result.first->second = sample;
+        }
+    }
+
+    void HeapProfiler::recordAllocate(const Allocator* allocator, void* memory, const size_t& size) {
+        ThreadState& state = tState;
+        if(state.busy) {
+            return;
+        }
+
+        if(state.id != mId) { //the distance is memoryless, it can be drawn again
+            state.id = mId;
+            state.countdown = nextDistance(state, mSampleRate);
+        }
+
+        state.countdown -= (int64_t) size;
+        if(state.countdown > 0) {
+            return;
+        }
+
+        state.busy = true;
+        state.countdown = nextDistance(state, mSampleRate);
+        addSample(allocator, memory, size);
+        state.busy = false;
+    }
+
+    void HeapProfiler::recordDeallocate(void* memory) {
+        std::atomic<uint16_t>& counter = mFilter[FilterIndex((uintptr_t) memory)];
+        if(counter.load(std::memory_order_relaxed) == 0 || tState.busy) { //surely not sampled
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(mSamples.erase((uintptr_t) memory) > 0) {
+            counter.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void HeapProfiler::recordRelease(const Allocator* allocator, const void* begin, const void* end) {
+        tState.busy = true;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for(auto it = mSamples.begin(); it != mSamples.end();) {
+                if(it->second.allocator == allocator && it->first >= (uintptr_t) begin && it->first < (uintptr_t) end) {
+                    mFilter[FilterIndex(it->first)].fetch_sub(1, std::memory_order_relaxed);
+                    it = mSamples.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        tState.busy = false;
+    }
+
+    void HeapProfiler::recordClear(const Allocator* allocator) {
+        recordRelease(allocator, (const void*) 0, (const void*) UINTPTR_MAX);
+    }
+
+    bool HeapProfiler::writeFolded(const char* path) const {
+        FILE* file = fopen(path, "w");
+        if(file == nullptr) {
+            return false;
+        }
+
+        tState.busy = true;
+        {
+            std::map<std::vector<void*>, size_t> stacks; //estimated bytes by call stack
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for(const auto& entry : mSamples) {
+                    const Sample& sample = entry.second;
+                    stacks[std::vector<void*>(sample.frames, sample.frames + sample.depth)] += sample.weight;
+                }
+            }
+
+            std::unordered_map<void*, std::string> symbols;
+            for(const auto& stack : stacks) {
+                std::string line;
+                for(size_t i = stack.first.size(); i-- > 0;) { //the outermost first
+                    auto symbol = symbols.find(stack.first[i]);
+                    if(symbol == symbols.end()) {
+                        symbol = symbols.emplace(stack.first[i], symbolize(stack.first[i])).first;
+                    }
+
+                    if(!line.empty()) {
+                        line += ';';
+                    }
+                    line += symbol->second;
+                }
+
+                fprintf(file, "%s %zu\n", line.empty() ? "[unknown]" : line.c_str(), stack.second);
+            }
+        }
+        tState.busy = false;
+
+        return fclose(file) == 0;
+    }
+
+    bool HeapProfiler::writePprof(const char* path) const {
+        FILE* file = fopen(path, "w");
+        if(file == nullptr) {
+            return false;
+        }
+
+        tState.busy = true;
+        {
+            struct Bucket {
+                size_t count;
+                size_t bytes;
+            };
+
+            std::map<std::vector<void*>, Bucket> stacks; //sampled blocks by call stack, pprof scales them
+            size_t count = 0;
+            size_t bytes = 0;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for(const auto& entry : mSamples) {
+                    const Sample& sample = entry.second;
+                    Bucket& bucket = stacks[std::vector<void*>(sample.frames, sample.frames + sample.depth)];
+                    bucket.count++;
+                    bucket.bytes += sample.size;
+                    count++;
+                    bytes += sample.size;
+                }
+            }
+
+            fprintf(file, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n", count, bytes, count, bytes, mSampleRate);
+            for(const auto& stack : stacks) {
+                fprintf(file, "%zu: %zu [%zu: %zu] @", stack.second.count, stack.second.bytes, stack.second.count, stack.second.bytes);
+                for(void* frame : stack.first) { //the innermost first
+                    fprintf(file, " 0x%llx", (unsigned long long) (uintptr_t) frame);
+                }
+                fprintf(file, "\n");
+            }
+
+            fprintf(file, "\nMAPPED_LIBRARIES:\n");
+            FILE* maps = fopen("/proc/self/maps", "r");
+            if(maps != nullptr) {
+                char buffer[4096];
+                size_t read;
+                while((read = fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+                    fwrite(buffer, 1, read, file);
+                }
+                fclose(maps);
+            }
+        }
+        tState.busy = false;
+
+        return fclose(file) == 0;
+    }
+
+    size_t HeapProfiler::getNumberOfSamples() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSamples.size();
+    }
+
+    size_t HeapProfiler::getEstimatedLiveSize() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        size_t size = 0;
+        for(const auto& entry : mSamples) {
+            size += entry.second.weight;
+        }
+
+        return size;
+    }
+
+    uint64_t HeapProfiler::getNumberOfDropped() const { return mNumOfDropped.load(std::memory_order_relaxed); }
+
+    const size_t& HeapProfiler::getSampleRate() const { return mSampleRate; }
+}//mfg
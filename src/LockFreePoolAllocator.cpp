@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LockFreePoolAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        const uint32_t NO_BLOCK = ~(uint32_t) 0; //index of the end of the free list
+
+        inline uint64_t makeHead(const uint64_t& oldHead, const uint32_t& index) {
+            return (((oldHead >> 32) + 1) << 32) | index;
+        }
+    }
+
+    LockFreePoolAllocator::LockFreePoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory) :
+        Allocator(memory, size, zeroMemory),
+        mHead(makeHead(0, NO_BLOCK)),
+        mNext(0),
+        mBlockSize(blockSize),
+        mNumberOfBlocks(size / blockSize),
+        mZeroMemory(zeroMemory)
+    {
+        ASSERT(blockSize >= sizeof(void*));
+        ASSERT(mNumberOfBlocks < NO_BLOCK);
+    }
+
+    LockFreePoolAllocator::~LockFreePoolAllocator() {}
+
+    void* LockFreePoolAllocator::allocate(const size_t& size) {
+        ASSERT(size <= mBlockSize);
+
+        void* block = nullptr;
+        uint64_t head = mHead.load(std::memory_order_acquire);
+
+        while((uint32_t) head != NO_BLOCK) {
+            block = mMemory + (uint32_t) head * mBlockSize;
+            //the block may be taken by an other thread meanwhile, then the tag makes the swap fail
+            uint64_t newHead = makeHead(head, __atomic_load_n((uint32_t*) block, __ATOMIC_RELAXED));
+            if(mHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+                break;
+            }
+
+            block = nullptr;
+        }
+
+        if(block == nullptr) { //the free list is empty, take a block which has never been used
+            size_t next = mNext.load(std::memory_order_relaxed);
+            do {
+                if(next >= mNumberOfBlocks) { //every block is in use
+                    onFailedAllocation(size);
+                    return nullptr;
+                }
+            } while(!mNext.compare_exchange_weak(next, next + 1, std::memory_order_relaxed));
+
+            block = mMemory + next * mBlockSize;
+        }
+
+        onAllocate(block, size, mBlockSize);
+        return block;
+    }
+
+    void* LockFreePoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if((((uintptr_t) mMemory | mBlockSize) & (alignment - 1)) != 0) { //the blocks are not aligned
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        return allocate(size);
+    }
+
+    void LockFreePoolAllocator::deallocate(void* memory) {
+        ASSERT(memory >= mMemory && memory < mMemory + mNumberOfBlocks * mBlockSize);
+
+        onDeallocate(memory, mBlockSize); //an other thread may take the block right after the push
+
+        if(mZeroMemory) {
+            memset(memory, 0, mBlockSize);
+        }
+
+        uint32_t index = (uint32_t) (((uintptr_t) memory - (uintptr_t) mMemory) / mBlockSize);
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+
+        do {
+            __atomic_store_n((uint32_t*) memory, (uint32_t) head, __ATOMIC_RELAXED);
+        } while(!mHead.compare_exchange_weak(head, makeHead(head, index), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    size_t LockFreePoolAllocator::getUsableSize(void* memory) { return mBlockSize; }
+
+    void LockFreePoolAllocator::clear() {
+        if(mZeroMemory) { //the blocks after mNext have not been touched since the last time
+            memset(mMemory, 0, mNext.load(std::memory_order_relaxed) * mBlockSize);
+        }
+
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+        mHead.store(makeHead(head, NO_BLOCK), std::memory_order_relaxed);
+        mNext.store(0, std::memory_order_release);
+
+        onClear();
+    }
+
+    const size_t& LockFreePoolAllocator::getBlockSize() const { return mBlockSize; }
+}//mfg
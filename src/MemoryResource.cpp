@@ -0,0 +1,55 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "MemoryResource.hpp"
+
+#include <new>
+
+namespace mfg {
+    MemoryResource::MemoryResource(Allocator* allocator) :
+        mAllocator(allocator)
+    {
+        ASSERT(allocator != nullptr);
+
+        mMonotonic = !allocator->canDeallocate();
+    }
+
+    Allocator* MemoryResource::getAllocator() const { return mAllocator; }
+    bool MemoryResource::isMonotonic() const { return mMonotonic; }
+
+    void* MemoryResource::do_allocate(size_t bytes, size_t alignment) {
+        void* memory = mAllocator->allocate(bytes > 0 ? bytes : 1, alignment);
+        if(memory == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return memory;
+    }
+
+    void MemoryResource::do_deallocate(void* memory, size_t bytes, size_t alignment) {
+        if(mMonotonic) { //the memory comes back only when the allocator is cleared
+            return;
+        }
+
+        mAllocator->deallocate(memory);
+    }
+
+    bool MemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        const MemoryResource* resource = dynamic_cast<const MemoryResource*>(&other);
+        return resource != nullptr && resource->mAllocator == mAllocator;
+    }
+}//mfg
@@ -0,0 +1,266 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "NumaArena.hpp"
+
+#include <cstdio>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace mfg {
+    namespace {
+        enum : int {
+            MPOL_PREFERRED_MODE = 1, //MPOL_PREFERRED of <numaif.h>, libnuma is not needed for one syscall
+            MPOL_MF_MOVE_FLAG = 1 << 1 //MPOL_MF_MOVE
+        };
+
+        struct Topology { //the nodes are counted from 0 even if the numbering of the system has holes
+            std::vector<int> ids; //number of each node in the system
+            std::vector<std::vector<int>> cpus; //CPUs of each node
+            std::vector<size_t> nodeOfCpu; //node of each CPU
+        };
+
+        std::vector<int> parseList(const char* path) { //"0-3,8-11"
+            std::vector<int> items;
+            FILE* file = fopen(path, "r");
+            if(file == nullptr) {
+                return items;
+            }
+
+            int first;
+            while(fscanf(file, "%d", &first) == 1) {
+                int last = first;
+                int separator = fgetc(file);
+                if(separator == '-') {
+                    if(fscanf(file, "%d", &last) != 1) {
+                        break;
+                    }
+                    separator = fgetc(file);
+                }
+
+                for(int item = first; item <= last; item++) {
+                    items.push_back(item);
+                }
+
+                if(separator != ',') {
+                    break;
+                }
+            }
+
+            fclose(file);
+            return items;
+        }
+
+        const Topology& topology() {
+            static Topology topology = [] {
+                Topology result;
+                std::vector<int> ids = parseList("/sys/devices/system/node/online");
+                for(int id : ids) {
+                    char path[64];
+                    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+
+                    size_t node = result.ids.size();
+                    result.ids.push_back(id);
+                    result.cpus.push_back(parseList(path));
+                    for(int cpu : result.cpus.back()) {
+                        if(cpu >= (int) result.nodeOfCpu.size()) {
+                            result.nodeOfCpu.resize(cpu + 1, 0);
+                        }
+                        result.nodeOfCpu[cpu] = node;
+                    }
+                }
+
+                if(result.cpus.empty()) { //no sysfs, one node with every CPU
+                    result.ids.push_back(0);
+                    result.cpus.emplace_back();
+                }
+
+                return result;
+            }();
+
+            return topology;
+        }
+
+        bool bindMemory(void* memory, const size_t& size, const size_t& node) {
+            unsigned long mask[4] = {0, 0, 0, 0};
+            size_t id = topology().ids[node]; //the kernel takes the number of the system
+            if(id >= sizeof(mask) * 8) {
+                return false;
+            }
+
+            mask[id / (sizeof(unsigned long) * 8)] |= 1ul << (id % (sizeof(unsigned long) * 8));
+            return syscall(SYS_mbind, memory, size, MPOL_PREFERRED_MODE, mask, sizeof(mask) * 8, MPOL_MF_MOVE_FLAG) == 0;
+        }
+
+        void touchFrom(void* memory, const size_t& size, const size_t& node) {
+            std::thread toucher([memory, size, node] {
+                NumaChunkSource::BindThread(node);
+
+                size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+                for(size_t offset = 0; offset < size; offset += pageSize) { //the first write places the page
+                    *((volatile char*) memory + offset) = 0;
+                }
+            });
+            toucher.join();
+        }
+
+        struct ThreadEntry {
+            uint64_t id;
+            void* arena;
+        };
+
+        std::atomic<uint64_t> sNextId(1);
+        thread_local std::vector<ThreadEntry> tEntries; //arenas of the thread by the id of their NumaArena
+    }
+
+    NumaChunkSource::NumaChunkSource(const size_t& node) :
+        mNode(node)
+    {
+        ASSERT(node < GetNumberOfNodes());
+    }
+
+    void* NumaChunkSource::acquire(const size_t& size) {
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED) {
+            return nullptr;
+        }
+
+        if(GetNumberOfNodes() > 1 && !bindMemory(memory, size, mNode)) { //no permission or no NUMA support in the kernel
+            touchFrom(memory, size, mNode);
+        }
+
+        return memory;
+    }
+
+    void NumaChunkSource::release(void* memory, const size_t& size) {
+        munmap(memory, size);
+    }
+
+    const size_t& NumaChunkSource::getNode() const { return mNode; }
+
+    size_t NumaChunkSource::GetNumberOfNodes() { return topology().cpus.size(); }
+
+    size_t NumaChunkSource::GetCurrentNode() {
+        int cpu = sched_getcpu();
+        const std::vector<size_t>& nodeOfCpu = topology().nodeOfCpu;
+        return cpu >= 0 && (size_t) cpu < nodeOfCpu.size() ? nodeOfCpu[cpu] : 0;
+    }
+
+    bool NumaChunkSource::BindThread(const size_t& node) {
+        if(node >= GetNumberOfNodes() || topology().cpus[node].empty()) {
+            return false;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(int cpu : topology().cpus[node]) {
+            CPU_SET(cpu, &set);
+        }
+
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+
+    NumaArena::NumaArena(const size_t& poolSize, const size_t& blockSize, const size_t& stackSize) :
+        mPoolSize((poolSize + ChunkSource::CHUNK_ALIGNMENT - 1) & ~(size_t) (ChunkSource::CHUNK_ALIGNMENT - 1)),
+        mBlockSize(blockSize),
+        mStackSize(stackSize),
+        mId(sNextId++)
+    {
+        ASSERT(poolSize >= blockSize && blockSize >= sizeof(void*));
+        ASSERT(stackSize > 0);
+
+        for(size_t node = 0; node < NumaChunkSource::GetNumberOfNodes(); node++) {
+            mSources.push_back(new NumaChunkSource(node));
+        }
+    }
+
+    NumaArena::~NumaArena() {
+        for(ThreadArena* arena : mArenas) {
+            delete arena->pool;
+            delete arena->stack;
+            mSources[arena->node]->release(arena->memory, arena->size);
+            delete arena;
+        }
+
+        for(NumaChunkSource* source : mSources) {
+            delete source;
+        }
+    }
+
+    NumaArena::ThreadArena* NumaArena::getThreadArena() {
+        for(const ThreadEntry& entry : tEntries) {
+            if(entry.id == mId) {
+                return (ThreadArena*) entry.arena;
+            }
+        }
+
+        return createThreadArena();
+    }
+
+    NumaArena::ThreadArena* NumaArena::createThreadArena() {
+        size_t node = NumaChunkSource::GetCurrentNode();
+        size_t size = mPoolSize + mStackSize;
+
+        void* memory = mSources[node]->acquire(size);
+        ASSERT(memory != nullptr);
+
+        if(memory == nullptr) {
+            return nullptr;
+        }
+
+        //the pages are on the node already, the constructors only write them
+        ThreadArena* arena = new ThreadArena;
+        arena->memory = memory;
+        arena->size = size;
+        arena->node = node;
+        arena->pool = new PoolAllocator(memory, mPoolSize, mBlockSize);
+        arena->stack = new StackAllocator(memory + mPoolSize, mStackSize);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mArenas.push_back(arena);
+        }
+
+        tEntries.push_back({mId, arena});
+        return arena;
+    }
+
+    PoolAllocator* NumaArena::getPool() {
+        ThreadArena* arena = getThreadArena();
+        return arena != nullptr ? arena->pool : nullptr;
+    }
+
+    StackAllocator* NumaArena::getStack() {
+        ThreadArena* arena = getThreadArena();
+        return arena != nullptr ? arena->stack : nullptr;
+    }
+
+    size_t NumaArena::getNode() {
+        ThreadArena* arena = getThreadArena();
+        return arena != nullptr ? arena->node : NumaChunkSource::GetCurrentNode();
+    }
+
+    size_t NumaArena::getNumberOfNodes() const { return mSources.size(); }
+
+    size_t NumaArena::getNumberOfThreads() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mArenas.size();
+    }
+}//mfg
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "OwnedBlockAllocator.hpp"
+
+namespace mfg {
+    OwnedBlockAllocator::OwnedBlockAllocator(void* memory, const size_t& size) :
+        Allocator(memory, size),
+        mPolicy(memory, size)
+    {}
+
+    OwnedBlockAllocator::~OwnedBlockAllocator() {}
+
+    void* OwnedBlockAllocator::allocate(const size_t& size) {
+        ASSERT(mRemote.isOwner());
+        ASSERT(size > 0);
+
+        if(!mRemote.isEmpty()) {
+            drainRemoteFrees();
+        }
+
+        void* memory = mPolicy.allocate(size);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, BlockPolicy::CheckSize(memory));
+        return memory;
+    }
+
+    void* OwnedBlockAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(mRemote.isOwner());
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if(!mRemote.isEmpty()) {
+            drainRemoteFrees();
+        }
+
+        void* memory = mPolicy.allocate(size, alignment);
+        if(memory == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        onAllocate(memory, size, BlockPolicy::CheckSize(memory), alignment);
+        return memory;
+    }
+
+    void OwnedBlockAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        if(!mRemote.isOwner()) { //the owner merges it later, the header stays untouched
+            mRemote.push(memory);
+            return;
+        }
+
+        onDeallocate(memory, BlockPolicy::CheckSize(memory));
+        mPolicy.deallocate(memory);
+    }
+
+    size_t OwnedBlockAllocator::getUsableSize(void* memory) { return BlockPolicy::CheckSize(memory) - sizeof(size_t); }
+
+    void OwnedBlockAllocator::clear() {
+        ASSERT(mRemote.isOwner());
+
+        mRemote.takeAll(); //every block becomes free anyway
+        memset(mMemory, 0, mSize);
+        mPolicy.clear();
+        onClear();
+    }
+
+    size_t OwnedBlockAllocator::getLargestFreeBlock() { return mPolicy.getLargestFreeBlock(); }
+
+    void OwnedBlockAllocator::drainRemoteFrees() {
+        ASSERT(mRemote.isOwner());
+
+        void* block = mRemote.takeAll();
+        while(block != nullptr) {
+            void* next = RemoteFreeList::Next(block); //merging may overwrite the link
+            onDeallocate(block, BlockPolicy::CheckSize(block));
+            mPolicy.deallocate(block);
+            block = next;
+        }
+    }
+
+    bool OwnedBlockAllocator::isOwner() const { return mRemote.isOwner(); }
+
+    void OwnedBlockAllocator::setOwner() { mRemote.setOwner(); }
+}//mfg
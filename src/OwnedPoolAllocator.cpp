@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "OwnedPoolAllocator.hpp"
+
+namespace mfg {
+    OwnedPoolAllocator::OwnedPoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory) :
+        Allocator(memory, size, false),
+        mPolicy(memory, size, blockSize, zeroMemory)
+    {
+        ASSERT(blockSize >= sizeof(void*));
+    }
+
+    OwnedPoolAllocator::~OwnedPoolAllocator() {}
+
+    void* OwnedPoolAllocator::allocate(const size_t& size) {
+        ASSERT(mRemote.isOwner());
+        ASSERT(size <= mPolicy.getBlockSize());
+
+        if(!mRemote.isEmpty()) {
+            drainRemoteFrees();
+        }
+
+        void* memory = mPolicy.allocate(size);
+        if(memory != nullptr) {
+            onAllocate(memory, size, mPolicy.getBlockSize());
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return memory;
+    }
+
+    void* OwnedPoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(mRemote.isOwner());
+        ASSERT(size <= mPolicy.getBlockSize());
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if(!mRemote.isEmpty()) {
+            drainRemoteFrees();
+        }
+
+        void* memory = mPolicy.allocate(size, alignment);
+        if(memory != nullptr) {
+            onAllocate(memory, size, mPolicy.getBlockSize(), alignment);
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return memory;
+    }
+
+    void OwnedPoolAllocator::deallocate(void* memory) {
+        if(!mRemote.isOwner()) { //the owner deallocates it later
+            mRemote.push(memory);
+            return;
+        }
+
+        onDeallocate(memory, mPolicy.getBlockSize());
+        mPolicy.deallocate(memory);
+    }
+
+    size_t OwnedPoolAllocator::getUsableSize(void* memory) { return getBlockSize(); }
+
+    void OwnedPoolAllocator::clear() {
+        ASSERT(mRemote.isOwner());
+
+        mRemote.takeAll(); //every block becomes free anyway
+        mPolicy.clear();
+        onClear();
+    }
+
+    size_t OwnedPoolAllocator::getLargestFreeBlock() { return mPolicy.getLargestFreeBlock(); }
+
+    void OwnedPoolAllocator::drainRemoteFrees() {
+        ASSERT(mRemote.isOwner());
+
+        void* block = mRemote.takeAll();
+        while(block != nullptr) {
+            void* next = RemoteFreeList::Next(block); //the policy overwrites the link
+            onDeallocate(block, mPolicy.getBlockSize());
+            mPolicy.deallocate(block);
+            block = next;
+        }
+    }
+
+    bool OwnedPoolAllocator::isOwner() const { return mRemote.isOwner(); }
+
+    void OwnedPoolAllocator::setOwner() { mRemote.setOwner(); }
+
+    const size_t& OwnedPoolAllocator::getBlockSize() const { return mPolicy.getBlockSize(); }
+}//mfg
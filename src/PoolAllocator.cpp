@@ -18,55 +18,80 @@ freely, subject to the following restrictions:
 #include "PoolAllocator.hpp"
 
 namespace mfg {
-    PoolAllocator::PoolAllocator(void* memory, const size_t& size, const size_t& blockSize) :
-        Allocator(memory, size),
-        mPool(nullptr),
-        mBlockSize(blockSize)
+    PoolAllocator::PoolAllocator(void* memory, const size_t& size, const size_t& blockSize, const bool& zeroMemory) :
+        Allocator(memory, size, false),
+        mPolicy(memory, size, blockSize, zeroMemory)
     {
         ASSERT(blockSize >= sizeof(void*));
-
-        clear();
     }
 
     PoolAllocator::~PoolAllocator() {}
 
     void* PoolAllocator::allocate(const size_t& size) {
         ASSERT(mMemory != nullptr);
-        ASSERT(size <= mBlockSize);
+        ASSERT(size <= mPolicy.getBlockSize());
+
+        void* memory = mPolicy.allocate(size);
+        if(memory != nullptr) {
+            onAllocate(memory, size, mPolicy.getBlockSize());
+        }
+        else {
+            onFailedAllocation(size);
+        }
+
+        return memory;
+    }
 
-        void* temp = mPool;
-        mPool = (void**) *mPool;
+    void* PoolAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size <= mPolicy.getBlockSize());
+        ASSERT((alignment & (alignment - 1)) == 0);
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed += mBlockSize;
-        mMrNumOfAllocations++;
-#endif
+        void* memory = mPolicy.allocate(size, alignment);
+        if(memory != nullptr) {
+            onAllocate(memory, size, mPolicy.getBlockSize(), alignment);
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
 
-        return temp;
+        return memory;
     }
 
     void PoolAllocator::deallocate(void* memory) {
-        memset(memory, 0, mBlockSize);
-        *((void**) memory) = mPool;
-        mPool = (void**) memory;
-
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed -= mBlockSize;
-        mMrNumOfAllocations--;
-#endif
+        onDeallocate(memory, mPolicy.getBlockSize());
+        mPolicy.deallocate(memory);
     }
 
-    void PoolAllocator::clear() {
-        memset(mMemory, 0, mSize);
+    size_t PoolAllocator::allocateBatch(const size_t& count, void** memory) {
+        ASSERT(memory != nullptr);
+
+        size_t allocated = mPolicy.allocateBatch(count, memory);
+        if(allocated > 0) {
+            onAllocateBatch(memory, mPolicy.getBlockSize(), allocated * mPolicy.getBlockSize(), allocated);
+        }
 
-        size_t numberOfBlocks = mSize / mBlockSize;
-        mPool = (void**) mMemory;
-        for(size_t i = 0; i < numberOfBlocks; i++) {
-            *mPool = (void*) mPool + mBlockSize;
-            mPool = (void**) *mPool;
+        if(allocated < count) {
+            onFailedAllocation(mPolicy.getBlockSize());
         }
 
-        *mPool = nullptr;
-        mPool = (void**) mMemory;
+        return allocated;
+    }
+
+    void PoolAllocator::deallocateBatch(void** memory, const size_t& count) {
+        ASSERT(memory != nullptr);
+
+        onDeallocateBatch(memory, count * mPolicy.getBlockSize(), count);
+        mPolicy.deallocateBatch(memory, count);
+    }
+
+    size_t PoolAllocator::getUsableSize(void* memory) { return getBlockSize(); }
+
+    void PoolAllocator::clear() {
+        mPolicy.clear();
+        onClear();
     }
+
+    size_t PoolAllocator::getLargestFreeBlock() { return mPolicy.getLargestFreeBlock(); }
+
+    const size_t& PoolAllocator::getBlockSize() const { return mPolicy.getBlockSize(); }
 }//mfg
@@ -0,0 +1,250 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "SlabAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        const size_t SIZE_CLASSES[SlabAllocator::NUM_SIZE_CLASSES] = {
+            8, 16, 24, 32,
+            40, 48, 56, 64,
+            80, 96, 112, 128,
+            160, 192, 224, 256,
+            320, 384, 448, 512,
+            640, 768, 896, 1024
+        };
+    }
+
+    SlabAllocator::SlabAllocator(void* memory, const size_t& size, const size_t& blockMemorySize, const size_t& slabSize) :
+        Allocator(memory, size, false),
+        mBlocks(memory, blockMemorySize),
+        mSlabSize(slabSize)
+    {
+        static_assert(sizeof(Slab) <= SLAB_HEADER_SIZE, "the header of a slab does not fit");
+
+        ASSERT((slabSize & (slabSize - 1)) == 0);
+        ASSERT(slabSize >= SLAB_HEADER_SIZE + 4 * MAX_SMALL_SIZE);
+        ASSERT(blockMemorySize <= size);
+
+        uintptr_t begin = ((uintptr_t) memory + blockMemorySize + slabSize - 1) & ~(uintptr_t) (slabSize - 1);
+        uintptr_t end = ((uintptr_t) memory + size) & ~(uintptr_t) (slabSize - 1);
+
+        mSlabs = (void*) begin;
+        mSlabsSize = end > begin ? end - begin : 0;
+
+        size_t sizeClass = 0;
+        for(size_t i = 0; i <= MAX_SMALL_SIZE / 8; i++) {
+            while(SIZE_CLASSES[sizeClass] < i * 8) {
+                sizeClass++;
+            }
+
+            mSizeToClass[i] = (uint8_t) sizeClass;
+        }
+
+        clear();
+    }
+
+    SlabAllocator::~SlabAllocator() {}
+
+    SlabAllocator::Slab* SlabAllocator::createSlab(const size_t& sizeClass) {
+        Slab* slab;
+        if(mEmptySlabs != nullptr) {
+            slab = mEmptySlabs;
+            mEmptySlabs = slab->next;
+        }
+        else if((uintptr_t) mNextSlab - (uintptr_t) mSlabs < mSlabsSize) {
+            slab = (Slab*) mNextSlab;
+            mNextSlab += mSlabSize;
+        }
+        else { //every slab is in use
+            return nullptr;
+        }
+
+        slab->freeList = nullptr;
+        slab->unused = (void*) slab + (size_t) SLAB_HEADER_SIZE;
+        slab->blockSize = SIZE_CLASSES[sizeClass];
+        slab->used = 0;
+        slab->capacity = (mSlabSize - SLAB_HEADER_SIZE) / slab->blockSize;
+        slab->sizeClass = sizeClass;
+
+        linkSlab(slab);
+        return slab;
+    }
+
+    void* SlabAllocator::allocateFromSlab(const size_t& sizeClass) {
+        Slab* slab = mPartialSlabs[sizeClass];
+        if(slab == nullptr) {
+            slab = createSlab(sizeClass);
+            if(slab == nullptr) {
+                return nullptr;
+            }
+        }
+
+        void* block;
+        if(slab->freeList != nullptr) { //recycled blocks are hot
+            block = slab->freeList;
+            slab->freeList = (void**) *slab->freeList;
+        }
+        else {
+            block = slab->unused;
+            slab->unused += slab->blockSize;
+        }
+
+        if(++slab->used == slab->capacity) { //the slab is full
+            unlinkSlab(slab);
+        }
+
+        return block;
+    }
+
+    void SlabAllocator::linkSlab(Slab* slab) {
+        Slab*& head = mPartialSlabs[slab->sizeClass];
+
+        slab->prev = nullptr;
+        slab->next = head;
+        if(head != nullptr) {
+            head->prev = slab;
+        }
+        head = slab;
+    }
+
+    void SlabAllocator::unlinkSlab(Slab* slab) {
+        if(slab->next != nullptr) {
+            slab->next->prev = slab->prev;
+        }
+
+        if(slab->prev != nullptr) {
+            slab->prev->next = slab->next;
+        }
+        else {
+            mPartialSlabs[slab->sizeClass] = slab->next;
+        }
+    }
+
+    void* SlabAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        void* memory = nullptr;
+        if(size <= MAX_SMALL_SIZE) {
+            memory = allocateFromSlab(mSizeToClass[(size + 7) >> 3]);
+        }
+
+        if(memory == nullptr) { //too big, or there are no more slabs
+            memory = mBlocks.allocate(size);
+            if(memory == nullptr) { //there is no block which fit.
+                ASSERT(false);
+                onFailedAllocation(size);
+                return nullptr;
+            }
+        }
+
+        onAllocate(memory, size, CheckSize(memory));
+        return memory;
+    }
+
+    void* SlabAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        void* memory = nullptr;
+        if(size <= MAX_SMALL_SIZE && alignment <= SLAB_HEADER_SIZE) { //blocks of a class are aligned if their size is
+            size_t sizeClass = mSizeToClass[(size + 7) >> 3];
+            while(sizeClass < NUM_SIZE_CLASSES && (SIZE_CLASSES[sizeClass] & (alignment - 1)) != 0) {
+                sizeClass++;
+            }
+
+            if(sizeClass < NUM_SIZE_CLASSES) {
+                memory = allocateFromSlab(sizeClass);
+            }
+        }
+
+        if(memory == nullptr) { //too big, or there are no more slabs
+            memory = mBlocks.allocate(size, alignment);
+            if(memory == nullptr) { //there is no block which fit.
+                ASSERT(false);
+                onFailedAllocation(size, alignment);
+                return nullptr;
+            }
+        }
+
+        onAllocate(memory, size, CheckSize(memory), alignment);
+        return memory;
+    }
+
+    void SlabAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        onDeallocate(memory, CheckSize(memory));
+
+        if((uintptr_t) memory - (uintptr_t) mSlabs >= mSlabsSize) { //a big block
+            mBlocks.deallocate(memory);
+            return;
+        }
+
+        Slab* slab = (Slab*) ((uintptr_t) memory & ~(uintptr_t) (mSlabSize - 1));
+
+        *((void**) memory) = slab->freeList;
+        slab->freeList = (void**) memory;
+
+        if(slab->used == slab->capacity) { //it was full
+            linkSlab(slab);
+        }
+
+        if(--slab->used == 0 && (slab->prev != nullptr || slab->next != nullptr)) { //the last slab of a class is kept
+            unlinkSlab(slab);
+            slab->next = mEmptySlabs;
+            mEmptySlabs = slab;
+        }
+    }
+
+    size_t SlabAllocator::getUsableSize(void* memory) {
+        if((uintptr_t) memory - (uintptr_t) mSlabs >= mSlabsSize) { //a big block
+            return BlockPolicy::CheckSize(memory) - sizeof(size_t);
+        }
+
+        return CheckSize(memory);
+    }
+
+    void SlabAllocator::clear() {
+        mBlocks.clear();
+        mNextSlab = mSlabs;
+        mEmptySlabs = nullptr;
+        memset(mPartialSlabs, 0, sizeof(mPartialSlabs));
+
+        onClear();
+    }
+
+    size_t SlabAllocator::getLargestFreeBlock() {
+        size_t largest = mBlocks.getLargestFreeBlock();
+        if(largest < MAX_SMALL_SIZE && (mEmptySlabs != nullptr || mPartialSlabs[NUM_SIZE_CLASSES - 1] != nullptr
+            || (uintptr_t) mNextSlab - (uintptr_t) mSlabs < mSlabsSize)) { //the biggest class still has room
+            largest = MAX_SMALL_SIZE;
+        }
+
+        return largest;
+    }
+
+    size_t SlabAllocator::CheckSize(void* memory) const {
+        if((uintptr_t) memory - (uintptr_t) mSlabs >= mSlabsSize) { //a big block
+            return BlockPolicy::CheckSize(memory);
+        }
+
+        return ((Slab*) ((uintptr_t) memory & ~(uintptr_t) (mSlabSize - 1)))->blockSize;
+    }
+
+    const size_t& SlabAllocator::getSlabSize() const { return mSlabSize; }
+}//mfg
@@ -20,7 +20,7 @@ freely, subject to the following restrictions:
 namespace mfg {
     StackAllocator::StackAllocator(void* memory, const size_t& size) :
         Allocator(memory, size),
-        mMarker(0)
+        mPolicy(memory, size)
     {
         ASSERT(size > 0);
     }
@@ -29,41 +29,97 @@ namespace mfg {
 
     void* StackAllocator::allocate(const size_t& size) {
         ASSERT(size > 0);
-        ASSERT(mMarker + size <= mSize);
 
-        mMarker += size;
+        void* memory = mPolicy.allocate(size);
+        ASSERT(memory != nullptr);
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed += size;
-        mMrNumOfAllocations++;
-#endif
+        if(memory != nullptr) {
+            onAllocate(memory, size, size);
+            mCheckpoints.onAllocate();
+        }
+        else {
+            onFailedAllocation(size);
+        }
 
-        return mMemory + mMarker - size;
+        return memory;
+    }
+
+    void* StackAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT(size > 0);
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        Marker marker = mPolicy.getMarker();
+
+        void* memory = mPolicy.allocate(size, alignment);
+        ASSERT(memory != nullptr);
+
+        if(memory != nullptr) {
+            onAllocate(memory, size, mPolicy.getMarker() - marker, alignment); //padding included
+            mCheckpoints.onAllocate();
+        }
+        else {
+            onFailedAllocation(size, alignment);
+        }
+
+        return memory;
     }
 
     void StackAllocator::deallocate(void* memory) {
         ///do nothing, because you have to use deallocateTo
     }
 
+    void* StackAllocator::reallocate(void* memory, const size_t& size) {
+        if(memory == nullptr) {
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+        ASSERT(mPolicy.owns(memory));
+
+        Marker marker = mPolicy.getMarker();
+        size_t offset = (uintptr_t) memory - (uintptr_t) mMemory;
+        if(mPolicy.reallocate(memory, size)) { //recorded as a deallocation and an allocation
+            onDeallocate(memory, marker - offset);
+            onAllocate(memory, size, size);
+            return memory;
+        }
+
+        void* newMemory = allocate(size);
+        if(newMemory == nullptr) {
+            return nullptr;
+        }
+
+        memcpy(newMemory, memory, size < marker - offset ? size : marker - offset); //the old size is unknown, but nothing is above the old marker
+        return newMemory;
+    }
+
+    bool StackAllocator::canDeallocate() const { return false; }
+
     void StackAllocator::deallocateTo(Marker marker) {
-        ASSERT(marker <= mMarker);
+        ASSERT(marker <= mPolicy.getMarker());
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed -= mMarker - marker;
-        mMrNumOfAllocations--;
-#endif
+        onDeallocateTo(marker, mPolicy.getMarker() - marker, mCheckpoints.rollBack(marker), mMemory + marker, mMemory + mPolicy.getMarker());
 
-        mMarker = marker;
+        mPolicy.deallocateTo(marker);
     }
 
     void StackAllocator::clear() {
-        mMarker = 0;
+        mPolicy.clear();
+        mCheckpoints.clear();
 
-#ifdef MFG_MEMORY_REPORT
-        mMrUsed = 0;
-        mMrNumOfAllocations = 0;
-#endif
+        onClear();
     }
 
-    Marker StackAllocator::getMarker() { return mMarker; }
+    size_t StackAllocator::getLargestFreeBlock() { return mPolicy.getLargestFreeBlock(); }
+
+    Marker StackAllocator::getMarker() {
+        Marker marker = mPolicy.takeMarker();
+        if(getStatistics() != nullptr) {
+            mCheckpoints.record(marker);
+        }
+
+        onMarker(marker);
+
+        return marker;
+    }
 }//mfg
@@ -0,0 +1,185 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include "Allocator.hpp"
+
+namespace mfg {
+    namespace {
+        //allocators with statistics, so a snapshot never reads a destroyed one
+        std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::vector<Allocator*>& registry() {
+            static std::vector<Allocator*> allocators;
+            return allocators;
+        }
+    }
+
+    std::atomic<uint32_t> Statistics::sOwnedShards(0);
+
+    Statistics::ShardOwner::ShardOwner() :
+        index(SHARED_SHARD)
+    {
+        uint32_t owned = sOwnedShards.load(std::memory_order_relaxed);
+        for(;;) {
+            uint32_t free = ~owned & (((uint32_t) 1 << SHARED_SHARD) - 1);
+            if(free == 0) { //every shard is taken, share the last one
+                return;
+            }
+
+            size_t candidate = __builtin_ctz(free);
+            if(sOwnedShards.compare_exchange_weak(owned, owned | ((uint32_t) 1 << candidate), std::memory_order_acquire)) {
+                index = candidate;
+                return;
+            }
+        }
+    }
+
+    Statistics::ShardOwner::~ShardOwner() {
+        if(index != SHARED_SHARD) {
+            sOwnedShards.fetch_and(~((uint32_t) 1 << index), std::memory_order_release);
+        }
+    }
+
+    Statistics::Statistics(const char* name) :
+        mHighWaterMark(0),
+        mName(name)
+    {
+        for(Shard& shard : mShards) {
+            shard.allocations = 0;
+            shard.deallocations = 0;
+            shard.failures = 0;
+            shard.used = 0;
+            shard.peak = 0;
+            shard.lowest = 0;
+            for(std::atomic<uint64_t>& bucket : shard.histogram) {
+                bucket = 0;
+            }
+        }
+    }
+
+    void Statistics::recordClear() {
+        //the allocations of one thread may be deallocated by another, so only the sum is balanced
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        for(Shard& shard : mShards) {
+            allocations += shard.allocations.load(std::memory_order_relaxed);
+            deallocations += shard.deallocations.load(std::memory_order_relaxed);
+        }
+
+        if(allocations > deallocations) {
+            mShards[SHARED_SHARD].deallocations.fetch_add(allocations - deallocations, std::memory_order_relaxed);
+        }
+
+        //keep the high-water mark so far, the shards start over from nothing in use
+        sampleUsedSize();
+        for(Shard& shard : mShards) {
+            shard.used.store(0, std::memory_order_relaxed);
+            shard.peak.store(0, std::memory_order_relaxed);
+            shard.lowest.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t Statistics::sampleUsedSize() const {
+        //when a shard reached its peak, every other shard had at least its lowest bytes in use,
+        //so the peak of a shard and the lowest of the others add up to a lower bound
+        int64_t usedSize = 0;
+        int64_t lowest = 0;
+        for(const Shard& shard : mShards) {
+            usedSize += shard.used.load(std::memory_order_relaxed);
+            lowest += shard.lowest.load(std::memory_order_relaxed);
+        }
+
+        int64_t highWaterMark = usedSize;
+        for(const Shard& shard : mShards) {
+            int64_t peak = shard.peak.load(std::memory_order_relaxed) + lowest - shard.lowest.load(std::memory_order_relaxed);
+            highWaterMark = std::max(highWaterMark, peak);
+        }
+        int64_t current = mHighWaterMark.load(std::memory_order_relaxed);
+        while(highWaterMark > current && !mHighWaterMark.compare_exchange_weak(current, highWaterMark, std::memory_order_relaxed));
+
+        return usedSize > 0 ? usedSize : 0;
+    }
+
+    size_t Statistics::getUsedSize() const { return sampleUsedSize(); }
+
+    size_t Statistics::getNumberOfAllocations() const {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        for(const Shard& shard : mShards) {
+            allocations += shard.allocations.load(std::memory_order_relaxed);
+            deallocations += shard.deallocations.load(std::memory_order_relaxed);
+        }
+
+        return allocations > deallocations ? allocations - deallocations : 0;
+    }
+
+    void Statistics::setName(const char* name) { mName = name; }
+
+    void Statistics::snapshot(StatisticsSnapshot& snapshot) const {
+        snapshot.name = mName;
+        snapshot.usedSize = sampleUsedSize();
+        snapshot.highWaterMark = mHighWaterMark.load(std::memory_order_relaxed);
+        snapshot.totalAllocations = 0;
+        snapshot.totalDeallocations = 0;
+        snapshot.failedAllocations = 0;
+        for(size_t i = 0; i < StatisticsSnapshot::NUM_BUCKETS; i++) {
+            snapshot.histogram[i] = 0;
+        }
+
+        for(const Shard& shard : mShards) {
+            snapshot.totalAllocations += shard.allocations.load(std::memory_order_relaxed);
+            snapshot.totalDeallocations += shard.deallocations.load(std::memory_order_relaxed);
+            snapshot.failedAllocations += shard.failures.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < StatisticsSnapshot::NUM_BUCKETS; i++) {
+                snapshot.histogram[i] += shard.histogram[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        snapshot.numOfAllocations = snapshot.totalAllocations > snapshot.totalDeallocations ? snapshot.totalAllocations - snapshot.totalDeallocations : 0;
+    }
+
+    void Statistics::Register(Allocator* allocator) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        if(std::find(registry().begin(), registry().end(), allocator) == registry().end()) {
+            registry().push_back(allocator);
+        }
+    }
+
+    void Statistics::Unregister(Allocator* allocator) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().erase(std::remove(registry().begin(), registry().end(), allocator), registry().end());
+    }
+
+    void Statistics::SnapshotAll(std::vector<StatisticsSnapshot>& snapshots) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        snapshots.clear();
+        for(Allocator* allocator : registry()) {
+            StatisticsSnapshot snapshot;
+            if(allocator->snapshotStatistics(snapshot)) {
+                snapshots.push_back(snapshot);
+            }
+        }
+    }
+}//mfg
@@ -0,0 +1,324 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "TlsfAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        const size_t BLOCK_FREE_BIT = 1; //the block is free
+        const size_t PREV_FREE_BIT = 2;  //the physically previous block is free
+        const size_t SIZE_MASK = ~(BLOCK_FREE_BIT | PREV_FREE_BIT);
+
+        inline size_t findLastSet(const size_t& value) {
+            return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value);
+        }
+    }
+
+    TlsfAllocator::TlsfAllocator(void* memory, const size_t& size, const bool& zeroMemory) :
+        Allocator(memory, size, zeroMemory)
+    {
+        ASSERT(size >= 2 * sizeof(Block));
+
+        clear();
+    }
+
+    TlsfAllocator::~TlsfAllocator() {}
+
+    void TlsfAllocator::insertBlock(Block* block) {
+        size_t size = block->size & SIZE_MASK;
+        size_t fl, sl;
+
+        if(size < SMALL_BLOCK_SIZE) {
+            fl = 0;
+            sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+        }
+        else {
+            fl = findLastSet(size);
+            sl = (size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+            fl -= FL_INDEX_SHIFT - 1;
+        }
+
+        Block* head = mFreeLists[fl][sl];
+        block->nextFree = head;
+        block->prevFree = nullptr;
+        if(head != nullptr) {
+            head->prevFree = block;
+        }
+
+        mFreeLists[fl][sl] = block;
+        mFlBitmap |= (size_t) 1 << fl;
+        mSlBitmap[fl] |= (uint32_t) 1 << sl;
+    }
+
+    void TlsfAllocator::removeBlock(Block* block) {
+        size_t size = block->size & SIZE_MASK;
+        size_t fl, sl;
+
+        if(size < SMALL_BLOCK_SIZE) {
+            fl = 0;
+            sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+        }
+        else {
+            fl = findLastSet(size);
+            sl = (size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+            fl -= FL_INDEX_SHIFT - 1;
+        }
+
+        if(block->nextFree != nullptr) {
+            block->nextFree->prevFree = block->prevFree;
+        }
+
+        if(block->prevFree != nullptr) {
+            block->prevFree->nextFree = block->nextFree;
+        }
+        else { //it was the head of its list
+            mFreeLists[fl][sl] = block->nextFree;
+            if(block->nextFree == nullptr) {
+                mSlBitmap[fl] &= ~((uint32_t) 1 << sl);
+                if(mSlBitmap[fl] == 0) {
+                    mFlBitmap &= ~((size_t) 1 << fl);
+                }
+            }
+        }
+    }
+
+    TlsfAllocator::Block* TlsfAllocator::findSuitableBlock(const size_t& size) {
+        size_t fl, sl;
+
+        if(size < SMALL_BLOCK_SIZE) {
+            fl = 0;
+            sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+        }
+        else { //round up to the next class, so every block in it is big enough
+            size_t rounded = size + ((size_t) 1 << (findLastSet(size) - SL_INDEX_COUNT_LOG2)) - 1;
+            fl = findLastSet(rounded);
+            sl = (rounded >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+            fl -= FL_INDEX_SHIFT - 1;
+        }
+
+        if(fl >= FL_INDEX_COUNT) {
+            return nullptr;
+        }
+
+        uint32_t slMap = mSlBitmap[fl] & (~(uint32_t) 0 << sl);
+        if(slMap == 0) { //no block in this first level class, take the next non-empty one
+            size_t flMap = mFlBitmap & (~(size_t) 0 << (fl + 1));
+            if(flMap == 0) {
+                return nullptr;
+            }
+
+            fl = __builtin_ctzll(flMap);
+            slMap = mSlBitmap[fl];
+        }
+
+        return mFreeLists[fl][__builtin_ctz(slMap)];
+    }
+
+    void* TlsfAllocator::useBlock(Block* block, const size_t& gap, size_t newSize) {
+        size_t blockSize = block->size & SIZE_MASK;
+        size_t prevFree = block->size & PREV_FREE_BIT;
+
+        removeBlock(block);
+
+        if(gap > 0) { //the front of the block stays free
+            block->size = gap | BLOCK_FREE_BIT;
+            insertBlock(block);
+
+            Block* aligned = (Block*) ((void*) block + gap);
+            aligned->prevPhys = block;
+
+            block = aligned;
+            blockSize -= gap;
+            prevFree = PREV_FREE_BIT;
+        }
+
+        if(blockSize - newSize >= sizeof(Block)) { //split, the rest stays free
+            Block* rest = (Block*) ((void*) block + newSize);
+            rest->size = (blockSize - newSize) | BLOCK_FREE_BIT;
+
+            Block* next = (Block*) ((void*) rest + (blockSize - newSize));
+            next->prevPhys = rest;
+
+            insertBlock(rest);
+        }
+        else { //use the whole block
+            Block* next = (Block*) ((void*) block + blockSize);
+            next->size &= ~PREV_FREE_BIT;
+            newSize = blockSize;
+        }
+
+        block->size = newSize | prevFree;
+        return ((void*) block) + offsetof(Block, size) + sizeof(size_t);
+    }
+
+    void* TlsfAllocator::allocate(const size_t& size) {
+        ASSERT(size > 0);
+
+        if(size > ((size_t) 1 << FL_INDEX_MAX)) { //can not be indexed
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        size_t newSize = (size + sizeof(size_t) + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+        if(newSize < sizeof(Block)) {
+            newSize = sizeof(Block);
+        }
+
+        Block* block = findSuitableBlock(newSize);
+        if(block == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size);
+            return nullptr;
+        }
+
+        void* memory = useBlock(block, 0, newSize);
+        onAllocate(memory, size, CheckSize(memory));
+        return memory;
+    }
+
+    void* TlsfAllocator::allocate(const size_t& size, const size_t& alignment) {
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        if(alignment <= ALIGN_SIZE) { //every block is aligned this way
+            return allocate(size);
+        }
+
+        ASSERT(size > 0);
+
+        if(size > ((size_t) 1 << FL_INDEX_MAX)) { //can not be indexed
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        size_t newSize = (size + sizeof(size_t) + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+        if(newSize < sizeof(Block)) {
+            newSize = sizeof(Block);
+        }
+
+        //any block of this size has room for the gap in front of the aligned part
+        Block* block = findSuitableBlock(newSize + alignment + sizeof(Block));
+        if(block == nullptr) { //there is no block which fit.
+            ASSERT(false);
+            onFailedAllocation(size, alignment);
+            return nullptr;
+        }
+
+        uintptr_t begin = (uintptr_t) block + offsetof(Block, size) + sizeof(size_t);
+        size_t gap = ((begin + alignment - 1) & ~(uintptr_t) (alignment - 1)) - begin;
+        if(gap > 0 && gap < sizeof(Block)) { //the skipped space has to be able to become a free block
+            gap = ((begin + sizeof(Block) + alignment - 1) & ~(uintptr_t) (alignment - 1)) - begin;
+        }
+
+        void* memory = useBlock(block, gap, newSize);
+        onAllocate(memory, size, CheckSize(memory), alignment);
+        return memory;
+    }
+
+    void TlsfAllocator::deallocate(void* memory) {
+        ASSERT(memory != nullptr);
+
+        Block* block = (Block*) (memory - offsetof(Block, size) - sizeof(size_t));
+        size_t blockSize = block->size & SIZE_MASK;
+
+        ASSERT((block->size & BLOCK_FREE_BIT) == 0);
+
+        onDeallocate(memory, blockSize);
+
+        Block* next = (Block*) ((void*) block + blockSize);
+
+        if(block->size & PREV_FREE_BIT) { //merge with the previous block
+            Block* prev = block->prevPhys;
+            removeBlock(prev);
+            blockSize += prev->size & SIZE_MASK;
+            block = prev;
+        }
+
+        if(next->size & BLOCK_FREE_BIT) { //merge with the next block
+            removeBlock(next);
+            blockSize += next->size & SIZE_MASK;
+            next = (Block*) ((void*) block + blockSize);
+        }
+
+        block->size = blockSize | BLOCK_FREE_BIT; //the previous block is surely in use
+        next->prevPhys = block;
+        next->size |= PREV_FREE_BIT;
+
+        insertBlock(block);
+    }
+
+    size_t TlsfAllocator::getUsableSize(void* memory) { return CheckSize(memory) - sizeof(size_t); }
+
+    void TlsfAllocator::clear() {
+        mFlBitmap = 0;
+        memset(mSlBitmap, 0, sizeof(mSlBitmap));
+        memset(mFreeLists, 0, sizeof(mFreeLists));
+
+        void* begin = (void*) (((uintptr_t) mMemory + ALIGN_SIZE - 1) & ~(uintptr_t) (ALIGN_SIZE - 1));
+        void* end = (void*) (((uintptr_t) mMemory + mSize) & ~(uintptr_t) (ALIGN_SIZE - 1));
+
+        //a zero sized block in use at the end, so merging never runs out of the memory
+        Block* sentinel = (Block*) (end - offsetof(Block, nextFree));
+        Block* block = (Block*) begin;
+
+        block->prevPhys = nullptr;
+        block->size = ((uintptr_t) sentinel - (uintptr_t) begin) | BLOCK_FREE_BIT;
+        sentinel->prevPhys = block;
+        sentinel->size = PREV_FREE_BIT;
+
+        insertBlock(block);
+
+        onClear();
+    }
+
+    size_t TlsfAllocator::getLargestFreeBlock() {
+        if(mFlBitmap == 0) {
+            return 0;
+        }
+
+        size_t fl = findLastSet(mFlBitmap);
+        size_t sl = findLastSet(mSlBitmap[fl]);
+
+        size_t largest = 0;
+        for(Block* block = mFreeLists[fl][sl]; block != nullptr; block = block->nextFree) {
+            if((block->size & SIZE_MASK) > largest) {
+                largest = block->size & SIZE_MASK;
+            }
+        }
+
+        return largest - sizeof(size_t); //the header stays
+    }
+
+    size_t TlsfAllocator::CheckSize(void* memory) {
+        return *((size_t*) (memory - sizeof(size_t))) & SIZE_MASK;
+    }
+
+#ifdef MFG_DEBUG
+    void TlsfAllocator::printSizeOfBlocks() {
+        for(size_t fl = 0; fl < FL_INDEX_COUNT; fl++) {
+            for(size_t sl = 0; sl < SL_INDEX_COUNT; sl++) {
+                Block* block = mFreeLists[fl][sl];
+                while(block != nullptr) {
+                    std::cout << "blockSize: " << (block->size & SIZE_MASK) << std::endl;
+                    block = block->nextFree;
+                }
+            }
+        }
+    }
+#endif // MFG_DEBUG
+}//mfg
@@ -0,0 +1,290 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "TraceRecorder.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace mfg {
+    namespace {
+        std::atomic<uint64_t> sNextId(1);
+        std::atomic<uint16_t> sNextThread(1);
+
+        //live recorders by id, so an exiting thread never touches a destroyed one
+        std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_map<uint64_t, TraceRecorder*>& registry() {
+            static std::unordered_map<uint64_t, TraceRecorder*> recorders;
+            return recorders;
+        }
+
+        thread_local uint16_t tThread = 0;
+    }
+
+    /*! \class  ThreadTraceSlots
+     *  \brief  The trace buffers of one thread. Gives them back when the thread exits.
+     */
+    class ThreadTraceSlots {
+    public:
+        struct Entry {
+            uint64_t id;
+            TraceRecorder::Slot* slot;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t lastId = 0;
+        TraceRecorder::Slot* lastSlot = nullptr;
+
+        ~ThreadTraceSlots() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for(const Entry& entry : entries) {
+                auto it = registry().find(entry.id);
+                if(it != registry().end()) {
+                    it->second->releaseSlot(entry.slot);
+                }
+            }
+        }
+    };
+
+    namespace {
+        thread_local ThreadTraceSlots tSlots;
+    }
+
+    TraceRecorder::TraceRecorder(const char* path) :
+        mFile(fopen(path, "wb")),
+        mFull(nullptr),
+        mRunning(false),
+        mNextAllocator(0),
+        mNumOfEvents(0),
+        mStart(std::chrono::steady_clock::now()),
+        mId(sNextId++)
+    {
+        if(mFile == nullptr) {
+            return;
+        }
+
+        TraceHeader header;
+        memcpy(header.magic, "MFGTRACE", sizeof(header.magic));
+        header.version = TraceHeader::VERSION;
+        header.eventSize = sizeof(TraceEvent);
+        fwrite(&header, sizeof(header), 1, mFile);
+
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry()[mId] = this;
+        }
+
+        mRunning = true;
+        mWriter = std::thread([this] {
+            while(mRunning.load(std::memory_order_acquire)) {
+                if(!write()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+
+    TraceRecorder::~TraceRecorder() {
+        if(mFile == nullptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().erase(mId);
+        }
+
+        mRunning.store(false, std::memory_order_release);
+        mWriter.join();
+
+        flush();
+        fclose(mFile);
+
+        for(Slot* slot : mSlots) {
+            delete slot->buffer;
+            delete slot;
+        }
+    }
+
+    bool TraceRecorder::isOpen() const { return mFile != nullptr; }
+
+    TraceRecorder::Slot* TraceRecorder::getSlot() {
+        if(tSlots.lastId == mId) {
+            return tSlots.lastSlot;
+        }
+
+        for(const ThreadTraceSlots::Entry& entry : tSlots.entries) {
+            if(entry.id == mId) {
+                tSlots.lastId = mId;
+                tSlots.lastSlot = entry.slot;
+                return entry.slot;
+            }
+        }
+
+        return createSlot();
+    }
+
+    TraceRecorder::Slot* TraceRecorder::createSlot() {
+        {
+            //forget the slots of destroyed recorders
+            std::lock_guard<std::mutex> lock(registryMutex());
+            std::vector<ThreadTraceSlots::Entry>& entries = tSlots.entries;
+            for(size_t i = 0; i < entries.size();) {
+                if(registry().count(entries[i].id) == 0) {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+
+        Slot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for(Slot* orphan : mSlots) {
+                if(orphan->orphan) {
+                    slot = orphan;
+                    break;
+                }
+            }
+
+            if(slot == nullptr) {
+                slot = new Slot;
+                slot->buffer = new Buffer;
+                slot->buffer->count = 0;
+                mSlots.push_back(slot);
+            }
+
+            slot->orphan = false;
+        }
+
+        tSlots.entries.push_back({mId, slot});
+        tSlots.lastId = mId;
+        tSlots.lastSlot = slot;
+
+        return slot;
+    }
+
+    void TraceRecorder::push(Buffer* buffer) {
+        buffer->next = mFull.load(std::memory_order_relaxed);
+        while(!mFull.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void TraceRecorder::releaseSlot(Slot* slot) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(slot->buffer->count > 0) {
+            push(slot->buffer);
+            slot->buffer = new Buffer;
+            slot->buffer->count = 0;
+        }
+
+        slot->orphan = true;
+    }
+
+    bool TraceRecorder::write() {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+
+        Buffer* buffer = mFull.exchange(nullptr, std::memory_order_acquire);
+        if(buffer == nullptr) {
+            return false;
+        }
+
+        Buffer* reversed = nullptr; //the oldest first
+        while(buffer != nullptr) {
+            Buffer* next = buffer->next;
+            buffer->next = reversed;
+            reversed = buffer;
+            buffer = next;
+        }
+
+        while(reversed != nullptr) {
+            Buffer* next = reversed->next;
+            fwrite(reversed->events, sizeof(TraceEvent), reversed->count, mFile);
+            mNumOfEvents.fetch_add(reversed->count, std::memory_order_relaxed);
+            delete reversed;
+            reversed = next;
+        }
+
+        return true;
+    }
+
+    uint16_t TraceRecorder::attach(const Allocator* allocator, const size_t& size, void* memory) {
+        uint16_t index = mNextAllocator++;
+        record(index, TraceEvent::ATTACH, (uintptr_t) memory, size);
+        return index;
+    }
+
+    void TraceRecorder::record(const uint16_t& allocator, const uint8_t& type, const uint64_t& id, const uint64_t& value, const uint8_t& flags, const size_t& alignment) {
+        if(mFile == nullptr) {
+            return;
+        }
+
+        if(tThread == 0) {
+            tThread = sNextThread++;
+        }
+
+        Slot* slot = getSlot();
+        Buffer* buffer = slot->buffer;
+
+        TraceEvent& event = buffer->events[buffer->count++];
+        event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count();
+        event.id = id;
+        event.value = value;
+        event.thread = tThread;
+        event.allocator = allocator;
+        event.type = type;
+        event.flags = flags;
+        event.alignment = alignment > 0 ? __builtin_ctzll(alignment) + 1 : 0;
+        event.reserved = 0;
+
+        if(buffer->count == BUFFER_SIZE) {
+            push(buffer);
+            slot->buffer = new Buffer;
+            slot->buffer->count = 0;
+        }
+    }
+
+    void TraceRecorder::flush() {
+        if(mFile == nullptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for(Slot* slot : mSlots) {
+                if(slot->buffer->count > 0) {
+                    push(slot->buffer);
+                    slot->buffer = new Buffer;
+                    slot->buffer->count = 0;
+                }
+            }
+        }
+
+        write();
+
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        fflush(mFile);
+    }
+
+    uint64_t TraceRecorder::getNumberOfEvents() const { return mNumOfEvents.load(std::memory_order_relaxed); }
+}//mfg
@@ -0,0 +1,387 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "TraceReplay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+#include "StackAllocator.hpp"
+
+namespace mfg {
+    namespace {
+        struct StackEntry { //an allocation on a stack
+            uint32_t slot;
+            uint64_t serial; //the slot may be reused after the allocation has been released
+        };
+
+        struct StackCheckpoint { //a marker handed out
+            Marker marker;
+            size_t below; //allocations below it
+            uint32_t index; //index of the marker
+        };
+
+        struct StackState {
+            std::vector<StackEntry> order; //allocations in use, the oldest first
+            std::vector<StackCheckpoint> checkpoints; //as in MarkerCheckpoints
+        };
+    }
+
+    TraceReplay::TraceReplay(const char* path, const uint16_t& allocator) :
+        mNumOfSlots(0),
+        mNumOfMarkers(0),
+        mArenaSize(0),
+        mLargestRequest(0),
+        mNumOfAllocators(0),
+        mSkipped(0),
+        mSingleStack(true),
+        mLoaded(false),
+        mElapsed(0),
+        mFailures(0),
+        mTraceFailures(0),
+        mRecovered(0),
+        mPeakLive(0),
+        mPeakUsed(0),
+        mPeakFragmentation(-1)
+    {
+        FILE* file = fopen(path, "rb");
+        if(file == nullptr) {
+            return;
+        }
+
+        TraceHeader header;
+        if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "MFGTRACE", sizeof(header.magic)) != 0
+            || header.version != TraceHeader::VERSION || header.eventSize != sizeof(TraceEvent)) { //not a trace of this version
+            fclose(file);
+            return;
+        }
+
+        std::vector<TraceEvent> events;
+        std::vector<TraceEvent> buffer(TraceRecorder::BUFFER_SIZE);
+        size_t read;
+        while((read = fread(buffer.data(), sizeof(TraceEvent), buffer.size(), file)) > 0) {
+            for(size_t i = 0; i < read; i++) {
+                if(buffer[i].type == TraceEvent::ATTACH && buffer[i].allocator >= mNumOfAllocators) {
+                    mNumOfAllocators = buffer[i].allocator + 1;
+                }
+
+                if(buffer[i].allocator == allocator) {
+                    events.push_back(buffer[i]);
+                }
+            }
+        }
+
+        fclose(file);
+
+        //the buffers of the threads are written one after another
+        std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.timestamp < b.timestamp; });
+
+        compile(events);
+        mLoaded = true;
+    }
+
+    void TraceReplay::compile(const std::vector<TraceEvent>& events) {
+        bool stacks = false; //rollbacks need the order of the allocations
+        for(const TraceEvent& event : events) {
+            if(event.type == TraceEvent::MARKER || event.type == TraceEvent::DEALLOCATE_TO || event.type == TraceEvent::BEGIN_FRAME) {
+                stacks = true;
+                break;
+            }
+        }
+
+        std::unordered_map<uint64_t, uint32_t> slots; //slots of the addresses in use
+        std::vector<uint32_t> freeSlots;
+        std::vector<uint64_t> slotIds; //address of every slot
+        std::vector<uint64_t> slotSerials; //allocation in every slot, 0 if it is free
+        uint64_t serial = 0;
+        StackState sides[2]; //the lower and the upper stack, or the two frames
+        size_t frame = 0;
+
+        auto release = [&](StackState& side, const size_t& below, Operation& operation) {
+            operation.value = mReleases.size();
+            for(size_t i = below; i < side.order.size(); i++) {
+                const StackEntry& entry = side.order[i];
+                if(slotSerials[entry.slot] != entry.serial) { //released meanwhile
+                    continue;
+                }
+
+                auto it = slots.find(slotIds[entry.slot]);
+                if(it != slots.end() && it->second == entry.slot) {
+                    slots.erase(it);
+                }
+
+                slotSerials[entry.slot] = 0;
+                freeSlots.push_back(entry.slot);
+                mReleases.push_back(entry.slot);
+            }
+
+            operation.count = mReleases.size() - operation.value;
+            side.order.resize(below);
+        };
+
+        for(const TraceEvent& event : events) {
+            Operation operation = {event.type, event.flags, event.alignment, 0, 0, event.value, event.timestamp};
+            StackState& side = sides[(event.flags & TraceEvent::TOP) ? 1 : frame];
+
+            switch(event.type) {
+            case TraceEvent::ATTACH:
+                mArenaSize = event.value;
+                continue;
+            case TraceEvent::ALLOCATE: {
+                if(event.flags & TraceEvent::FAILED) {
+                    break;
+                }
+
+                if(event.value > mLargestRequest) {
+                    mLargestRequest = event.value;
+                }
+
+                if(event.flags & TraceEvent::TOP) {
+                    mSingleStack = false;
+                }
+
+                uint32_t slot;
+                if(!freeSlots.empty()) {
+                    slot = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+                else {
+                    slot = mNumOfSlots++;
+                    slotIds.push_back(0);
+                    slotSerials.push_back(0);
+                }
+
+                slots[event.id] = slot; //a block not deallocated in the trace keeps its slot
+                slotIds[slot] = event.id;
+                slotSerials[slot] = ++serial;
+                operation.index = slot;
+
+                if(stacks) {
+                    side.order.push_back({slot, serial});
+                }
+                break;
+            }
+            case TraceEvent::DEALLOCATE: {
+                auto it = slots.find(event.id);
+                if(it == slots.end()) { //allocated before the trace
+                    mSkipped++;
+                    continue;
+                }
+
+                operation.index = it->second;
+                slotSerials[it->second] = 0;
+                freeSlots.push_back(it->second);
+                slots.erase(it);
+                break;
+            }
+            case TraceEvent::MARKER:
+                while(!side.checkpoints.empty() && side.checkpoints.back().marker >= event.value) {
+                    side.checkpoints.pop_back();
+                }
+
+                side.checkpoints.push_back({event.value, side.order.size(), (uint32_t) mNumOfMarkers});
+                operation.index = mNumOfMarkers++;
+                break;
+            case TraceEvent::DEALLOCATE_TO:
+                while(!side.checkpoints.empty() && side.checkpoints.back().marker > event.value) {
+                    side.checkpoints.pop_back();
+                }
+
+                if(side.checkpoints.empty()) {
+                    operation.index = NO_MARKER;
+                    release(side, 0, operation);
+                }
+                else {
+                    operation.index = side.checkpoints.back().index;
+                    release(side, side.checkpoints.back().below, operation);
+                }
+                break;
+            case TraceEvent::BEGIN_FRAME:
+                mSingleStack = false;
+                frame ^= 1;
+                release(sides[frame], 0, operation);
+                sides[frame].checkpoints.clear();
+                break;
+            case TraceEvent::CLEAR:
+                slots.clear();
+                freeSlots.clear();
+                for(size_t slot = mNumOfSlots; slot > 0; slot--) {
+                    freeSlots.push_back(slot - 1);
+                    slotSerials[slot - 1] = 0;
+                }
+
+                sides[0] = StackState();
+                sides[1] = StackState();
+                frame = 0;
+                break;
+            default: //written by a newer version
+                continue;
+            }
+
+            mOperations.push_back(operation);
+        }
+    }
+
+    void TraceReplay::sample(Allocator& allocator, const uint64_t& operation, const size_t& live) {
+        ReplaySample sample;
+        sample.operation = operation;
+        sample.timestamp = operation > 0 ? mOperations[operation - 1].timestamp : 0;
+        sample.live = live;
+        sample.used = allocator.getUsedSize();
+        sample.largestFreeBlock = allocator.getLargestFreeBlock();
+
+        size_t free = allocator.getSize() > sample.used ? allocator.getSize() - sample.used : 0;
+        if(sample.largestFreeBlock == 0) { //unknown
+            sample.fragmentation = -1;
+        }
+        else {
+            sample.fragmentation = free > sample.largestFreeBlock ? 1.0 - (double) sample.largestFreeBlock / free : 0.0;
+        }
+
+        if(sample.fragmentation > mPeakFragmentation) {
+            mPeakFragmentation = sample.fragmentation;
+        }
+
+        mSamples.push_back(sample);
+    }
+
+    bool TraceReplay::run(Allocator& allocator, const size_t& sampleInterval) {
+        if(!mLoaded) {
+            return false;
+        }
+
+        allocator.enableStatistics();
+
+        StackAllocator* stack = mSingleStack ? dynamic_cast<StackAllocator*>(&allocator) : nullptr;
+        bool canDeallocate = allocator.canDeallocate();
+
+        std::vector<void*> blocks(mNumOfSlots, nullptr);
+        std::vector<uint64_t> sizes(mNumOfSlots, 0);
+        std::vector<Marker> markers(mNumOfMarkers, 0);
+
+        mSamples.clear();
+        mElapsed = 0;
+        mFailures = 0;
+        mTraceFailures = 0;
+        mRecovered = 0;
+        mPeakLive = 0;
+        mPeakFragmentation = -1;
+
+        size_t live = 0;
+        size_t interval = sampleInterval > 0 ? sampleInterval : mOperations.size() + 1;
+        size_t begin = 0;
+        do {
+            size_t end = std::min(begin + interval, mOperations.size());
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for(size_t i = begin; i < end; i++) {
+                const Operation& operation = mOperations[i];
+                switch(operation.type) {
+                case TraceEvent::ALLOCATE: {
+                    void* memory = operation.alignment > 0 ? allocator.allocate(operation.value, (size_t) 1 << (operation.alignment - 1))
+                                                           : allocator.allocate(operation.value);
+                    if(operation.flags & TraceEvent::FAILED) {
+                        mTraceFailures++;
+                        if(memory != nullptr) { //it is not needed, the trace went on without it
+                            mRecovered++;
+                            if(canDeallocate) {
+                                allocator.deallocate(memory);
+                            }
+                        }
+                    }
+                    else if(memory == nullptr) {
+                        mFailures++;
+                    }
+                    else {
+                        blocks[operation.index] = memory;
+                        sizes[operation.index] = operation.value;
+                        live += operation.value;
+                        if(live > mPeakLive) {
+                            mPeakLive = live;
+                        }
+                    }
+                    break;
+                }
+                case TraceEvent::DEALLOCATE:
+                    if(blocks[operation.index] != nullptr) {
+                        if(canDeallocate) {
+                            allocator.deallocate(blocks[operation.index]);
+                        }
+
+                        live -= sizes[operation.index];
+                        blocks[operation.index] = nullptr;
+                    }
+                    break;
+                case TraceEvent::MARKER:
+                    if(stack != nullptr) {
+                        markers[operation.index] = stack->getMarker();
+                    }
+                    break;
+                case TraceEvent::DEALLOCATE_TO:
+                case TraceEvent::BEGIN_FRAME:
+                    for(size_t j = operation.count; j > 0; j--) { //the newest first
+                        uint32_t slot = mReleases[operation.value + j - 1];
+                        if(blocks[slot] != nullptr) {
+                            if(canDeallocate) {
+                                allocator.deallocate(blocks[slot]);
+                            }
+
+                            live -= sizes[slot];
+                            blocks[slot] = nullptr;
+                        }
+                    }
+
+                    if(stack != nullptr && operation.type == TraceEvent::DEALLOCATE_TO) {
+                        stack->deallocateTo(operation.index != NO_MARKER ? markers[operation.index] : 0);
+                    }
+                    break;
+                case TraceEvent::CLEAR:
+                    allocator.clear();
+                    std::fill(blocks.begin(), blocks.end(), nullptr);
+                    live = 0;
+                    break;
+                }
+            }
+            mElapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            sample(allocator, end, live);
+            begin = end;
+        } while(begin < mOperations.size());
+
+        StatisticsSnapshot snapshot;
+        mPeakUsed = allocator.snapshotStatistics(snapshot) ? snapshot.highWaterMark : 0;
+
+        return true;
+    }
+
+    bool TraceReplay::isLoaded() const { return mLoaded; }
+    const std::vector<ReplaySample>& TraceReplay::getSamples() const { return mSamples; }
+    size_t TraceReplay::getNumberOfOperations() const { return mOperations.size(); }
+    size_t TraceReplay::getArenaSize() const { return mArenaSize; }
+    size_t TraceReplay::getLargestRequest() const { return mLargestRequest; }
+    size_t TraceReplay::getNumberOfAllocators() const { return mNumOfAllocators; }
+    uint64_t TraceReplay::getSkipped() const { return mSkipped; }
+    uint64_t TraceReplay::getElapsed() const { return mElapsed; }
+    uint64_t TraceReplay::getFailures() const { return mFailures; }
+    uint64_t TraceReplay::getTraceFailures() const { return mTraceFailures; }
+    uint64_t TraceReplay::getRecovered() const { return mRecovered; }
+    size_t TraceReplay::getPeakLive() const { return mPeakLive; }
+    size_t TraceReplay::getPeakUsed() const { return mPeakUsed; }
+    double TraceReplay::getPeakFragmentation() const { return mPeakFragmentation; }
+}//mfg
@@ -19,7 +19,7 @@ freely, subject to the following restrictions:
 
 namespace mfg {
 #ifdef MFG_ASSERTION
-void ReportAssert(char* exp, char* file, char* baseFile, int line) {
+void ReportAssert(const char* exp, const char* file, const char* baseFile, int line) {
     std::ofstream fout;
     fout.open("MfgLastAssert.txt", std::ios::out);
     if (!strcmp(file, baseFile)) {
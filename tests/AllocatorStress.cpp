@@ -0,0 +1,419 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Randomized stress test of the general allocators. Blocks of random sizes and alignments
+are allocated and deallocated at random, every block is filled with a pattern of its own,
+which is checked before it is deallocated, and a block overlapping a live one is caught.
+    tlsf    Sizes across many first and second level buckets, every block aligned to 16 bytes.
+            After everything is deallocated the free blocks have to merge into one again.
+    slab    Sizes of every class and bigger ones. The usable size, found from the address of
+            the block, has to hold the request. Once everything is deallocated the empty slabs
+            have to serve the biggest class, but the last slab every class keeps.
+    buddy   Blocks are split and merged, every block starts on a multiple of the minimum size.
+            After everything is deallocated the buddies have to merge into one block again.
+    handle  Relocatable and pinned blocks, defragment() slides them with a random budget from
+            where it has stopped. Every live handle has to resolve to its pattern after every
+            call, a deallocated one never. Without pinned blocks the free space has to gather
+            into one block.
+Exits with 1 on the first error.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "BuddyAllocator.hpp"
+#include "HandleAllocator.hpp"
+#include "SlabAllocator.hpp"
+#include "TlsfAllocator.hpp"
+
+namespace {
+    const size_t ARENA_SIZE = 32 << 20;
+    const size_t OPERATIONS = 200000;
+    const size_t MAX_LIVE = 512;
+    const size_t TLSF_ALIGNMENT = 16; //what malloc promises
+    const size_t SLAB_SIZE = 65536; //the default of SlabAllocator
+
+    class Random { //xorshift64*
+    private:
+        uint64_t mState;
+    public:
+        Random(const uint64_t& seed) : mState(seed) {}
+
+        uint64_t next() {
+            mState ^= mState >> 12;
+            mState ^= mState << 25;
+            mState ^= mState >> 27;
+            return mState * 0x2545F4914F6CDD1DULL;
+        }
+
+        //as many small sizes as big ones on a logarithmic scale
+        size_t size(const size_t& min, const size_t& max) {
+            size_t low = 63 - __builtin_clzll(min);
+            size_t high = 63 - __builtin_clzll(max);
+            size_t bits = low + next() % (high - low + 1);
+            size_t size = ((size_t) 1 << bits) + next() % ((size_t) 1 << bits);
+            return size < min ? min : size > max ? max : size;
+        }
+    };
+
+    struct Live {
+        unsigned char* memory;
+        size_t size;
+        unsigned char pattern;
+        mfg::Handle handle; //NULL_HANDLE if the block is pinned
+    };
+
+    bool fail(const char* name, const char* message) {
+        fprintf(stderr, "FAILED (%s): %s\n", name, message);
+        return false;
+    }
+
+    bool checkPattern(const char* name, const Live& live) {
+        for(size_t i = 0; i < live.size; i++) {
+            if(live.memory[i] != live.pattern) {
+                return fail(name, "the contents of a block changed while it was allocated");
+            }
+        }
+
+        return true;
+    }
+
+    //the live blocks by their address, so a block overlapping another one is caught
+    class Ranges {
+    private:
+        std::map<uintptr_t, uintptr_t> mRanges; //end of every block by its beginning
+    public:
+        bool add(const char* name, const void* memory, const size_t& size) {
+            uintptr_t begin = (uintptr_t) memory;
+            std::map<uintptr_t, uintptr_t>::iterator next = mRanges.lower_bound(begin);
+            if((next != mRanges.end() && next->first < begin + size) || (next != mRanges.begin() && std::prev(next)->second > begin)) {
+                return fail(name, "a block overlaps a live one");
+            }
+
+            mRanges[begin] = begin + size;
+            return true;
+        }
+
+        void remove(const void* memory) { mRanges.erase((uintptr_t) memory); }
+        void clear() { mRanges.clear(); }
+    };
+
+    /*  Allocates and deallocates at random, a quarter of the requests aligned up to maxAlignment,
+     *  check(memory, size, alignment) tells if a block handed out is right. Everything is deallocated at the end.
+     */
+    template<typename AllocatorType, typename Check>
+    bool churn(const char* name, AllocatorType& allocator, const size_t& maxSize, const size_t& maxAlignment, const uint64_t& seed, Check check) {
+        Random random(seed);
+        Ranges ranges;
+        std::vector<Live> live;
+
+        for(size_t i = 0; i < OPERATIONS; i++) {
+            if(live.size() == MAX_LIVE || (!live.empty() && random.next() % 2 == 0)) {
+                size_t index = random.next() % live.size();
+                if(!checkPattern(name, live[index])) {
+                    return false;
+                }
+
+                ranges.remove(live[index].memory);
+                allocator.deallocate(live[index].memory);
+                live[index] = live.back();
+                live.pop_back();
+                continue;
+            }
+
+            size_t size = random.size(1, maxSize);
+            size_t alignment = random.next() % 4 == 0 ? (size_t) 1 << (random.next() % (__builtin_ctzll(maxAlignment) + 1)) : 0;
+            void* memory = alignment != 0 ? allocator.allocate(size, alignment) : allocator.allocate(size);
+            if(memory == nullptr) {
+                return fail(name, "allocate returned nullptr while most of the memory was free");
+            }
+
+            if(!check(memory, size, alignment) || !ranges.add(name, memory, size)) {
+                return false;
+            }
+
+            Live item = {(unsigned char*) memory, size, (unsigned char) (random.next() | 1), mfg::HandleAllocator::NULL_HANDLE};
+            memset(item.memory, item.pattern, size);
+            live.push_back(item);
+        }
+
+        for(const Live& item : live) {
+            if(!checkPattern(name, item)) {
+                return false;
+            }
+
+            allocator.deallocate(item.memory);
+        }
+
+        return true;
+    }
+
+    bool tlsf(void* memory) {
+        mfg::TlsfAllocator allocator(memory, ARENA_SIZE);
+        size_t largest = allocator.getLargestFreeBlock();
+
+        bool passed = churn("tlsf", allocator, 64 * 1024, 4096, 1, [&](void* block, const size_t& size, const size_t& alignment) {
+            if((uintptr_t) block % TLSF_ALIGNMENT != 0 || (alignment != 0 && (uintptr_t) block % alignment != 0)) {
+                return fail("tlsf", "a block is not aligned");
+            }
+
+            if(allocator.getUsableSize(block) < size) {
+                return fail("tlsf", "the usable size is smaller than the request");
+            }
+
+            return true;
+        });
+
+        if(passed && allocator.getLargestFreeBlock() != largest) {
+            return fail("tlsf", "the free blocks did not merge into one after everything was deallocated");
+        }
+
+        return passed;
+    }
+
+    //allocates blocks of one size until they come from the front of the memory
+    size_t countSlabBlocks(mfg::SlabAllocator& allocator, void* memory, const size_t& blockMemorySize, const size_t& size) {
+        std::vector<void*> blocks;
+        size_t count = 0;
+        for(;;) {
+            void* block = allocator.allocate(size);
+            if(block == nullptr || (uintptr_t) block - (uintptr_t) memory < blockMemorySize) {
+                if(block != nullptr) {
+                    allocator.deallocate(block);
+                }
+                break;
+            }
+
+            blocks.push_back(block);
+            count++;
+        }
+
+        for(void* block : blocks) {
+            allocator.deallocate(block);
+        }
+
+        return count;
+    }
+
+    bool slab(void* memory) {
+        const size_t blockMemorySize = ARENA_SIZE / 2;
+
+        size_t expected;
+        {
+            mfg::SlabAllocator fresh(memory, ARENA_SIZE, blockMemorySize);
+            expected = countSlabBlocks(fresh, memory, blockMemorySize, mfg::SlabAllocator::MAX_SMALL_SIZE);
+        }
+
+        mfg::SlabAllocator allocator(memory, ARENA_SIZE, blockMemorySize);
+        bool passed = churn("slab", allocator, 4 * mfg::SlabAllocator::MAX_SMALL_SIZE, 4096, 2, [&](void* block, const size_t& size, const size_t& alignment) {
+            if(alignment != 0 && (uintptr_t) block % alignment != 0) {
+                return fail("slab", "a block is not aligned");
+            }
+
+            if(allocator.getUsableSize(block) < size) {
+                return fail("slab", "the usable size found from the address is smaller than the request");
+            }
+
+            return true;
+        });
+
+        if(!passed) {
+            return false;
+        }
+
+        //every other class keeps its last slab
+        size_t kept = (mfg::SlabAllocator::NUM_SIZE_CLASSES - 1) * (SLAB_SIZE / mfg::SlabAllocator::MAX_SMALL_SIZE);
+        if(countSlabBlocks(allocator, memory, blockMemorySize, mfg::SlabAllocator::MAX_SMALL_SIZE) + kept < expected) {
+            return fail("slab", "the empty slabs did not come back after everything was deallocated");
+        }
+
+        return true;
+    }
+
+    bool buddy(void* memory) {
+        mfg::BuddyAllocator allocator(memory, ARENA_SIZE, 64);
+        size_t largest = allocator.getLargestFreeBlock();
+        void* first = allocator.allocate(largest); //a block of the biggest order, the others start on a multiple of their size from it
+        allocator.deallocate(first);
+
+        //the memory is aligned only to the minimum block size, bigger alignments may fail
+
+        bool passed = churn("buddy", allocator, 64 * 1024, allocator.getMinBlockSize(), 3, [&](void* block, const size_t& size, const size_t& alignment) {
+            size_t offset = (uintptr_t) block - (uintptr_t) first; //the powers of two divide it even if it wraps around
+            if(offset % allocator.getMinBlockSize() != 0 || (alignment != 0 && (uintptr_t) block % alignment != 0)) {
+                return fail("buddy", "a block does not start on a block boundary");
+            }
+
+            size_t usable = allocator.getUsableSize(block);
+            if(usable < size || (usable & (usable - 1)) != 0 || offset % usable != 0) {
+                return fail("buddy", "a block is not a power of two sized buddy holding the request");
+            }
+
+            return true;
+        });
+
+        if(passed && allocator.getLargestFreeBlock() != largest) {
+            return fail("buddy", "the buddies did not merge into one block after everything was deallocated");
+        }
+
+        return passed;
+    }
+
+    bool checkHandles(mfg::HandleAllocator& allocator, std::vector<Live>& live, const std::vector<mfg::Handle>& freed) {
+        Ranges ranges;
+        for(Live& item : live) {
+            if(item.handle != mfg::HandleAllocator::NULL_HANDLE) {
+                item.memory = (unsigned char*) allocator.resolve(item.handle);
+                if(item.memory == nullptr) {
+                    return fail("handle", "a live handle does not resolve");
+                }
+            }
+
+            if(!ranges.add("handle", item.memory, item.size) || !checkPattern("handle", item)) {
+                return false;
+            }
+        }
+
+        for(mfg::Handle handle : freed) {
+            if(allocator.resolve(handle) != nullptr) {
+                return fail("handle", "a deallocated handle resolves");
+            }
+        }
+
+        return true;
+    }
+
+    bool handle(void* memory) {
+        const size_t maxHandles = MAX_LIVE;
+        mfg::HandleAllocator allocator(memory, ARENA_SIZE, maxHandles);
+        size_t largest = allocator.getLargestFreeBlock();
+        Random random(4);
+        std::vector<Live> live;
+        std::vector<mfg::Handle> freed; //the last deallocated handles
+
+        for(size_t i = 0; i < OPERATIONS; i++) {
+            if(i % 64 == 0) {
+                allocator.defragment(random.next() % (64 * 1024));
+                if(!checkHandles(allocator, live, freed)) {
+                    return false;
+                }
+            }
+
+            if(live.size() == MAX_LIVE || (!live.empty() && random.next() % 2 == 0)) {
+                size_t index = random.next() % live.size();
+                Live& item = live[index];
+                if(item.handle != mfg::HandleAllocator::NULL_HANDLE) {
+                    item.memory = (unsigned char*) allocator.resolve(item.handle);
+                    if(freed.size() == 64) {
+                        freed.erase(freed.begin());
+                    }
+                    freed.push_back(item.handle);
+                }
+
+                if(item.memory == nullptr || !checkPattern("handle", item)) {
+                    return fail("handle", "a live block got lost");
+                }
+
+                if(item.handle != mfg::HandleAllocator::NULL_HANDLE) {
+                    allocator.deallocateHandle(item.handle);
+                }
+                else {
+                    allocator.deallocate(item.memory);
+                }
+
+                live[index] = live.back();
+                live.pop_back();
+                continue;
+            }
+
+            Live item = {nullptr, random.size(1, 4096), (unsigned char) (random.next() | 1), mfg::HandleAllocator::NULL_HANDLE};
+            if(random.next() % 8 == 0) { //pinned
+                item.memory = (unsigned char*) allocator.allocate(item.size);
+            }
+            else {
+                item.handle = allocator.allocateHandle(item.size);
+                item.memory = (unsigned char*) allocator.resolve(item.handle);
+            }
+
+            if(item.memory == nullptr) {
+                return fail("handle", "allocate returned nothing while most of the memory was free");
+            }
+
+            if(allocator.getUsableSize(item.memory) < item.size) {
+                return fail("handle", "the usable size is smaller than the request");
+            }
+
+            memset(item.memory, item.pattern, item.size);
+            live.push_back(item);
+        }
+
+        //without pinned blocks everything can slide down, the free space ends up in one block
+        for(size_t i = 0; i < live.size();) {
+            if(live[i].handle == mfg::HandleAllocator::NULL_HANDLE) {
+                if(!checkPattern("handle", live[i])) {
+                    return false;
+                }
+
+                allocator.deallocate(live[i].memory);
+                live[i] = live.back();
+                live.pop_back();
+            }
+            else {
+                i++;
+            }
+        }
+
+        for(size_t pass = 0; pass < 2; pass++) { //from the cursor to the end, then a whole pass
+            while(allocator.defragment(ARENA_SIZE) > 0);
+            allocator.defragment(ARENA_SIZE);
+        }
+
+        if(!checkHandles(allocator, live, freed)) {
+            return false;
+        }
+
+        if(allocator.getFragmentation() != 0.0) {
+            return fail("handle", "the free space did not gather into one block");
+        }
+
+        for(const Live& item : live) {
+            allocator.deallocateHandle(item.handle);
+        }
+
+        if(allocator.getLargestFreeBlock() != largest) {
+            return fail("handle", "the free blocks did not merge into one after everything was deallocated");
+        }
+
+        return true;
+    }
+}
+
+int main() {
+    std::vector<unsigned char> memory(ARENA_SIZE);
+    bool (*tests[])(void*) = {tlsf, slab, buddy, handle};
+    for(bool (*test)(void*) : tests) {
+        if(!test(memory.data())) {
+            return 1;
+        }
+    }
+
+    printf("passed\n");
+    return 0;
+}
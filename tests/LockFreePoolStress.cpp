@@ -0,0 +1,232 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Stress test of LockFreePoolAllocator. 1..N threads allocate and deallocate blocks
+of one pool at random. Every block handed out is claimed in an ownership table,
+so a block handed out twice is caught, and it is filled with a pattern of its
+owner, which is checked before it is deallocated. After every run all the blocks
+have to come back from the free list, and again after a quiescent clear().
+Prints the throughput of each number of threads, exits with 1 on the first error.
+
+Usage: mfg_lockfree_pool_stress [max threads, 4 or the number of cores by default]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "LockFreePoolAllocator.hpp"
+
+namespace {
+    const size_t BLOCK_SIZE = 64;
+    const size_t NUM_OF_BLOCKS = 16384;
+    const size_t HELD_PER_THREAD = 256; //blocks a thread holds at most, the pool never runs out
+    const size_t OPERATIONS_PER_THREAD = 400000;
+
+    std::atomic<bool> sFailed(false);
+
+    void fail(const char* message, const size_t& thread) {
+        if(!sFailed.exchange(true)) {
+            fprintf(stderr, "FAILED (thread %zu): %s\n", thread, message);
+        }
+    }
+
+    class Random { //xorshift64*
+    private:
+        uint64_t mState;
+    public:
+        Random(const uint64_t& seed) : mState(seed) {}
+
+        uint64_t next() {
+            mState ^= mState >> 12;
+            mState ^= mState << 25;
+            mState ^= mState >> 27;
+            return mState * 0x2545F4914F6CDD1DULL;
+        }
+    };
+
+    struct Held {
+        unsigned char* block;
+        unsigned char pattern;
+    };
+
+    class Test {
+    private:
+        void* mMemory;
+        mfg::LockFreePoolAllocator mPool;
+        std::unique_ptr<std::atomic<uint32_t>[]> mOwners; //thread + 1 holding each block, 0 if free
+
+        size_t indexOf(const void* block) const { return ((uintptr_t) block - (uintptr_t) mMemory) / BLOCK_SIZE; }
+
+        bool checkBlock(const void* block, const size_t& thread) {
+            if(block < mMemory || (uintptr_t) block >= (uintptr_t) mMemory + NUM_OF_BLOCKS * BLOCK_SIZE
+                    || ((uintptr_t) block - (uintptr_t) mMemory) % BLOCK_SIZE != 0) {
+                fail("the block is not in the pool", thread);
+                return false;
+            }
+
+            return true;
+        }
+
+        void release(const Held& held, const size_t& thread) {
+            for(size_t i = 0; i < BLOCK_SIZE; i++) {
+                if(held.block[i] != held.pattern) {
+                    fail("the contents of a block changed while it was allocated", thread);
+                    break;
+                }
+            }
+
+            mOwners[indexOf(held.block)].store(0, std::memory_order_relaxed);
+            mPool.deallocate(held.block);
+        }
+
+        void work(const size_t& thread) {
+            Random random(thread * 7919 + 1);
+            std::vector<Held> held;
+            held.reserve(HELD_PER_THREAD);
+
+            for(size_t i = 0; i < OPERATIONS_PER_THREAD && !sFailed.load(std::memory_order_relaxed); i++) {
+                if(held.size() == HELD_PER_THREAD || (!held.empty() && random.next() % 2 == 0)) {
+                    size_t index = random.next() % held.size();
+                    release(held[index], thread);
+                    held[index] = held.back();
+                    held.pop_back();
+                    continue;
+                }
+
+                unsigned char* block = (unsigned char*) mPool.allocate(BLOCK_SIZE);
+                if(block == nullptr) {
+                    fail("allocate returned nullptr while the pool had free blocks", thread);
+                    break;
+                }
+
+                if(!checkBlock(block, thread)) {
+                    break;
+                }
+
+                uint32_t owner = 0;
+                if(!mOwners[indexOf(block)].compare_exchange_strong(owner, thread + 1, std::memory_order_relaxed)) {
+                    fail("a block has been handed out twice", thread);
+                    break;
+                }
+
+                Held item = {block, (unsigned char) (random.next() | 1)};
+                memset(block, item.pattern, BLOCK_SIZE);
+                held.push_back(item);
+            }
+
+            for(const Held& item : held) {
+                release(item, thread);
+            }
+        }
+
+        //takes every block on one thread, then gives them back
+        bool checkAllBlocks(const char* when) {
+            std::vector<void*> blocks;
+            std::vector<bool> seen(NUM_OF_BLOCKS, false);
+            for(size_t i = 0; i < NUM_OF_BLOCKS; i++) {
+                void* block = mPool.allocate(BLOCK_SIZE);
+                if(block == nullptr || !checkBlock(block, 0)) {
+                    fprintf(stderr, "FAILED: only %zu of %zu blocks came back %s\n", i, NUM_OF_BLOCKS, when);
+                    return false;
+                }
+
+                if(seen[indexOf(block)]) {
+                    fprintf(stderr, "FAILED: a block has been handed out twice %s\n", when);
+                    return false;
+                }
+
+                seen[indexOf(block)] = true;
+                blocks.push_back(block);
+            }
+
+            if(mPool.allocate(BLOCK_SIZE) != nullptr) {
+                fprintf(stderr, "FAILED: more blocks than the pool has %s\n", when);
+                return false;
+            }
+
+            for(void* block : blocks) {
+                mPool.deallocate(block);
+            }
+
+            return true;
+        }
+    public:
+        Test(void* memory) :
+            mMemory(memory),
+            mPool(memory, NUM_OF_BLOCKS * BLOCK_SIZE, BLOCK_SIZE),
+            mOwners(new std::atomic<uint32_t>[NUM_OF_BLOCKS])
+        {
+            for(size_t i = 0; i < NUM_OF_BLOCKS; i++) {
+                mOwners[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        bool run(const size_t& threads) {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> workers;
+            for(size_t thread = 1; thread < threads; thread++) {
+                workers.emplace_back(&Test::work, this, thread);
+            }
+
+            work(0);
+            for(std::thread& worker : workers) {
+                worker.join();
+            }
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if(sFailed.load()) {
+                return false;
+            }
+
+            printf("threads %zu: %.1f Mops/s\n", threads, threads * OPERATIONS_PER_THREAD / seconds / 1e6);
+
+            if(!checkAllBlocks("after the threads finished")) {
+                return false;
+            }
+
+            mPool.clear();
+            return checkAllBlocks("after clear()");
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    if(argc > 1) {
+        maxThreads = std::max(1, atoi(argv[1]));
+    }
+
+    std::vector<unsigned char> memory(NUM_OF_BLOCKS * BLOCK_SIZE);
+    Test test(memory.data());
+    for(size_t threads = 1; threads <= maxThreads; threads++) {
+        if(!test.run(threads)) {
+            return 1;
+        }
+    }
+
+    printf("passed\n");
+    return 0;
+}
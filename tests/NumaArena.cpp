@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Test of NumaArena over several threads. Every thread pins itself to a node with
+NumaChunkSource::BindThread(), then takes its pool and stack, which have to be its
+own: the same ones on every call, different from the ones of the other threads.
+The node of a thread has to be one of the arena. The threads fill blocks of their
+pool and stack with a pattern of their own, and after all of them finished every
+pattern is checked, so memory given to two threads is caught. Exits with 1 on the
+first error.
+
+Usage: mfg_numa_arena [threads, 4 or the number of cores by default]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "NumaArena.hpp"
+
+namespace {
+    const size_t BLOCK_SIZE = 64;
+    const size_t POOL_SIZE = 64 * 1024;
+    const size_t STACK_SIZE = 64 * 1024;
+    const size_t BLOCKS_PER_THREAD = 256;
+    const size_t STACK_ALLOCATIONS_PER_THREAD = 64;
+    const size_t STACK_ALLOCATION_SIZE = 512;
+
+    std::atomic<bool> sFailed(false);
+
+    void fail(const char* message, const size_t& thread) {
+        if(!sFailed.exchange(true)) {
+            fprintf(stderr, "FAILED (thread %zu): %s\n", thread, message);
+        }
+    }
+
+    struct Held {
+        unsigned char* memory;
+        size_t size;
+    };
+
+    struct ThreadResult { //what a thread got from the arena
+        mfg::PoolAllocator* pool;
+        mfg::StackAllocator* stack;
+        std::vector<Held> held;
+    };
+
+    void work(mfg::NumaArena& arena, ThreadResult& result, const size_t& thread) {
+        mfg::NumaChunkSource::BindThread(thread % arena.getNumberOfNodes()); //the allocations have to work either way
+
+        result.pool = arena.getPool();
+        result.stack = arena.getStack();
+        if(result.pool == nullptr || result.stack == nullptr) {
+            fail("the arena gave no allocators", thread);
+            return;
+        }
+
+        if(arena.getPool() != result.pool || arena.getStack() != result.stack) {
+            fail("the allocators of the thread changed", thread);
+            return;
+        }
+
+        if(arena.getNode() >= arena.getNumberOfNodes()) {
+            fail("the node of the thread is not one of the arena", thread);
+            return;
+        }
+
+        unsigned char pattern = (unsigned char) (thread + 1);
+        for(size_t i = 0; i < BLOCKS_PER_THREAD; i++) {
+            unsigned char* block = (unsigned char*) result.pool->allocate(BLOCK_SIZE);
+            if(block == nullptr) {
+                fail("the pool ran out", thread);
+                return;
+            }
+
+            memset(block, pattern, BLOCK_SIZE);
+            result.held.push_back({block, BLOCK_SIZE});
+        }
+
+        for(size_t i = 0; i < STACK_ALLOCATIONS_PER_THREAD; i++) {
+            unsigned char* memory = (unsigned char*) result.stack->allocate(STACK_ALLOCATION_SIZE);
+            if(memory == nullptr) {
+                fail("the stack ran out", thread);
+                return;
+            }
+
+            memset(memory, pattern, STACK_ALLOCATION_SIZE);
+            result.held.push_back({memory, STACK_ALLOCATION_SIZE});
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    if(argc > 1) {
+        threads = std::max(1, atoi(argv[1]));
+    }
+
+    mfg::NumaArena arena(POOL_SIZE, BLOCK_SIZE, STACK_SIZE);
+    std::vector<ThreadResult> results(threads);
+    std::vector<std::thread> workers;
+    for(size_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back(work, std::ref(arena), std::ref(results[thread]), thread);
+    }
+
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if(sFailed.load()) {
+        return 1;
+    }
+
+    for(size_t thread = 0; thread < threads; thread++) {
+        for(size_t other = 0; other < thread; other++) {
+            if(results[thread].pool == results[other].pool || results[thread].stack == results[other].stack) {
+                fprintf(stderr, "FAILED: threads %zu and %zu share their allocators\n", other, thread);
+                return 1;
+            }
+        }
+
+        for(const Held& held : results[thread].held) {
+            for(size_t i = 0; i < held.size; i++) {
+                if(held.memory[i] != (unsigned char) (thread + 1)) {
+                    fprintf(stderr, "FAILED (thread %zu): the memory of the thread has been overwritten\n", thread);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    if(arena.getNumberOfThreads() != threads) {
+        fprintf(stderr, "FAILED: the arena has %zu threads instead of %zu\n", arena.getNumberOfThreads(), threads);
+        return 1;
+    }
+
+    printf("nodes %zu, threads %zu\n", arena.getNumberOfNodes(), threads);
+    printf("passed\n");
+    return 0;
+}
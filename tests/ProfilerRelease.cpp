@@ -0,0 +1,147 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Regression test of the heap profiler on the stack-like allocators. Their blocks come
+back by rolling back to a marker or by switching frames, and the profiler has to forget
+the samples of those blocks, or the profiles report memory which is already free.
+Every allocation is sampled, and after every frame no sample may be left but the ones
+below the marker. Exits with 1 on the first error.
+*/
+
+#include <cstdio>
+#include <vector>
+
+#include "ChunkSource.hpp"
+#include "ConcurrentStackAllocator.hpp"
+#include "DoubleEndedStackAllocator.hpp"
+#include "FrameAllocator.hpp"
+#include "GrowableStackAllocator.hpp"
+#include "HeapProfiler.hpp"
+#include "StackAllocator.hpp"
+
+namespace {
+    const size_t ARENA_SIZE = 64 * 1024;
+    const size_t FRAMES = 100;
+    const size_t ALLOCATIONS_PER_FRAME = 10;
+
+    bool check(const char* name, const mfg::HeapProfiler& profiler, const size_t& expected) {
+        if(profiler.getNumberOfSamples() != expected) {
+            fprintf(stderr, "FAILED: %s kept %zu samples instead of %zu\n", name, profiler.getNumberOfSamples(), expected);
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename Stack>
+    bool rollBack(const char* name, Stack& stack) {
+        mfg::HeapProfiler profiler(1);
+        stack.startProfile(&profiler);
+
+        stack.allocate(64); //stays below every marker
+        for(size_t frame = 0; frame < FRAMES; frame++) {
+            mfg::Marker marker = stack.getMarker();
+            for(size_t i = 0; i < ALLOCATIONS_PER_FRAME; i++) {
+                stack.allocate(100);
+            }
+
+            stack.deallocateTo(marker);
+            if(!check(name, profiler, 1)) {
+                return false;
+            }
+        }
+
+        stack.stopProfile();
+        return true;
+    }
+
+    bool doubleEnded(void* memory) {
+        mfg::DoubleEndedStackAllocator stack(memory, ARENA_SIZE);
+        mfg::HeapProfiler profiler(1);
+        stack.startProfile(&profiler);
+
+        for(size_t frame = 0; frame < FRAMES; frame++) {
+            mfg::Marker bottom = stack.getBottomMarker();
+            mfg::Marker top = stack.getTopMarker();
+            for(size_t i = 0; i < ALLOCATIONS_PER_FRAME; i++) {
+                stack.allocate(100);
+                stack.allocateTop(100);
+            }
+
+            stack.deallocateToTop(top);
+            if(!check("double_ended top", profiler, ALLOCATIONS_PER_FRAME)) {
+                return false;
+            }
+
+            stack.deallocateToBottom(bottom);
+            if(!check("double_ended bottom", profiler, 0)) {
+                return false;
+            }
+        }
+
+        stack.stopProfile();
+        return true;
+    }
+
+    bool frames(void* memory) {
+        mfg::FrameAllocator stack(memory, ARENA_SIZE);
+        mfg::HeapProfiler profiler(1);
+        stack.startProfile(&profiler);
+
+        for(size_t frame = 0; frame < FRAMES; frame++) {
+            stack.beginFrame(); //the frame before the previous one is gone
+            for(size_t i = 0; i < ALLOCATIONS_PER_FRAME; i++) {
+                stack.allocate(100);
+            }
+
+            if(!check("frame", profiler, frame == 0 ? ALLOCATIONS_PER_FRAME : 2 * ALLOCATIONS_PER_FRAME)) {
+                return false;
+            }
+        }
+
+        stack.stopProfile();
+        return true;
+    }
+}
+
+int main() {
+    std::vector<unsigned char> memory(ARENA_SIZE);
+
+    mfg::StackAllocator stack(memory.data(), ARENA_SIZE);
+    if(!rollBack("stack", stack)) {
+        return 1;
+    }
+
+    mfg::ConcurrentStackAllocator concurrent(memory.data(), ARENA_SIZE, 4096);
+    if(!rollBack("concurrent_stack", concurrent)) {
+        return 1;
+    }
+
+    mfg::MmapChunkSource source;
+    mfg::GrowableStackAllocator growable(memory.data(), 512, &source, 512); //every frame spans chunks
+    if(!rollBack("growable_stack", growable)) {
+        return 1;
+    }
+
+    if(!doubleEnded(memory.data()) || !frames(memory.data())) {
+        return 1;
+    }
+
+    printf("passed\n");
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+Copyright (c) 2015 Máté Vágó
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+/*
+Tests of reallocate. The last allocation of a stack may grow or shrink in place only
+while no marker has been taken above it: growing it would put live data above the marker,
+and rolling back to the marker would hand that data out again, shrinking it would move
+the top below the marker. Every allocator without a size header has to be able to copy
+a block into a bigger one, and the HandleAllocator has to know the size of its blocks.
+Exits with 1 on the first error.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "ChunkSource.hpp"
+#include "ConcurrentStackAllocator.hpp"
+#include "DoubleEndedStackAllocator.hpp"
+#include "FrameAllocator.hpp"
+#include "GrowableStackAllocator.hpp"
+#include "HandleAllocator.hpp"
+#include "StackAllocator.hpp"
+
+namespace {
+    const size_t ARENA_SIZE = 16 * 1024;
+
+    bool check(const bool& condition, const char* message) {
+        if(!condition) {
+            fprintf(stderr, "FAILED: %s\n", message);
+        }
+
+        return condition;
+    }
+
+    bool overlaps(const void* a, const size_t& aSize, const void* b, const size_t& bSize) {
+        return (uintptr_t) a < (uintptr_t) b + bSize && (uintptr_t) b < (uintptr_t) a + aSize;
+    }
+
+    bool isFilled(const void* memory, const size_t& size, const unsigned char& pattern) {
+        for(size_t i = 0; i < size; i++) {
+            if(((const unsigned char*) memory)[i] != pattern) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool growInPlace(void* memory) {
+        mfg::StackAllocator stack(memory, ARENA_SIZE);
+        void* block = stack.allocate(16);
+        return check(stack.reallocate(block, 64) == block, "the last allocation did not grow in place")
+            && check(stack.reallocate(block, 8) == block, "the last allocation did not shrink in place");
+    }
+
+    bool growOverMarker(void* memory) {
+        mfg::StackAllocator stack(memory, ARENA_SIZE);
+        unsigned char* block = (unsigned char*) stack.allocate(16);
+        memset(block, 0xA5, 16);
+
+        mfg::Marker marker = stack.getMarker();
+        unsigned char* grown = (unsigned char*) stack.reallocate(block, 64);
+        if(!check(grown != nullptr && grown != block, "the block grew in place over a marker")
+                || !check(isFilled(grown, 16, 0xA5), "the contents were not copied")) {
+            return false;
+        }
+
+        stack.deallocateTo(marker); //the moved block is gone, the original one stays
+        void* other = stack.allocate(32);
+        memset(other, 0x5A, 32);
+
+        return check(!overlaps(other, 32, block, 16), "an allocation after the rollback overlaps a live block")
+            && check(isFilled(block, 16, 0xA5), "a live block below the marker was overwritten");
+    }
+
+    bool shrinkUnderMarker(void* memory) {
+        mfg::StackAllocator stack(memory, ARENA_SIZE);
+        void* block = stack.allocate(64);
+
+        mfg::Marker marker = stack.getMarker();
+        void* shrunk = stack.reallocate(block, 16);
+        if(!check(shrunk != nullptr && shrunk != block, "the block shrank in place under a marker")) {
+            return false;
+        }
+
+        stack.deallocateTo(marker);
+        return check(stack.allocate(1) == (unsigned char*) memory + marker, "the top is not at the marker after the rollback");
+    }
+
+    //allocates a block of 16 bytes with a pattern, then grows it twice
+    bool growCopies(const char* name, mfg::Allocator& allocator, void* block) {
+        if(!check(block != nullptr, name)) {
+            return false;
+        }
+
+        memset(block, 0xC3, 16);
+        allocator.allocate(8); //the block is not the last one any more
+        for(size_t size = 64; size <= 1024; size *= 16) {
+            block = allocator.reallocate(block, size);
+            if(block == nullptr || !isFilled(block, 16, 0xC3)) {
+                fprintf(stderr, "FAILED: %s did not keep the contents growing to %zu bytes\n", name, size);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool growFrame(void* memory) {
+        mfg::FrameAllocator frames(memory, ARENA_SIZE);
+        void* previous = frames.allocate(16);
+        memset(previous, 0x3C, 16);
+        frames.beginFrame(); //the block of the previous frame stays until the next one
+
+        void* block = frames.allocate(16);
+        if(!check(frames.reallocate(block, 64) == block, "the last allocation of a frame did not grow in place")) {
+            return false;
+        }
+
+        void* moved = frames.reallocate(previous, 64);
+        return check(moved != nullptr && isFilled(moved, 16, 0x3C), "a block of the previous frame was not copied")
+            && growCopies("frame", frames, frames.allocate(16));
+    }
+
+    bool growGrowable(void* memory) {
+        mfg::MmapChunkSource source;
+        mfg::GrowableStackAllocator stack(memory, 256, &source, 256); //the grown blocks move into new chunks
+        void* block = stack.allocate(16);
+        return check(stack.reallocate(block, 64) == block, "the last allocation of a chunk did not grow in place")
+            && growCopies("growable_stack", stack, stack.allocate(16));
+    }
+
+    bool growDoubleEnded(void* memory) {
+        mfg::DoubleEndedStackAllocator stack(memory, ARENA_SIZE);
+        if(!growCopies("double_ended bottom", stack, stack.allocate(16))) {
+            return false;
+        }
+
+        void* block = stack.allocateTop(16);
+        memset(block, 0xC3, 16);
+        void* moved = stack.reallocate(block, 256);
+        return check(moved != nullptr && isFilled(moved, 16, 0xC3), "double_ended top did not keep the contents")
+            && check((unsigned char*) moved > (unsigned char*) memory + ARENA_SIZE / 2, "a top block did not stay at the top");
+    }
+
+    bool growConcurrent(void* memory) {
+        mfg::ConcurrentStackAllocator stack(memory, ARENA_SIZE, 256);
+        return growCopies("concurrent_stack", stack, stack.allocate(16));
+    }
+
+    bool growHandle(void* memory) {
+        mfg::HandleAllocator handles(memory, ARENA_SIZE, 16);
+        void* pinned = handles.allocate(40);
+        void* aligned = handles.allocate(40, 64);
+        void* relocatable = handles.resolve(handles.allocateHandle(40));
+        return check(handles.getUsableSize(pinned) >= 40 && handles.getUsableSize(aligned) >= 40
+                && handles.getUsableSize(relocatable) >= 40, "handle did not give the usable size of a block")
+            && growCopies("handle", handles, handles.allocate(16));
+    }
+}
+
+int main() {
+    std::vector<unsigned char> memory(ARENA_SIZE);
+    if(!growInPlace(memory.data()) || !growOverMarker(memory.data()) || !shrinkUnderMarker(memory.data())
+            || !growFrame(memory.data()) || !growGrowable(memory.data()) || !growDoubleEnded(memory.data())
+            || !growConcurrent(memory.data()) || !growHandle(memory.data())) {
+        return 1;
+    }
+
+    printf("passed\n");
+    return 0;
+}